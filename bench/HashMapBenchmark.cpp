@@ -0,0 +1,227 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "util/HashMap.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+
+///
+/// \brief the chained hash map util::HashMap was implemented as before
+///
+/// Every entry is allocated separately and appended to the end of the chain
+/// of its bucket.
+///
+template <typename K, typename V, typename H = uetli::util::DefaultHash<K> >
+class ChainedHashMap
+{
+    struct Entry
+    {
+        K key;
+        V value;
+        Entry* next;
+    };
+
+    Entry** entryTable;
+    size_t size;
+    size_t hashMask;
+    size_t nEntries;
+
+public:
+    ChainedHashMap(void) :
+        size(16), hashMask(15), nEntries(0)
+    {
+        entryTable = new Entry*[size];
+        memset(entryTable, 0, size * sizeof(Entry*));
+    }
+
+
+    ~ChainedHashMap(void)
+    {
+        for (size_t i = 0; i < size; i++) {
+            while (entryTable[i] != 0) {
+                Entry* e = entryTable[i];
+                entryTable[i] = e->next;
+                delete e;
+            }
+        }
+        delete[] entryTable;
+    }
+
+
+    void put(const K& key, const V& value)
+    {
+        if (nEntries > size + (size / 4)) {
+            resize(size * 2);
+        }
+
+        Entry* entry = new Entry();
+        entry->key = key;
+        entry->value = value;
+        putEntry(entry);
+    }
+
+
+    const V* getReference(const K& key) const
+    {
+        const Entry* entry = entryTable[hashMask & H::hash(key)];
+        while (entry != 0) {
+            if (entry->key == key)
+                return &entry->value;
+            entry = entry->next;
+        }
+        return 0;
+    }
+
+private:
+    void resize(size_t newSize)
+    {
+        size_t oldSize = size;
+        Entry** oldEntryTable = entryTable;
+        size = newSize;
+        hashMask = size - 1;
+        entryTable = new Entry*[size];
+        memset(entryTable, 0, size * sizeof(Entry*));
+        nEntries = 0;
+
+        for (size_t i = 0; i < oldSize; i++) {
+            Entry* entry = oldEntryTable[i];
+            while (entry != 0) {
+                Entry* next = entry->next;
+                putEntry(entry);
+                entry = next;
+            }
+        }
+        delete[] oldEntryTable;
+    }
+
+
+    void putEntry(Entry* toAdd)
+    {
+        size_t index = hashMask & H::hash(toAdd->key);
+        Entry* entry = entryTable[index];
+        Entry* lastEntry = 0;
+
+        while (entry != 0) {
+            lastEntry = entry;
+            entry = entry->next;
+        }
+
+        if (lastEntry != 0)
+            lastEntry->next = toAdd;
+        else
+            entryTable[index] = toAdd;
+
+        toAdd->next = 0;
+        nEntries++;
+    }
+};
+
+
+///
+/// \brief puts all keys into a new map and looks each of them up several
+///        times (like a scope does for every use of an identifier), plus
+///        the same number of lookups of missing keys
+///
+/// \return the time in milliseconds
+///
+template <typename Map, typename K>
+static double measure(const std::vector<K>& keys, const std::vector<K>& missing,
+                      size_t rounds, size_t& checksum)
+{
+    clock_t start = clock();
+    for (size_t r = 0; r < rounds; r++) {
+        Map map;
+        for (size_t i = 0; i < keys.size(); i++) {
+            map.put(keys[i], i);
+        }
+        for (size_t pass = 0; pass < 4; pass++) {
+            for (size_t i = 0; i < keys.size(); i++) {
+                checksum += *map.getReference(keys[i]);
+            }
+            for (size_t i = 0; i < missing.size(); i++) {
+                checksum += map.getReference(missing[i]) != 0;
+            }
+        }
+    }
+    return 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+}
+
+
+template <typename K>
+static void compare(const char* name, const std::vector<K>& keys,
+                    const std::vector<K>& missing, size_t rounds)
+{
+    size_t chainedChecksum = 0;
+    size_t checksum = 0;
+    double chained = measure<ChainedHashMap<K, size_t> >(keys, missing, rounds,
+                                                         chainedChecksum);
+    double open = measure<uetli::util::HashMap<K, size_t> >(keys, missing,
+                                                            rounds, checksum);
+
+    printf("%-28s %10.1f ms %10.1f ms %8.2fx%s\n", name, chained, open,
+           chained / open, checksum != chainedChecksum ? "  (MISMATCH)" : "");
+}
+
+
+int main(void)
+{
+    printf("%-28s %13s %13s %9s\n", "", "chained", "open", "speedup");
+
+    const size_t sizes[] = { 8, 64, 1024, 65536 };
+    for (size_t s = 0; s < sizeof sizes / sizeof sizes[0]; s++) {
+        size_t size = sizes[s];
+        size_t rounds = 4 * 1024 * 1024 / size;
+
+        // identifiers like the ones found in a scope
+        std::vector<std::string> names;
+        std::vector<std::string> missingNames;
+        for (size_t i = 0; i < size; i++) {
+            char buffer[32];
+            sprintf(buffer, "variable%lu", (unsigned long) i);
+            names.push_back(buffer);
+            sprintf(buffer, "missing%lu", (unsigned long) i);
+            missingNames.push_back(buffer);
+        }
+
+        // pointer keys (as in the variable indices of a scope)
+        std::vector<char> objects(2 * size * 32);
+        std::vector<const char*> pointers;
+        std::vector<const char*> missingPointers;
+        for (size_t i = 0; i < size; i++) {
+            pointers.push_back(&objects[i * 32]);
+            missingPointers.push_back(&objects[(size + i) * 32]);
+        }
+
+        char name[64];
+        sprintf(name, "string keys, n = %lu", (unsigned long) size);
+        compare(name, names, missingNames, rounds / 8);
+        sprintf(name, "pointer keys, n = %lu", (unsigned long) size);
+        compare(name, pointers, missingPointers, rounds);
+    }
+    return 0;
+}
+
@@ -0,0 +1,308 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "CompileServer.h"
+
+#include <iostream>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using uetli::CompileServer;
+using uetli::parser::ClassDeclaration;
+
+
+///
+/// \return <code>false</code>, if not all of the data could be written
+///
+static bool writeAll(int fd, const std::string& data)
+{
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t result = ::write(fd, data.data() + written,
+                                 data.size() - written);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            return false;
+        written += result;
+    }
+    return true;
+}
+
+
+CompileServer::Compiler::~Compiler(void)
+{
+}
+
+
+CompileServer::CompileServer(Compiler& compiler,
+                             const std::string& socketPath,
+                             bool handScanner) :
+    compiler(compiler), socketPath(socketPath), handScanner(handScanner),
+    listener(-1)
+{
+}
+
+
+CompileServer::~CompileServer(void)
+{
+    for (size_t i = 0; i < files.size(); i++) {
+        delete files[i].parser;
+    }
+
+    if (listener >= 0) {
+        ::close(listener);
+        ::unlink(socketPath.c_str());
+    }
+}
+
+
+void CompileServer::run(void)
+{
+    struct sockaddr_un address;
+    ::memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof address.sun_path)
+        throw "socket path too long";
+    ::strcpy(address.sun_path, socketPath.c_str());
+
+    // only a socket left behind by an earlier server may be replaced
+    struct stat status;
+    if (::lstat(socketPath.c_str(), &status) == 0) {
+        if (!S_ISSOCK(status.st_mode))
+            throw "socket path exists and is not a socket";
+        ::unlink(socketPath.c_str());
+    }
+
+    listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        throw "could not create socket";
+
+    if (::bind(listener, (struct sockaddr*) &address, sizeof address) != 0 ||
+        ::listen(listener, 8) != 0) {
+        ::close(listener);
+        listener = -1;
+        throw "could not listen on socket";
+    }
+
+    // a client closing its connection early must not stop the server
+    ::signal(SIGPIPE, SIG_IGN);
+
+    bool running = true;
+    while (running) {
+        int connection = ::accept(listener, 0, 0);
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            throw "could not accept connection";
+        }
+        running = serveConnection(connection);
+        ::close(connection);
+    }
+}
+
+
+bool CompileServer::serveConnection(int connection)
+{
+    std::string received;
+    char buffer[4096];
+
+    for (;;) {
+        ssize_t count = ::read(connection, buffer, sizeof buffer);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return true;
+        received.append(buffer, count);
+
+        size_t end;
+        while ((end = received.find('\n')) != std::string::npos) {
+            std::string request = received.substr(0, end);
+            received.erase(0, end + 1);
+            if (!request.empty() && request[request.size() - 1] == '\r')
+                request.erase(request.size() - 1);
+
+            std::string reply;
+            bool running = handleRequest(request, reply);
+            if (!writeAll(connection, reply + "\n") || !running)
+                return running;
+        }
+    }
+}
+
+
+bool CompileServer::handleRequest(const std::string& request,
+                                  std::string& reply)
+{
+    size_t space = request.find(' ');
+    std::string command = request.substr(0, space);
+    std::string argument =
+            space != std::string::npos ? request.substr(space + 1) : "";
+
+    std::string error;
+    if (command == "shutdown") {
+        reply = "ok";
+        return false;
+    }
+    else if (argument.empty()) {
+        error = "invalid request: " + request;
+    }
+    else if (command == "change") {
+        error = changeFile(argument);
+    }
+    else if (command == "remove") {
+        error = removeFile(argument);
+    }
+    else if (command == "build") {
+        error = build(argument);
+    }
+    else {
+        error = "invalid request: " + request;
+    }
+
+    if (error.empty()) {
+        reply = "ok";
+    }
+    else {
+        // the reply has to fit on one line
+        for (size_t i = 0; i < error.size(); i++) {
+            if (error[i] == '\n')
+                error[i] = ' ';
+        }
+        reply = "error " + error;
+    }
+    return true;
+}
+
+
+std::string CompileServer::changeFile(const std::string& filename)
+{
+    RegisteredFile* file = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (files[i].filename == filename)
+            file = &files[i];
+    }
+
+    if (file == 0) {
+        RegisteredFile added;
+        added.filename = filename;
+        added.parser = 0;
+        files.push_back(added);
+        file = &files.back();
+    }
+
+    delete file->parser;
+    file->parser = new parser::ParallelParser(handScanner);
+    file->parser->addFile(filename);
+
+    try {
+        file->parser->parse(1);
+        file->errorMessage.clear();
+    }
+    catch (parser::ParserException& pe) {
+        file->errorMessage = pe.getErrorMessage();
+    }
+    return file->errorMessage;
+}
+
+
+std::string CompileServer::removeFile(const std::string& filename)
+{
+    for (size_t i = 0; i < files.size(); i++) {
+        if (files[i].filename == filename) {
+            delete files[i].parser;
+            files.erase(files.begin() + i);
+            return "";
+        }
+    }
+    return "unknown file: " + filename;
+}
+
+
+std::string CompileServer::build(const std::string& outputFilename)
+{
+    std::vector<ClassDeclaration*> classes;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (!files[i].errorMessage.empty())
+            return files[i].errorMessage;
+
+        std::vector<ClassDeclaration*> fileClasses =
+                files[i].parser->getClasses();
+        classes.insert(classes.end(), fileClasses.begin(), fileClasses.end());
+    }
+
+    int channel[2];
+    if (::pipe(channel) != 0)
+        return "could not start build";
+
+    // buffered output would otherwise be written by both processes
+    std::cout.flush();
+    ::fflush(stdout);
+
+    pid_t child = ::fork();
+    if (child < 0) {
+        ::close(channel[0]);
+        ::close(channel[1]);
+        return "could not start build";
+    }
+
+    if (child == 0) {
+        ::close(channel[0]);
+        std::string error = compiler.compile(classes, outputFilename);
+        std::cout.flush();
+        ::fflush(stdout);
+        writeAll(channel[1], error);
+
+        // the state of the server is not cleaned up by the child
+        ::_exit(0);
+    }
+
+    ::close(channel[1]);
+    std::string error;
+    char buffer[4096];
+    for (;;) {
+        ssize_t count = ::read(channel[0], buffer, sizeof buffer);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            break;
+        error.append(buffer, count);
+    }
+    ::close(channel[0]);
+
+    int status = 0;
+    while (::waitpid(child, &status, 0) < 0 && errno == EINTR) {
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return "build terminated abnormally";
+    return error;
+}
+
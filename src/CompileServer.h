@@ -0,0 +1,138 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_COMPILESERVER_H_
+#define UETLI_COMPILESERVER_H_
+
+#include <string>
+#include <vector>
+
+#include "parser/ParseObject.h"
+#include "parser/ParallelParser.h"
+
+namespace uetli
+{
+    class CompileServer;
+}
+
+
+///
+/// \brief serves compilation requests on a local (Unix domain) socket
+///
+/// The server keeps the parse trees of all registered source files, so only
+/// files reported as changed are parsed again. Every build runs in a child
+/// process forked from the server, which sees the parse trees without
+/// copying them. Everything the build allocates is freed with the child
+/// and a crashing build does not take down the server. Together with the
+/// compile cache, only the methods affected by a change are attributed and
+/// compiled again.
+///
+/// Every request is a single line, answered by a single line, which is
+/// either <code>ok</code> or <code>error</code> followed by a message:
+///
+/// <pre>
+/// change FILE    add FILE or parse it again after it changed
+/// remove FILE    forget FILE
+/// build OUTPUT   compile all files and write the object file OUTPUT
+/// shutdown       stop the server
+/// </pre>
+///
+class uetli::CompileServer
+{
+public:
+    ///
+    /// \brief compiles a program for the server
+    ///
+    class Compiler
+    {
+    public:
+        virtual ~Compiler(void);
+
+        ///
+        /// \param classes the classes of all source files
+        /// \param outputFilename the object file to write
+        /// \return an error message or an empty string on success
+        ///
+        virtual std::string compile(
+                const std::vector<parser::ClassDeclaration*>& classes,
+                const std::string& outputFilename) = 0;
+    };
+
+private:
+    struct RegisteredFile
+    {
+        std::string filename;
+
+        /// holds the parse tree of the file
+        parser::ParallelParser* parser;
+
+        /// the error of the last parse or an empty string
+        std::string errorMessage;
+    };
+
+    Compiler& compiler;
+    std::string socketPath;
+    bool handScanner;
+
+    /// the registered files in the order they were added
+    std::vector<RegisteredFile> files;
+
+    int listener;
+
+public:
+    ///
+    /// \param compiler compiles the programs
+    /// \param socketPath the path of the socket to listen on
+    /// \param handScanner if <code>true</code>, the files are scanned by the
+    ///                    hand-written scanner
+    ///
+    CompileServer(Compiler& compiler, const std::string& socketPath,
+                  bool handScanner);
+    ~CompileServer(void);
+
+    ///
+    /// \brief answer requests until a shutdown request is received
+    ///
+    /// \throws const char* if the socket cannot be set up
+    ///
+    void run(void);
+
+private:
+    ///
+    /// \return <code>false</code>, if the server has to stop
+    ///
+    bool serveConnection(int connection);
+
+    ///
+    /// \param reply the answer to the request
+    /// \return <code>false</code>, if the server has to stop
+    ///
+    bool handleRequest(const std::string& request, std::string& reply);
+
+    std::string changeFile(const std::string& filename);
+    std::string removeFile(const std::string& filename);
+    std::string build(const std::string& outputFilename);
+};
+
+
+#endif // UETLI_COMPILESERVER_H_
+
@@ -24,11 +24,23 @@
 #include "parser/uetli_parser.h"
 #include "semantic/TreeBuilder.h"
 #include "code/StackCodeGenerator.h"
+#include "code/Linker.h"
+#include "code/Interpreter.h"
+#include "code/Optimizer.h"
+#include "code/ExecutionContext.h"
 #include "assembly/AssemblyGenerator.h"
 #include "assembly/Assemblyx86_64.h"
+#include "assembly/JitCompiler.h"
+#include "assembly/ElfWriter.h"
+#include "assembly/CompileCache.h"
+#include "util/ThreadPool.h"
+#include "util/Trace.h"
+#include "parser/ParallelParser.h"
 
 #include <cstdio>
 #include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
 
 using uetli::ConsoleInterface;
 using uetli::UetliConsoleInterface;
@@ -55,7 +67,10 @@ void ConsoleInterface::printError(const std::string& error)
 
 UetliConsoleInterface::UetliConsoleInterface(int argc, char** argv) :
     ConsoleInterface(argc, argv),
-    outputFilename("a.out")
+    outputFilename("a.out"),
+    threadCount(uetli::util::ThreadPool::getDefaultThreadCount()),
+    optimizationLevel(uetli::code::defaultOptimizationLevel),
+    inlineLimit(uetli::code::defaultInlineLimit)
 {
     for (size_t i = 1; i < arguments.size(); i++) {
         if (arguments[i] == "-o") {
@@ -69,15 +84,98 @@ UetliConsoleInterface::UetliConsoleInterface(int argc, char** argv) :
                 exit(1);
             }
         }
-        else if(arguments[i] != "") { // normal string argument
-            if (!inputFiles.empty()) {
-                printError("multiple source files specified");
+        else if (arguments[i] == "-j") {
+            int count = 0;
+            if (arguments.size() > i + 1)
+                count = atoi(arguments[i + 1].c_str());
+            if (count <= 0) {
+                printError("-j requires a positive number of threads");
+                fflush(stderr);
+                exit(1);
+            }
+            threadCount = count;
+            i++;
+        }
+        else if (arguments[i].compare(0, 2, "-O") == 0) {
+            const std::string level = arguments[i].substr(2);
+            if (level.empty() ||
+                level.find_first_not_of("0123456789") != std::string::npos) {
+                printError("invalid optimization level: " + arguments[i]);
+                fflush(stderr);
+                exit(1);
+            }
+            optimizationLevel = atoi(level.c_str());
+        }
+        else if (arguments[i].compare(0, 15, "-finline-limit=") == 0) {
+            const std::string limit = arguments[i].substr(15);
+            if (limit.empty() ||
+                limit.find_first_not_of("0123456789") != std::string::npos) {
+                printError("invalid inline limit: " + arguments[i]);
+                fflush(stderr);
+                exit(1);
+            }
+            inlineLimit = atoi(limit.c_str());
+        }
+        else if (arguments[i] == "--interpret") {
+            Setting setting;
+            setting.type = Setting::INTERPRET;
+            settings.push_back(setting);
+        }
+        else if (arguments[i] == "--jit") {
+            Setting setting;
+            setting.type = Setting::JIT;
+            settings.push_back(setting);
+        }
+        else if (arguments[i] == "-S") {
+            Setting setting;
+            setting.type = Setting::ASSEMBLY_TEXT;
+            settings.push_back(setting);
+        }
+        else if (arguments[i] == "--hand-scanner") {
+            Setting setting;
+            setting.type = Setting::HAND_SCANNER;
+            settings.push_back(setting);
+        }
+        else if (arguments[i] == "--server") {
+            if (arguments.size() <= i + 1) {
+                printError("no socket specified");
                 fflush(stderr);
                 exit(1);
             }
+            Setting setting;
+            setting.type = Setting::SERVER;
+            setting.argument = arguments[i + 1];
+            settings.push_back(setting);
+            i++;
+        }
+        else if (arguments[i] == "-ftime-report") {
+            timeReport.setEnabled(true);
+        }
+        else if (arguments[i].compare(0, 8, "--trace=") == 0) {
+            Setting setting;
+            setting.type = Setting::TRACE;
+            setting.argument = arguments[i].substr(8);
+            if (setting.argument.empty()) {
+                printError("no trace file specified");
+                fflush(stderr);
+                exit(1);
+            }
+            settings.push_back(setting);
+        }
+        else if (arguments[i] == "--cache") {
+            if (arguments.size() <= i + 1) {
+                printError("no cache directory specified");
+                fflush(stderr);
+                exit(1);
+            }
+            Setting setting;
+            setting.type = Setting::COMPILE_CACHE;
+            setting.argument = arguments[i + 1];
+            settings.push_back(setting);
+            i++;
+        }
+        else if(arguments[i] != "") { // normal string argument
             inputFiles.push_back(arguments[i]);
-            in = fopen(arguments[i].c_str(), "r");
-            openedFiles.push_back(in);
         }
     }
 }
@@ -85,10 +183,29 @@ UetliConsoleInterface::UetliConsoleInterface(int argc, char** argv) :
 
 UetliConsoleInterface::~UetliConsoleInterface(void)
 {
-    for (size_t i = 0; i < openedFiles.size(); i++) {
-        fclose(openedFiles[i]);
+}
+
+
+///
+/// \return the message of the exception currently handled
+///
+static std::string getExceptionMessage(void)
+{
+    try {
+        throw;
+    }
+    catch (uetli::parser::ParserException& pe) {
+        return pe.getErrorMessage();
+    }
+    catch (uetli::code::ExecutionException& ee) {
+        return ee.getErrorMessage();
+    }
+    catch (uetli::assembly::AssemblyException& ae) {
+        return ae.getErrorMessage();
+    }
+    catch (...) {
+        return "compilation terminated due to fatal error";
     }
-    openedFiles.clear();
 }
 
 
@@ -97,86 +214,321 @@ int UetliConsoleInterface::run(void) throw()
     try {
         return runInterface();
     }
-    catch (uetli::parser::ParserException& pe) {
-        printError(pe.getErrorMessage());
-    }
     catch (...) {
-        printError("compilation terminated due to fatal error");
+        printError(getExceptionMessage());
     }
     return 1;
 }
 
 
+std::string UetliConsoleInterface::compile(
+        const std::vector<uetli::parser::ClassDeclaration*>& classes,
+        const std::string& outputFilename)
+{
+    timeReport.clear();
+    if (isSet(Setting::TRACE))
+        util::startTracing();
+
+    try {
+        if (compileClasses(classes, 0, outputFilename) != 0)
+            return "compilation failed";
+    }
+    catch (...) {
+        return getExceptionMessage();
+    }
+
+    timeReport.endPhase();
+    timeReport.print(stderr);
+    if (isSet(Setting::TRACE) && !util::writeTrace(getArgument(Setting::TRACE)))
+        return "could not write trace file";
+    return "";
+}
+
+
+bool UetliConsoleInterface::isSet(Setting::Type type) const
+{
+    for (size_t i = 0; i < settings.size(); i++) {
+        if (settings[i].type == type)
+            return true;
+    }
+    return false;
+}
+
+
+const std::string& UetliConsoleInterface::getArgument(Setting::Type type) const
+{
+    static const std::string none;
+    for (size_t i = settings.size(); i > 0; i--) {
+        if (settings[i - 1].type == type)
+            return settings[i - 1].argument;
+    }
+    return none;
+}
+
+
 int UetliConsoleInterface::runInterface(void)
 {
     using std::cout;
 
-    ::uetli_parser_in = stdin;
+    if (isSet(Setting::SERVER))
+        return runServer();
+
+    if (isSet(Setting::TRACE))
+        util::startTracing();
+
+    // each file is parsed into its own arena
+    uetli::parser::ParallelParser parser(isSet(Setting::HAND_SCANNER));
+
+    if (inputFiles.empty())
+        parser.addStream(stdin);
+    for (size_t i = 0; i < inputFiles.size(); i++) {
+        parser.addFile(inputFiles[i]);
+    }
 
     bool log = true;
 
     if (log) {
         cout << "starting parsing..." << std::endl;
     }
-    
-    ::uetli_parser_parse();
+
+    timeReport.startPhase("parsing");
+    parser.parse(threadCount);
 
     if (log) {
         cout << "done parsing" << std::endl;
     }
 
-    for (size_t i = 0; i < openedFiles.size(); i++) {
-        fclose(openedFiles[i]);
+    int result = compileClasses(parser.getClasses(), &parser, outputFilename);
+
+    timeReport.endPhase();
+    timeReport.print(stderr);
+    if (isSet(Setting::TRACE)) {
+        if (!util::writeTrace(getArgument(Setting::TRACE))) {
+            printError("could not write trace file");
+            return 1;
+        }
     }
+    return result;
+}
 
-    openedFiles.clear(); 
 
-    if (parsedClasses == 0) {
-        cout << "Aborting Compilation" << std::endl;
-        return 1;
+int UetliConsoleInterface::runServer(void)
+{
+    // without a cache, every build would compile everything again
+    std::string temporaryDirectory;
+    if (!isSet(Setting::COMPILE_CACHE)) {
+        char directory[] = "/tmp/uetli-cache-XXXXXX";
+        if (::mkdtemp(directory) == 0) {
+            printError("could not create cache directory");
+            return 1;
+        }
+        temporaryDirectory = directory;
+
+        Setting setting;
+        setting.type = Setting::COMPILE_CACHE;
+        setting.argument = temporaryDirectory;
+        settings.push_back(setting);
     }
 
+    int result = 0;
+    try {
+        CompileServer server(*this, getArgument(Setting::SERVER),
+                             isSet(Setting::HAND_SCANNER));
+        server.run();
+    }
+    catch (const char* message) {
+        printError(message);
+        result = 1;
+    }
 
-    uetli::semantic::TreeBuilder tb(*parsedClasses);
+    if (!temporaryDirectory.empty()) {
+        DIR* directory = ::opendir(temporaryDirectory.c_str());
+        struct dirent* entry;
+        while (directory != 0 && (entry = ::readdir(directory)) != 0) {
+            std::string name = entry->d_name;
+            if (name != "." && name != "..")
+                ::unlink((temporaryDirectory + "/" + name).c_str());
+        }
+        if (directory != 0)
+            ::closedir(directory);
+        ::rmdir(temporaryDirectory.c_str());
+    }
+    return result;
+}
 
-    tb.build();
 
-    if (log) {
-        cout << "built attributed syntax tree." << std::endl;
-    }
+int UetliConsoleInterface::compileClasses(
+        const std::vector<uetli::parser::ClassDeclaration*>& parsedClasses,
+        uetli::parser::ParallelParser* parser,
+        const std::string& outputFilename)
+{
+    using std::cout;
+
+    bool log = true;
 
-    for (size_t i = 0; i < parsedClasses->size(); i++) {
-        delete parsedClasses->at(i);
+    uetli::semantic::TreeBuilder tb(parsedClasses);
+
+    // the bodies of the methods found in the cache are not attributed
+    bool useCache = isSet(Setting::COMPILE_CACHE);
+    uetli::assembly::CompileCache cache(getArgument(Setting::COMPILE_CACHE),
+                                        optimizationLevel, inlineLimit);
+    if (useCache) {
+        timeReport.startPhase("cache lookup");
+        cache.lookUp(parsedClasses);
+        for (size_t i = 0; i < cache.getCachedMethods().size(); i++) {
+            tb.skipBody(cache.getCachedMethods()[i]);
+        }
     }
 
-    delete parsedClasses;
-    parsedClasses = 0;
+    timeReport.startPhase("attribution");
+    tb.build(threadCount);
+    timeReport.endPhase();
 
+    if (log) {
+        cout << "built attributed syntax tree." << std::endl;
+    }
 
     const std::vector<uetli::semantic::EffectiveClass*>& classes =
             tb.getAttributedClasses();
 
-    std::vector<uetli::code::DirectSubroutine*> subroutines;
-
+    std::vector<uetli::semantic::Method*> methods;
     for (size_t i = 0; i < classes.size();  i++) {
         uetli::semantic::EffectiveClass* cl = classes[i];
 
         for (size_t j = 0; j < cl->getNMethods(); j++) {
-            uetli::semantic::Method* method = cl->getMethod(j);
+            methods.push_back(cl->getMethod(j));
+        }
+    }
 
-            uetli::code::StackCodeGenerator scg(method);
-            scg.generateCode();
+    // the code of the cached methods is taken from the cache, only the other
+    // ones are generated
+    std::vector<uetli::code::DirectSubroutine*> subroutines(methods.size(), 0);
+    std::vector<uetli::assembly::SubroutineCode*> cachedCode(methods.size(), 0);
+    std::vector<uetli::assembly::CompileCache::Key> keys;
+    std::vector<uetli::semantic::Method*> uncachedMethods;
+    std::vector<size_t> uncachedIndices;
+
+    for (size_t i = 0; i < methods.size(); i++) {
+        uetli::assembly::CompileCache::Entry entry;
+        if (useCache) {
+            const uetli::parser::MethodDeclaration* declaration =
+                    tb.getDeclaration(methods[i]);
+            keys.push_back(cache.getKey(declaration));
+
+            if (cache.takeEntry(declaration, entry)) {
+                subroutines[i] = entry.subroutine;
+                cachedCode[i] = entry.code;
+                continue;
+            }
+        }
+        uncachedMethods.push_back(methods[i]);
+        uncachedIndices.push_back(i);
+    }
 
-            uetli::code::DirectSubroutine* rout = scg.getGeneratedCode();
+    if (parser != 0)
+        parser->release();
 
-            subroutines.push_back(rout);
-        }
+    if (log && useCache) {
+        cout << "reused " << methods.size() - uncachedMethods.size() <<
+                " of " << methods.size() << " methods from the cache" <<
+                std::endl;
+    }
+
+    timeReport.startPhase("stack code generation");
+    std::vector<uetli::code::DirectSubroutine*> generated =
+            uetli::code::generateCode(uncachedMethods, threadCount);
+    for (size_t i = 0; i < generated.size(); i++) {
+        subroutines[uncachedIndices[i]] = generated[i];
+    }
+
+    timeReport.startPhase("linking");
+    uetli::code::Linker linker(&tb.getIntrinsics());
+    for (size_t i = 0; i < subroutines.size(); i++) {
+        linker.addSubroutine(subroutines[i]);
     }
 
+    linker.link();
+
+    // the cached subroutines were optimized before they were stored
+    timeReport.startPhase("optimization");
+    uetli::code::optimizeCode(generated, optimizationLevel, inlineLimit,
+                              threadCount);
+    timeReport.endPhase();
 
-    uetli::assembly::AssemblyGenerator assemblyGenerator;
+
+    uetli::code::DirectSubroutine* entryPoint = 0;
     for (size_t i = 0; i < subroutines.size(); i++) {
-        assemblyGenerator.generateAssembly(subroutines[i]);
+        if (subroutines[i]->getName().getLastSegment() == "main") {
+            entryPoint = subroutines[i];
+            break;
+        }
+    }
+
+    if ((isSet(Setting::INTERPRET) || isSet(Setting::JIT)) &&
+        entryPoint == 0) {
+        printError("no main method found");
+        return 1;
+    }
+
+
+    if (isSet(Setting::INTERPRET)) {
+        timeReport.startPhase("interpretation");
+        uetli::code::BytecodeModule module;
+        uetli::code::Interpreter interpreter;
+
+        uetli::code::ExecutionContext context;
+
+        // the entry point is called without any "this" object
+        context.push(0);
+        interpreter.execute(module.getBytecode(entryPoint), context);
+        timeReport.endPhase();
+    }
+
+
+    if (isSet(Setting::JIT)) {
+        timeReport.startPhase("JIT compilation");
+        uetli::assembly::JitCompiler jit(optimizationLevel);
+        for (size_t i = 0; i < subroutines.size(); i++) {
+            jit.addSubroutine(subroutines[i]);
+        }
+        jit.compile();
+
+        timeReport.startPhase("execution");
+        typedef void (*EntryFunction)(void);
+        EntryFunction main = reinterpret_cast<EntryFunction>(
+                    jit.getFunction(entryPoint->getName()));
+        main();
+        timeReport.endPhase();
+
+        if (log) {
+            cout << "executed " << entryPoint->getName().getAsString() <<
+                    std::endl;
+        }
+
+        for (size_t i = 0; i < subroutines.size(); i++) {
+            delete subroutines[i];
+            delete cachedCode[i];
+        }
+        return 0;
+    }
+
+
+    timeReport.startPhase("assembly generation");
+    uetli::assembly::AssemblyGenerator assemblyGenerator(optimizationLevel);
+    assemblyGenerator.generateAssembly(subroutines, cachedCode, threadCount);
+
+    if (useCache) {
+        timeReport.startPhase("cache store");
+        std::vector<uetli::assembly::CompileCache::Key> storedKeys;
+        std::vector<const uetli::code::DirectSubroutine*> storedSubroutines;
+        std::vector<const uetli::assembly::SubroutineCode*> storedCode;
+        for (size_t i = 0; i < uncachedIndices.size(); i++) {
+            size_t index = uncachedIndices[i];
+            storedKeys.push_back(keys[index]);
+            storedSubroutines.push_back(subroutines[index]);
+            storedCode.push_back(&assemblyGenerator.getSubroutineCode(index));
+        }
+        cache.store(storedKeys, storedSubroutines, storedCode, threadCount);
     }
 
     for (size_t i = 0; i < subroutines.size(); i++) {
@@ -208,14 +560,37 @@ int UetliConsoleInterface::runInterface(void)
 #endif
 
 
-    assemblyGenerator.writeAssembly(stdout);
+    if (isSet(Setting::ASSEMBLY_TEXT)) {
+        timeReport.startPhase("assembly output");
+        assemblyGenerator.writeAssembly(stdout);
 
+        timeReport.startPhase("assembler");
+        FILE* assembler =
+            ::popen((std::string("as -o ") + outputFilename).c_str(), "w");
 
-    FILE* assembler =
-        ::popen((std::string("as -o ") + outputFilename).c_str(), "w"); // r+
+        assemblyGenerator.writeAssembly(assembler);
+        ::pclose(assembler);
+    }
+    else {
+        timeReport.startPhase("object file output");
+        uetli::assembly::MachineCode code;
+        assemblyGenerator.encode(code);
+        code.resolveRelocations();
 
-    assemblyGenerator.writeAssembly(assembler);
-    ::pclose(assembler);
+        FILE* output = ::fopen(outputFilename.c_str(), "wb");
+        if (!output) {
+            throw uetli::assembly::AssemblyException(
+                    "could not create file: " + outputFilename);
+        }
+        try {
+            uetli::assembly::ElfWriter(code).write(output);
+        }
+        catch (...) {
+            ::fclose(output);
+            throw;
+        }
+        ::fclose(output);
+    }
 
 
 #if 0
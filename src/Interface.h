@@ -28,6 +28,9 @@
 #include <vector>
 #include <iostream>
 
+#include "CompileServer.h"
+#include "util/TimeReport.h"
+
 
 namespace uetli
 {
@@ -54,17 +57,53 @@ public:
 };
 
 
-class uetli::UetliConsoleInterface : public ConsoleInterface
+class uetli::UetliConsoleInterface :
+        public ConsoleInterface,
+        public CompileServer::Compiler
 {
     std::string outputFilename;
-    FILE* in;
     std::vector<std::string> inputFiles;
-    std::vector<FILE*> openedFiles;
+
+    /// number of threads used for compiling
+    size_t threadCount;
+
+    /// 0 disables all optimizations
+    unsigned int optimizationLevel;
+
+    /// the maximum number of instructions of an inlined subroutine
+    size_t inlineLimit;
+
+    /// measures the phases of the compilation (if -ftime-report is given)
+    util::TimeReport timeReport;
 
     struct Setting
     {
         enum Type
         {
+            /// execute the main method using the bytecode interpreter
+            INTERPRET,
+
+            /// compile to machine code in memory and execute the main method
+            JIT,
+
+            /// write the assembly as text and run the external assembler
+            /// instead of writing the object file directly
+            ASSEMBLY_TEXT,
+
+            /// map the source into memory and scan it with the hand-written
+            /// scanner instead of the flex lexer
+            HAND_SCANNER,
+
+            /// reuse the code of unchanged methods from the cache in the
+            /// directory given as argument and store the code of the others
+            COMPILE_CACHE,
+
+            /// serve compilation requests on the socket given as argument
+            SERVER,
+
+            /// write the trace events of the compilation to the file given
+            /// as argument
+            TRACE,
         };
 
         Type type;
@@ -79,8 +118,39 @@ public:
 
     virtual int run(void) throw();
 
+    virtual std::string compile(
+            const std::vector<parser::ClassDeclaration*>& classes,
+            const std::string& outputFilename);
+
 private:
     int runInterface(void);
+
+    ///
+    /// \brief run a compile server until it is shut down
+    ///
+    /// If no cache directory is set, a temporary one is used while the
+    /// server is running.
+    ///
+    int runServer(void);
+
+    ///
+    /// \brief compile the parsed classes and write or execute the program
+    ///
+    /// \param parser if specified, the parse trees are released as soon as
+    ///               they are not needed anymore
+    /// \param outputFilename the object file to write
+    ///
+    int compileClasses(
+            const std::vector<parser::ClassDeclaration*>& parsedClasses,
+            parser::ParallelParser* parser,
+            const std::string& outputFilename);
+
+    bool isSet(Setting::Type type) const;
+
+    ///
+    /// \return the argument of the last setting of the given type
+    ///
+    const std::string& getArgument(Setting::Type type) const;
 };
 
 
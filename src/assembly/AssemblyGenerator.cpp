@@ -21,6 +21,11 @@
 
 
 #include "AssemblyGenerator.h"
+#include "Runtime.h"
+#include "../ir/Optimizer.h"
+#include "../ir/SsaBuilder.h"
+#include "../util/ThreadPool.h"
+#include "../util/Trace.h"
 
 #include <cstdio>
 
@@ -28,22 +33,93 @@ using namespace uetli::assembly;
 using namespace uetli::assembly::x86_64;
 
 
-const size_t AssemblySubroutine::nCallerSavedGPRegisters = 9;
-const Register AssemblySubroutine::callerSavedGPRegisters[] = {
-    RAX, RCX, RDX, RSI, RDI, R8, R9, R10, R11,
-};
+namespace
+{
+    ///
+    /// \brief generates one subroutine per iteration, unless its code is
+    ///        already in the output
+    ///
+    class AssemblyLoop : public uetli::util::ThreadPool::Loop
+    {
+        const std::vector<uetli::code::DirectSubroutine*>& subroutines;
+        std::vector<SubroutineCode*>& output;
+        unsigned int optimizationLevel;
+    public:
+        AssemblyLoop(
+                const std::vector<uetli::code::DirectSubroutine*>& subroutines,
+                std::vector<SubroutineCode*>& output,
+                unsigned int optimizationLevel);
+
+        virtual void run(size_t index);
+    };
+}
+
+
+///
+/// \brief lower a subroutine, through its SSA form if it is optimized and
+///        can be translated
+///
+static SubroutineCode* generateSubroutine(
+        const uetli::code::DirectSubroutine* subroutine,
+        unsigned int optimizationLevel)
+{
+    if (optimizationLevel == 0)
+        return new AssemblySubroutine(subroutine);
+
+    uetli::ir::SsaBuilder builder;
+    uetli::ir::Function* function = builder.build(subroutine);
+    if (function == 0)
+        return new AssemblySubroutine(subroutine);
+
+    SubroutineCode* code = 0;
+    try {
+        uetli::ir::optimizeFunction(function);
+        code = new AssemblySubroutine(function);
+    }
+    catch (...) {
+        delete function;
+        throw;
+    }
+    delete function;
+    return code;
+}
+
+
+AssemblyLoop::AssemblyLoop(
+        const std::vector<uetli::code::DirectSubroutine*>& subroutines,
+        std::vector<SubroutineCode*>& output,
+        unsigned int optimizationLevel) :
+    subroutines(subroutines), output(output),
+    optimizationLevel(optimizationLevel)
+{
+}
+
+
+void AssemblyLoop::run(size_t index)
+{
+    if (output[index] == 0)
+        output[index] = generateSubroutine(subroutines[index],
+                                           optimizationLevel);
+}
+
+
+SubroutineCode::~SubroutineCode(void)
+{
+}
 
 
-const size_t AssemblySubroutine::nCallerSavedGPRegisters = 6;
-const Register AssemblySubroutine::callerSavedGPRegisters[] = {
+const size_t AssemblySubroutine::nArgumentRegisters = 6;
+const Register AssemblySubroutine::argumentRegisters[] = {
     RDI, RSI, RDX, RCX, R8, R9
 };
 
 
 AssemblySubroutine::AssemblySubroutine(
         const uetli::code::DirectSubroutine* subroutine) :
-    operationStackSize(0),
-    nPushedRegisters(0),
+    allocator(subroutine),
+    nextValue(0),
+    variableCount(subroutine->getArgumentCount() +
+                  subroutine->getLocalVariableCount()),
     name(subroutine->getName()),
     labelName(subroutine->getName().getAssemblySymbol())
 {
@@ -51,6 +127,28 @@ AssemblySubroutine::AssemblySubroutine(
 }
 
 
+AssemblySubroutine::AssemblySubroutine(const ir::Function* function) :
+    allocator(function),
+    nextValue(0),
+    variableCount(function->getArgumentCount()),
+    name(function->getName()),
+    labelName(function->getName().getAssemblySymbol())
+{
+    generate(function);
+}
+
+
+AssemblySubroutine::~AssemblySubroutine(void)
+{
+    for (size_t i = 0; i < instructions.size(); i++) {
+        delete instructions[i];
+    }
+    for (size_t i = 0; i < operands.size(); i++) {
+        delete operands[i];
+    }
+}
+
+
 std::string AssemblySubroutine::toString(void) const
 {
     std::string result;
@@ -62,19 +160,39 @@ std::string AssemblySubroutine::toString(void) const
 }
 
 
-const std::string& AssemblySubroutine::getLabelName(void)
+const std::string& AssemblySubroutine::getLabelName(void) const
 {
     return labelName;
 }
 
 
+void AssemblySubroutine::encode(MachineCode& code) const
+{
+    code.defineSymbol(labelName);
+    for (size_t i = 0; i < instructions.size(); i++) {
+        instructions[i]->encode(code);
+    }
+}
+
+
 void AssemblySubroutine::generate(
         const uetli::code::DirectSubroutine* subroutine)
 {
+    util::TraceSpan span("generate assembly");
+    if (span.isRecording())
+        span.setName(subroutine->getName().getAsString());
+
+    allocator.allocate();
+    generatePrologue(subroutine->getArgumentCount());
+
     for (size_t i = 0; i < subroutine->getInstructions().size(); i++) {
         generateInstruction(subroutine->getInstructions()[i]);
     }
-    instructions.push_back(new Ret());
+
+    if (!stack.empty())
+        generateEpilogue(getValueSource(stack.back()));
+    else
+        generateEpilogue(getConstant(0));
 }
 
 
@@ -83,55 +201,253 @@ void AssemblySubroutine::generateInstruction(
 {
     using namespace uetli::code;
 
-    const CallInstruction* callInst = 0;
-    const LoadInstruction* loadInst = 0;
-
-    if ((callInst = dynamic_cast<const CallInstruction*>(instruction))) {
-        
-        Call* c = new Call(
-                    callInst->getSubroutine()->getName().getAssemblySymbol());
-        if (!registersSaved)
-            saveNeededRegisters();
-        size_t nArguments = callInst->getSubroutine()->getArgumentCount();
-        if (nArguments >= nArgumentRegisters) {
-            throw "too many arguments; not yet implemented";
+    RegisterAllocator::StackEffect effect =
+            RegisterAllocator::getStackEffect(instruction);
+
+    // values read by the instruction (the deepest first) and pushed by it
+    std::vector<size_t> used(stack.end() - effect.uses, stack.end());
+    std::vector<size_t> defined;
+    stack.resize(stack.size() - effect.pops);
+    for (size_t i = 0; i < effect.pushes; i++) {
+        defined.push_back(nextValue);
+        stack.push_back(nextValue++);
+    }
+
+    const RegisterOperand* rax = RegisterOperand::getRegisterOperand(RAX);
+
+    const LoadInstruction* load = 0;
+    const StoreInstruction* store = 0;
+    const DereferenceInstruction* dereference = 0;
+    const DereferenceStoreInstruction* dereferenceStore = 0;
+    const CallInstruction* call = 0;
+    const LoadConstantInstruction* loadConstant = 0;
+    const IntrinsicInstruction* intrinsic = 0;
+    const DirectSubroutine* inlineSubroutine = 0;
+
+    if ((load = dynamic_cast<const LoadInstruction*>(instruction))) {
+        move(getVariable(load->getFromTop()), getValueDestination(defined[0]));
+    }
+    else if ((store = dynamic_cast<const StoreInstruction*>(instruction))) {
+        move(getValueSource(used[0]), getVariable(store->getFromTop()));
+    }
+    else if ((dereference =
+              dynamic_cast<const DereferenceInstruction*>(instruction))) {
+        move(getPointee(used[0], dereference->getOffset()),
+             getValueDestination(defined[0]));
+    }
+    else if ((dereferenceStore =
+              dynamic_cast<const DereferenceStoreInstruction*>(instruction))) {
+        move(getValueSource(used[1]),
+             getPointee(used[0], dereferenceStore->getOffset()));
+    }
+    else if (dynamic_cast<const PopInstruction*>(instruction)) {
+        // the value is simply not used anymore
+    }
+    else if ((call = dynamic_cast<const CallInstruction*>(instruction))) {
+        callFunction(call->getSubroutine()->getName().getAssemblySymbol(),
+                     getValueSources(used));
+        move(rax, getValueDestination(defined[0]));
+    }
+    else if ((loadConstant =
+              dynamic_cast<const LoadConstantInstruction*>(instruction))) {
+        move(getConstant(loadConstant->getConstant()),
+             getValueDestination(defined[0]));
+    }
+    else if (dynamic_cast<const AllocateInstruction*>(instruction)) {
+        callFunction(allocateSymbol, getValueSources(used));
+        move(rax, getValueDestination(defined[0]));
+    }
+    else if (dynamic_cast<const DuplicateInstruction*>(instruction)) {
+        move(getValueSource(used[0]), getValueDestination(defined[0]));
+    }
+    else if (dynamic_cast<const PrintInstruction*>(instruction)) {
+        callFunction(printSymbol, getValueSources(used));
+    }
+    else if ((intrinsic =
+              dynamic_cast<const IntrinsicInstruction*>(instruction))) {
+        generateIntrinsic(intrinsic->getIntrinsic(), getValueSource(used[0]),
+                          getValueSource(used[1]),
+                          getValueDestination(defined[0]));
+    }
+    else if ((inlineSubroutine =
+              dynamic_cast<const DirectSubroutine*>(instruction))) {
+        callFunction(inlineSubroutine->getName().getAssemblySymbol(),
+                     getValueSources(used));
+        move(rax, getValueDestination(defined[0]));
+    }
+}
+
+
+void AssemblySubroutine::generate(const ir::Function* function)
+{
+    util::TraceSpan span("generate assembly");
+    if (span.isRecording())
+        span.setName(function->getName().getAsString());
+
+    allocator.allocate();
+    generatePrologue(function->getArgumentCount());
+
+    const std::vector<ir::BasicBlock*>& blocks = function->getBlocks();
+    for (size_t i = 0; i < blocks.size(); i++) {
+        const std::vector<ir::Instruction*>& instructions =
+                blocks[i]->getInstructions();
+        for (size_t j = 0; j < instructions.size(); j++) {
+            generateInstruction(instructions[j]);
         }
-        for (size_t i = 0; i < nArguments; i++) {
+    }
+}
 
+
+void AssemblySubroutine::generateInstruction(
+        const ir::Instruction* instruction)
+{
+    const ir::ArgumentInstruction* argument = 0;
+    const ir::IntrinsicInstruction* intrinsic = 0;
+    const ir::CallInstruction* call = 0;
+
+    if ((argument =
+         dynamic_cast<const ir::ArgumentInstruction*>(instruction))) {
+        move(getFrameSlot(argument->getIndex()),
+             getValueDestination(allocator.getValueNumber(instruction)));
+    }
+    else if (dynamic_cast<const ir::ConstantInstruction*>(instruction)) {
+        // constants are used as immediate operands
+    }
+    else if (dynamic_cast<const ir::CopyInstruction*>(instruction)) {
+        move(getOperandSource(instruction->getOperand(0)),
+             getValueDestination(allocator.getValueNumber(instruction)));
+    }
+    else if ((intrinsic =
+              dynamic_cast<const ir::IntrinsicInstruction*>(instruction))) {
+        generateIntrinsic(intrinsic->getIntrinsic(),
+                getOperandSource(instruction->getOperand(0)),
+                getOperandSource(instruction->getOperand(1)),
+                getValueDestination(allocator.getValueNumber(instruction)));
+    }
+    else if ((call = dynamic_cast<const ir::CallInstruction*>(instruction))) {
+        std::vector<const Source*> arguments;
+        for (size_t i = 0; i < call->getOperandCount(); i++) {
+            arguments.push_back(getOperandSource(call->getOperand(i)));
         }
-        instructions.push_back(c);
-    }
-    if ((loadInst = dynamic_cast<const LoadInstruction*>(instruction))) {
-        if (registersSaved)
-            restoreNeededRegisters();
-
-        Register currentReg = callerSavedGPRegisters[(operationStackSize) %
-                nCallerSavedGPRegisters];
-        if (operationStackSize >= nCallerSavedGPRegisters) {
-            Push* push = new Push(RegisterOperand::getRegisterOperand(
-                                      currentReg));
-            instructions.push_back(push);
-            nPushedRegisters++;
+        callFunction(call->getCallee().getAssemblySymbol(), arguments);
+        move(RegisterOperand::getRegisterOperand(RAX),
+             getValueDestination(allocator.getValueNumber(instruction)));
+    }
+    else if (dynamic_cast<const ir::ReturnInstruction*>(instruction)) {
+        generateEpilogue(getOperandSource(instruction->getOperand(0)));
+    }
+}
+
+
+void AssemblySubroutine::generatePrologue(size_t argumentCount)
+{
+    if (argumentCount > nArgumentRegisters) {
+        throw "too many arguments; not yet implemented";
+    }
+
+    const std::vector<Register>& calleeSaved =
+            allocator.getUsedCalleeSavedRegisters();
+
+    // keep the stack pointer aligned to 16 bytes for calls
+    size_t slots = variableCount + calleeSaved.size() +
+            allocator.getSpillSlotCount();
+    createStackFrame((slots * wordSize + 15) / 16 * 16);
+
+    for (size_t i = 0; i < calleeSaved.size(); i++) {
+        move(RegisterOperand::getRegisterOperand(calleeSaved[i]),
+             getFrameSlot(variableCount + i));
+    }
+    for (size_t i = 0; i < argumentCount; i++) {
+        move(RegisterOperand::getRegisterOperand(argumentRegisters[i]),
+             getFrameSlot(i));
+    }
+    for (size_t i = argumentCount; i < variableCount; i++) {
+        move(getConstant(0), getFrameSlot(i));
+    }
+}
+
+
+void AssemblySubroutine::generateEpilogue(const Source* result)
+{
+    move(result, RegisterOperand::getRegisterOperand(RAX));
+
+    const std::vector<Register>& calleeSaved =
+            allocator.getUsedCalleeSavedRegisters();
+    for (size_t i = 0; i < calleeSaved.size(); i++) {
+        move(getFrameSlot(variableCount + i),
+             RegisterOperand::getRegisterOperand(calleeSaved[i]));
+    }
+    destroyStackFrame();
+    instructions.push_back(new Ret());
+}
+
+
+void AssemblySubroutine::generateIntrinsic(code::Intrinsic intrinsic,
+                                           const Source* left,
+                                           const Source* right,
+                                           const Destination* destination)
+{
+    const RegisterOperand* rax = RegisterOperand::getRegisterOperand(RAX);
+    const Source* rightSource = right;
+
+    // idiv only takes a register or memory operand, and the other
+    // instructions only take constants fitting in 32 bits
+    const ConstantOperand* constant =
+            dynamic_cast<const ConstantOperand*>(right);
+    if (constant != 0) {
+        long long value = (long long) constant->getValue();
+        if (intrinsic == code::INTEGER_DIVIDE ||
+            value < -0x80000000LL || value > 0x7FFFFFFFLL) {
+            rightSource = RegisterOperand::getRegisterOperand(R10);
+            move(right, RegisterOperand::getRegisterOperand(R10));
         }
+    }
+
+    if (intrinsic == code::INTEGER_DIVIDE) {
+        // idiv divides rdx:rax, neither of them is ever allocated
+        move(left, rax);
+        instructions.push_back(new Cqo());
+        instructions.push_back(new Idiv(rightSource));
+        move(rax, destination);
+        return;
+    }
 
-        Source* source = new MemoryOperand (
-            RSP, wordSize * (nPushedRegisters + loadInst->getFromTop())
-        );
-        Mov* m = new Mov(source,
-                         RegisterOperand::getRegisterOperand(currentReg)
-        );
-        instructions.push_back(m);
-        operationStackSize++;
+    // the result is computed in its own register if possible; rax is used
+    // if it is in memory or if writing it would overwrite the right operand
+    const RegisterOperand* target =
+            dynamic_cast<const RegisterOperand*>(destination);
+    if (target == 0 || target == rightSource)
+        target = rax;
+
+    move(left, target);
+    switch (intrinsic) {
+        case code::INTEGER_ADD:
+            instructions.push_back(new Add(rightSource, target));
+            break;
+        case code::INTEGER_SUBTRACT:
+            instructions.push_back(new Sub(rightSource, target));
+            break;
+        case code::INTEGER_MULTIPLY:
+            instructions.push_back(new Imul(rightSource, target));
+            break;
+        default:
+            throw "invalid intrinsic";
     }
+    move(target, destination);
 }
 
 
-void AssemblySubroutine::createStackFrame(void)
+void AssemblySubroutine::createStackFrame(size_t frameSize)
 {
     instructions.push_back(new Push(RegisterOperand::getRegisterOperand(RBP)));
     instructions.push_back(new Mov(
                                RegisterOperand::getRegisterOperand(RSP),
                                RegisterOperand::getRegisterOperand(RBP)));
+    if (frameSize > 0) {
+        instructions.push_back(new Sub(
+                                   getConstant(frameSize),
+                                   RegisterOperand::getRegisterOperand(RSP)));
+    }
 }
 
 
@@ -144,43 +460,249 @@ void AssemblySubroutine::destroyStackFrame(void)
 }
 
 
-void AssemblySubroutine::saveNeededRegisters(void)
+const MemoryOperand* AssemblySubroutine::getFrameSlot(size_t index)
+{
+    MemoryOperand* slot = new MemoryOperand(RBP, -(long long) (wordSize *
+                                                               (index + 1)));
+    operands.push_back(slot);
+    return slot;
+}
+
+
+const MemoryOperand* AssemblySubroutine::getVariable(code::Word fromTop)
+{
+    return getFrameSlot(variableCount - 1 - fromTop);
+}
+
+
+const Source* AssemblySubroutine::getValueSource(size_t value)
+{
+    const RegisterAllocator::Interval& interval = allocator.getInterval(value);
+    if (interval.spilled)
+        return getFrameSlot(variableCount +
+                            allocator.getUsedCalleeSavedRegisters().size() +
+                            interval.spillSlot);
+    else
+        return RegisterOperand::getRegisterOperand(interval.reg);
+}
+
+
+const Destination* AssemblySubroutine::getValueDestination(size_t value)
+{
+    const RegisterAllocator::Interval& interval = allocator.getInterval(value);
+    if (interval.spilled)
+        return getFrameSlot(variableCount +
+                            allocator.getUsedCalleeSavedRegisters().size() +
+                            interval.spillSlot);
+    else
+        return RegisterOperand::getRegisterOperand(interval.reg);
+}
+
+
+const Source* AssemblySubroutine::getOperandSource(
+        const ir::Instruction* value)
 {
-    size_t regs = nCallerSavedGPRegisters;
-    if (operationStackSize < regs)
-        regs = operationStackSize;
-    for (size_t i = 0; i < regs; i++) {
-        Register currentReg = callerSavedGPRegisters[i];
-        Push* push = new Push(RegisterOperand::getRegisterOperand(currentReg));
-        instructions.push_back(push);
+    const ir::ConstantInstruction* constant =
+            dynamic_cast<const ir::ConstantInstruction*>(value);
+    if (constant != 0)
+        return getConstant((long long) constant->getValue());
+    return getValueSource(allocator.getValueNumber(value));
+}
+
+
+const MemoryOperand* AssemblySubroutine::getPointee(size_t pointer,
+                                                   code::Word offset)
+{
+    const RegisterAllocator::Interval& interval =
+            allocator.getInterval(pointer);
+
+    Register base = interval.reg;
+    if (interval.spilled) {
+        base = R11;
+        move(getValueSource(pointer), RegisterOperand::getRegisterOperand(R11));
     }
-    registersSaved = true;
+
+    MemoryOperand* pointee = new MemoryOperand(base, (long long) offset);
+    operands.push_back(pointee);
+    return pointee;
+}
+
+
+const ConstantOperand* AssemblySubroutine::getConstant(long long value)
+{
+    ConstantOperand* constant = new ConstantOperand(value);
+    operands.push_back(constant);
+    return constant;
 }
 
 
-void AssemblySubroutine::restoreNeededRegisters(void)
+void AssemblySubroutine::move(const Source* source,
+                              const Destination* destination)
 {
-    size_t regs = nCallerSavedGPRegisters;
-    if (operationStackSize < regs)
-        regs = operationStackSize;
-    for (size_t i = regs; i > 0; i--) {
-        Register currentReg = callerSavedGPRegisters[i - 1];
-        Pop* pop = new Pop(RegisterOperand::getRegisterOperand(currentReg));
-        instructions.push_back(pop);
+    const RegisterOperand* sourceRegister =
+            dynamic_cast<const RegisterOperand*>(source);
+    const RegisterOperand* destinationRegister =
+            dynamic_cast<const RegisterOperand*>(destination);
+
+    const ConstantOperand* constant =
+            dynamic_cast<const ConstantOperand*>(source);
+
+    if (sourceRegister != 0 && sourceRegister == destinationRegister)
+        return;
+
+    // there is no move from memory to memory, and only constants fitting in
+    // 32 bits can be moved to memory directly
+    bool needsRegister = destinationRegister == 0 && sourceRegister == 0;
+    if (constant != 0) {
+        long long value = (long long) constant->getValue();
+        needsRegister = needsRegister &&
+                (value < -0x80000000LL || value > 0x7FFFFFFFLL);
+    }
+
+    if (needsRegister) {
+        const RegisterOperand* rax = RegisterOperand::getRegisterOperand(RAX);
+        instructions.push_back(new Mov(source, rax));
+        instructions.push_back(new Mov(rax, destination));
+    }
+    else {
+        instructions.push_back(new Mov(source, destination));
     }
-    registersSaved = false;
 }
 
 
-AssemblyGenerator::AssemblyGenerator(void)
+void AssemblySubroutine::callFunction(
+        const std::string& symbol,
+        const std::vector<const Source*>& arguments)
 {
+    if (arguments.size() > nArgumentRegisters) {
+        throw "too many arguments; not yet implemented";
+    }
+
+    moveArguments(arguments);
+    instructions.push_back(new Call(symbol));
+}
+
+
+void AssemblySubroutine::moveArguments(
+        const std::vector<const Source*>& arguments)
+{
+    std::vector<const Source*> sources(arguments);
+    std::vector<const RegisterOperand*> destinations;
+    for (size_t i = 0; i < arguments.size(); i++) {
+        destinations.push_back(
+                    RegisterOperand::getRegisterOperand(argumentRegisters[i]));
+    }
+
+    while (!sources.empty()) {
+        // find a move whose destination is not needed as a source anymore
+        bool moved = false;
+        for (size_t i = 0; i < sources.size() && !moved; i++) {
+            bool needed = false;
+            for (size_t j = 0; j < sources.size(); j++) {
+                if (j != i && sources[j] == destinations[i])
+                    needed = true;
+            }
+            if (!needed) {
+                move(sources[i], destinations[i]);
+                sources.erase(sources.begin() + i);
+                destinations.erase(destinations.begin() + i);
+                moved = true;
+            }
+        }
+
+        // the remaining moves form cycles, which are broken by saving one
+        // of the blocked registers in rax
+        if (!moved) {
+            const RegisterOperand* blocked = destinations[0];
+            const RegisterOperand* rax =
+                    RegisterOperand::getRegisterOperand(RAX);
+            move(blocked, rax);
+            for (size_t j = 0; j < sources.size(); j++) {
+                if (sources[j] == blocked)
+                    sources[j] = rax;
+            }
+        }
+    }
+}
+
+
+std::vector<const Source*> AssemblySubroutine::getValueSources(
+        const std::vector<size_t>& values)
+{
+    std::vector<const Source*> sources;
+    for (size_t i = 0; i < values.size(); i++) {
+        sources.push_back(getValueSource(values[i]));
+    }
+    return sources;
+}
+
+
+AssemblyGenerator::AssemblyGenerator(unsigned int optimizationLevel) :
+    optimizationLevel(optimizationLevel)
+{
+}
+
+
+AssemblyGenerator::~AssemblyGenerator(void)
+{
+    for (size_t i = 0; i < subroutines.size(); i++) {
+        delete subroutines[i];
+    }
 }
 
 
 void AssemblyGenerator::generateAssembly(
         const uetli::code::DirectSubroutine* subroutine)
 {
-    subroutines.push_back(new AssemblySubroutine(subroutine));
+    subroutines.push_back(generateSubroutine(subroutine, optimizationLevel));
+}
+
+
+void AssemblyGenerator::generateAssembly(
+        const std::vector<uetli::code::DirectSubroutine*>& subroutines,
+        size_t threadCount)
+{
+    generateAssembly(subroutines,
+                     std::vector<SubroutineCode*>(subroutines.size(), 0),
+                     threadCount);
+}
+
+
+void AssemblyGenerator::generateAssembly(
+        const std::vector<uetli::code::DirectSubroutine*>& subroutines,
+        const std::vector<SubroutineCode*>& precompiled,
+        size_t threadCount)
+{
+    util::TraceSpan span("assembly generation");
+
+    // every iteration writes its own element, so no locking is needed
+    std::vector<SubroutineCode*> generated(precompiled);
+    AssemblyLoop loop(subroutines, generated, optimizationLevel);
+
+    try {
+        util::ThreadPool::forEach(loop, subroutines.size(), threadCount);
+    }
+    catch (...) {
+        for (size_t i = 0; i < generated.size(); i++) {
+            delete generated[i];
+        }
+        throw;
+    }
+
+    this->subroutines.insert(this->subroutines.end(), generated.begin(),
+                             generated.end());
+}
+
+
+size_t AssemblyGenerator::getSubroutineCount(void) const
+{
+    return subroutines.size();
+}
+
+
+const SubroutineCode& AssemblyGenerator::getSubroutineCode(size_t index) const
+{
+    return *subroutines[index];
 }
 
 
@@ -189,10 +711,21 @@ void AssemblyGenerator::writeAssembly(FILE* file) const
     fprintf(file, ".intel_syntax noprefix\n");
 
     for (size_t i = 0; i < subroutines.size(); i++) {
+        fprintf(file, ".globl %s\n", subroutines[i]->getLabelName().c_str());
         fprintf(file, "%s:\n", subroutines[i]->getLabelName().c_str());
         fprintf(file, "%s\n", subroutines[i]->toString().c_str());
     }
 
+    // marks the stack as non-executable
+    fprintf(file, ".section .note.GNU-stack,\"\",@progbits\n");
     fprintf(file, "\n");
 }
 
+
+void AssemblyGenerator::encode(MachineCode& code) const
+{
+    for (size_t i = 0; i < subroutines.size(); i++) {
+        subroutines[i]->encode(code);
+    }
+}
+
@@ -28,8 +28,11 @@
 #include <cstdio>
 
 #include "Assemblyx86_64.h"
+#include "MachineCode.h"
+#include "RegisterAllocator.h"
 
 #include "../code/StackMachine.h"
+#include "../ir/Function.h"
 #include "../util/HashMap.h"
 #include "../parser/Identifier.h"
 
@@ -37,58 +40,256 @@ namespace uetli
 {
     namespace assembly
     {
+        class SubroutineCode;
         class AssemblySubroutine;
         class AssemblyGenerator;
     }
 }
 
 
-class uetli::assembly::AssemblySubroutine
+///
+/// \brief the machine code of one subroutine, which can be written as
+///        assembly text or encoded
+///
+class uetli::assembly::SubroutineCode
+{
+public:
+    virtual ~SubroutineCode(void);
+
+    virtual const std::string& getLabelName(void) const = 0;
+
+    ///
+    /// \return the assembly text of the instructions (without the label)
+    ///
+    virtual std::string toString(void) const = 0;
+
+    ///
+    /// \brief append the machine code of the subroutine
+    ///
+    /// The label of the subroutine is defined as a symbol at its start.
+    ///
+    virtual void encode(MachineCode& code) const = 0;
+};
+
+
+///
+/// \brief the x86-64 code of one subroutine
+///
+/// The values on the operation stack are kept in the locations assigned by
+/// the RegisterAllocator. The variables (arguments and local variables) live
+/// in the stack frame, addressed relative to rbp:
+///
+/// <pre>
+/// [rbp - 8 * (k + 1)]    variable k (counted from the bottom, the
+///                        arguments first)
+/// ...                    saved callee-saved registers
+/// ...                    spill slots
+/// </pre>
+///
+/// Arguments are passed in the argument registers of the System V ABI and
+/// the result is returned in rax, so the generated code can call and be
+/// called by C functions.
+///
+/// A subroutine can also be lowered from its SSA form (see ir::Function).
+/// Its values are kept in the locations assigned by the RegisterAllocator as
+/// well, but there are no variables anymore: only the arguments are stored
+/// in the frame, and constants are used as immediate operands.
+///
+class uetli::assembly::AssemblySubroutine : public SubroutineCode
 {
 private:
     std::vector<x86_64::AssemblyInstruction*> instructions;
 
-    static const size_t nCallerSavedGPRegisters;
-    static const x86_64::Register callerSavedGPRegisters[];
+    /// operands created for the instructions (register operands are shared
+    /// and not contained)
+    std::vector<x86_64::Operand*> operands;
 
     static const size_t nArgumentRegisters;
     static const x86_64::Register argumentRegisters[];
 
-    /// current size of the operation stack (number of elements there)
-    size_t operationStackSize;
-    size_t nPushedRegisters;
+    RegisterAllocator allocator;
 
-    /// determines weather the operation stack in the registers has been
-    /// saved on the stack (e.g to call a function)
-    bool registersSaved;
+    /// numbers of the values currently on the operation stack
+    std::vector<size_t> stack;
+
+    /// number of the value pushed next
+    size_t nextValue;
+
+    /// number of arguments and local variables
+    size_t variableCount;
 
     parser::Identifier name;
     std::string labelName;
 public:
 
     AssemblySubroutine(const uetli::code::DirectSubroutine* subroutine);
-    std::string toString(void) const;
-    const std::string& getLabelName(void);
+    AssemblySubroutine(const ir::Function* function);
+    ~AssemblySubroutine(void);
+
+    virtual std::string toString(void) const;
+    virtual const std::string& getLabelName(void) const;
+
+    virtual void encode(MachineCode& code) const;
 private:
     void generate(const uetli::code::DirectSubroutine* subroutine);
     void generateInstruction(const uetli::code::StackInstruction* inst);
 
-    void createStackFrame(void);
+    void generate(const ir::Function* function);
+    void generateInstruction(const ir::Instruction* instruction);
+
+    ///
+    /// \brief set up the stack frame and store the arguments in it
+    ///
+    /// The variables following the arguments are set to 0.
+    ///
+    void generatePrologue(size_t argumentCount);
+
+    ///
+    /// \brief return the result, restoring the registers of the caller
+    ///
+    void generateEpilogue(const x86_64::Source* result);
+
+    ///
+    /// \brief emit the machine instructions computing an intrinsic
+    ///
+    /// \param left the left operand
+    /// \param right the right operand, which may be a constant
+    /// \param result the location receiving the result
+    ///
+    void generateIntrinsic(code::Intrinsic intrinsic,
+                           const x86_64::Source* left,
+                           const x86_64::Source* right,
+                           const x86_64::Destination* result);
+
+    void createStackFrame(size_t frameSize);
     void destroyStackFrame(void);
 
-    void saveNeededRegisters(void);
-    void restoreNeededRegisters(void);
+    ///
+    /// \return the memory operand of a slot in the stack frame
+    ///
+    const x86_64::MemoryOperand* getFrameSlot(size_t index);
+
+    ///
+    /// \param fromTop the index of the variable (where 0 is the topmost
+    ///                variable)
+    ///
+    const x86_64::MemoryOperand* getVariable(code::Word fromTop);
+
+    const x86_64::Source* getValueSource(size_t value);
+    const x86_64::Destination* getValueDestination(size_t value);
+
+    ///
+    /// \return the location of the value defined by an instruction of the
+    ///         SSA form or the constant it defines
+    ///
+    const x86_64::Source* getOperandSource(const ir::Instruction* value);
+
+    ///
+    /// \brief get the memory a pointer value points to
+    ///
+    /// If the pointer is spilled, it is loaded into r11 first.
+    ///
+    /// \param pointer the number of the value holding the pointer
+    /// \param offset offset in bytes added to the pointer
+    ///
+    const x86_64::MemoryOperand* getPointee(size_t pointer, code::Word offset);
+
+    const x86_64::ConstantOperand* getConstant(long long value);
+
+    ///
+    /// \brief emit a move between two locations, using rax if both of them
+    ///        are in memory
+    ///
+    void move(const x86_64::Source* source,
+              const x86_64::Destination* destination);
+
+    ///
+    /// \brief call a function, the result is left in rax
+    ///
+    /// \param arguments the locations of the values passed as arguments
+    ///
+    void callFunction(const std::string& symbol,
+                      const std::vector<const x86_64::Source*>& arguments);
+
+    ///
+    /// \brief move the values into the argument registers
+    ///
+    /// The values may already be in argument registers, so the moves are
+    /// ordered such that no value is overwritten before it has been moved.
+    ///
+    void moveArguments(const std::vector<const x86_64::Source*>& arguments);
+
+    ///
+    /// \return the locations of the given values
+    ///
+    std::vector<const x86_64::Source*> getValueSources(
+            const std::vector<size_t>& values);
 };
 
 
+///
+/// \brief generates the code of subroutines
+///
+/// If the code is optimized, every subroutine is translated into SSA form,
+/// optimized and lowered from it. Subroutines which can not be translated
+/// (because they access memory) are lowered from their stack code.
+///
 class uetli::assembly::AssemblyGenerator
 {
-    std::vector<AssemblySubroutine*> subroutines;
+    std::vector<SubroutineCode*> subroutines;
+    unsigned int optimizationLevel;
 public:
-    AssemblyGenerator(void);
+    ///
+    /// \param optimizationLevel the subroutines are lowered from their
+    ///                          stack code at level 0
+    ///
+    AssemblyGenerator(unsigned int optimizationLevel = 0);
+    ~AssemblyGenerator(void);
 
     void generateAssembly(const uetli::code::DirectSubroutine* subroutine);
+
+    ///
+    /// \brief generate the assembly of several subroutines concurrently
+    ///
+    /// Every subroutine is generated into its own instruction list. They are
+    /// appended in the given order, so the output does not depend on the
+    /// number of threads.
+    ///
+    /// \param threadCount the maximum number of threads used
+    ///
+    void generateAssembly(
+            const std::vector<uetli::code::DirectSubroutine*>& subroutines,
+            size_t threadCount);
+
+    ///
+    /// \brief generate the assembly of several subroutines concurrently,
+    ///        reusing code which is already known
+    ///
+    /// \param precompiled for every subroutine either its code from an
+    ///                    earlier compilation, which is appended instead of
+    ///                    generating it, or 0. The generator takes the
+    ///                    ownership of the given code.
+    /// \param threadCount the maximum number of threads used
+    ///
+    void generateAssembly(
+            const std::vector<uetli::code::DirectSubroutine*>& subroutines,
+            const std::vector<SubroutineCode*>& precompiled,
+            size_t threadCount);
+
+    size_t getSubroutineCount(void) const;
+
+    ///
+    /// \return the code of the subroutine with the given index, in the
+    ///         order they were added
+    ///
+    const SubroutineCode& getSubroutineCode(size_t index) const;
+
     void writeAssembly(FILE* file) const;
+
+    ///
+    /// \brief append the machine code of all generated subroutines
+    ///
+    void encode(MachineCode& code) const;
 };
 
 
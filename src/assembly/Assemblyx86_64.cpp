@@ -20,15 +20,18 @@
 // =============================================================================
 
 #include "Assemblyx86_64.h"
+#include "MachineCode.h"
 #include <sstream>
 
+using uetli::assembly::MachineCode;
+using uetli::assembly::AssemblyException;
 using namespace uetli::assembly::x86_64;
 
 std::string registerNames[] = {
     "rax",
-    "rbx",
     "rcx",
     "rdx",
+    "rbx",
     "rbp",
     "rsi",
     "rdi",
@@ -89,11 +92,41 @@ const std::string& getRegisterName(Register reg)
     return registerNames[reg];
 }
 
+
+unsigned char getRegisterNumber(Register reg)
+{
+    // the enumeration does not follow the hardware order in the first eight
+    // registers
+    static const unsigned char numbers[] = {
+        0, // RAX
+        1, // RCX
+        2, // RDX
+        3, // RBX
+        5, // RBP
+        6, // RSI
+        7, // RDI
+        4, // RSP
+    };
+
+    if (reg >= RAX && reg <= RSP)
+        return numbers[reg];
+    else if (reg >= R8 && reg <= R15)
+        return (unsigned char) (reg - R8 + 8);
+    else
+        throw AssemblyException("not a general purpose register: " +
+                                getRegisterName(reg));
+}
+
 }
 }
 }
 
 
+Operand::~Operand(void)
+{
+}
+
+
 RegisterOperand::RegisterOperand(Register reg) :
     reg(reg)
 {
@@ -105,25 +138,36 @@ RegisterOperand* RegisterOperand::registers[registers_count] =
 };
 
 
-const RegisterOperand* RegisterOperand::getRegisterOperand(Register reg)
+bool RegisterOperand::createRegisters(void)
 {
-    static bool initialized = false;
-
-    if (!initialized) {
-        for (size_t i = 0; i < sizeof(registers) / sizeof(RegisterOperand*);
-             i++) {
-            registers[i] = new RegisterOperand((Register) i);
-        }
-        initialized = true;
+    for (size_t i = 0; i < sizeof(registers) / sizeof(RegisterOperand*); i++) {
+        registers[i] = new RegisterOperand((Register) i);
     }
+    return true;
+}
+
+
+const RegisterOperand* RegisterOperand::getRegisterOperand(Register reg)
+{
+    // the initialization of a local static variable is thread-safe, so the
+    // operands are created exactly once even if several threads generate
+    // code at the same time
+    static const bool initialized = createRegisters();
+    (void) initialized;
 
-    if (reg >= 0 || reg < registers_count)
+    if (reg >= 0 && reg < registers_count)
         return registers[reg];
     else
         throw "fatal internal error";
 }
 
 
+Register RegisterOperand::getRegister(void) const
+{
+    return reg;
+}
+
+
 std::string RegisterOperand::toString(void) const
 {
     return getRegisterName(reg);
@@ -158,26 +202,65 @@ MemoryOperand::MemoryOperand(Register address, Register offset,
 }
 
 
+Register MemoryOperand::getAddress(void) const
+{
+    return address;
+}
+
+
+Register MemoryOperand::getOffset(void) const
+{
+    return offset;
+}
+
+
+char MemoryOperand::getOffsetMultiplier(void) const
+{
+    return offsetMultiplier;
+}
+
+
+long long MemoryOperand::getImmediateOffset(void) const
+{
+    return immediateOffset;
+}
+
+
 std::string MemoryOperand::toString(void) const
 {
-    if (immediateOffset != 0 && offsetMultiplier == 0) {
-        std::stringstream str;
-        str << "[" << getRegisterName(address) << "+" << immediateOffset << "]";
-        return str.str();
+    // all operands are 64 bits wide
+    std::stringstream str;
+    str << "qword ptr [" << getRegisterName(address);
+    if (offsetMultiplier != 0) {
+        str << "+" << getRegisterName(offset) << "*" << int(offsetMultiplier);
     }
-    else if (offsetMultiplier != 0) {
-        std::stringstream str;
-        str << "[" + getRegisterName(address) << "+" << getRegisterName(offset)
-            << "*" << offsetMultiplier << "+" << immediateOffset << "]";
-        return str.str();
+    if (immediateOffset > 0) {
+        str << "+" << immediateOffset;
     }
+    else if (immediateOffset < 0) {
+        str << "-" << -immediateOffset;
+    }
+    str << "]";
+    return str.str();
+}
+
+
+ConstantOperand::ConstantOperand(unsigned long long value) :
+    value(value)
+{
+}
+
+
+unsigned long long ConstantOperand::getValue(void) const
+{
+    return value;
 }
 
 
 std::string ConstantOperand::toString(void) const
 {
     std::stringstream stream;
-    stream << value;
+    stream << (long long) value;
     return stream.str();
 }
 
@@ -199,6 +282,12 @@ std::string AssemblyInstruction::toString(void) const
 }
 
 
+void AssemblyInstruction::encode(MachineCode& code) const
+{
+    throw AssemblyException("cannot encode instruction: " + toString());
+}
+
+
 NoArgumentInstruction::NoArgumentInstruction(const std::string& instruction) :
     AssemblyInstruction(instruction)
 {
@@ -211,6 +300,12 @@ Ret::Ret(void) :
 }
 
 
+void Ret::encode(MachineCode& code) const
+{
+    code.emitByte(0xC3);
+}
+
+
 SingleRegisterInstruction::SingleRegisterInstruction(
         const std::string& instruction, const RegisterOperand* reg) :
     AssemblyInstruction(instruction), reg(reg)
@@ -230,12 +325,30 @@ Push::Push(const RegisterOperand* reg) :
 }
 
 
+void Push::encode(MachineCode& code) const
+{
+    unsigned char number = getRegisterNumber(reg->getRegister());
+    if (number >= 8)
+        code.emitByte(0x41); // REX.B
+    code.emitByte(0x50 + (number & 7));
+}
+
+
 Pop::Pop(const RegisterOperand* reg) :
     SingleRegisterInstruction("pop", reg)
 {
 }
 
 
+void Pop::encode(MachineCode& code) const
+{
+    unsigned char number = getRegisterNumber(reg->getRegister());
+    if (number >= 8)
+        code.emitByte(0x41); // REX.B
+    code.emitByte(0x58 + (number & 7));
+}
+
+
 Call::Call(const std::string& labelName) :
     AssemblyInstruction("call"),
     labelName(labelName)
@@ -251,7 +364,14 @@ const std::string& Call::getLabelName(void) const
 
 std::string Call::toString(void) const
 {
-    return instruction + " " + ".text:" + labelName;
+    return instruction + " " + labelName;
+}
+
+
+void Call::encode(MachineCode& code) const
+{
+    code.emitByte(0xE8);
+    code.emitRelocation(labelName);
 }
 
 
@@ -273,6 +393,136 @@ std::string SourceDestinationInstruction::toString(void) const
 }
 
 
+static bool fitsInt32(long long value)
+{
+    return value >= -0x80000000LL && value <= 0x7FFFFFFFLL;
+}
+
+
+///
+/// \brief emit REX prefix, opcode, ModRM byte and (if needed) SIB byte and
+///        displacement of an instruction operating on 64 bit
+///
+/// \param reg the value of the reg field (a register number or an opcode
+///            extension)
+/// \param rm the register or memory operand encoded in the r/m field
+/// \param escaped true for two-byte opcodes, which are preceded by 0x0F
+///
+static void encodeModRM(MachineCode& code, unsigned char opcode,
+                        unsigned char reg, const Operand* rm,
+                        bool escaped = false)
+{
+    const RegisterOperand* rmRegister =
+            dynamic_cast<const RegisterOperand*>(rm);
+    const MemoryOperand* memory = dynamic_cast<const MemoryOperand*>(rm);
+
+    if (rmRegister != 0) {
+        unsigned char number = getRegisterNumber(rmRegister->getRegister());
+        code.emitByte(0x48 | ((reg >> 3) << 2) | (number >> 3));
+        if (escaped)
+            code.emitByte(0x0F);
+        code.emitByte(opcode);
+        code.emitByte(0xC0 | ((reg & 7) << 3) | (number & 7));
+        return;
+    }
+
+    if (memory == 0)
+        throw AssemblyException("invalid operand: " + rm->toString());
+
+    unsigned char base = getRegisterNumber(memory->getAddress());
+    bool hasIndex = memory->getOffsetMultiplier() != 0;
+    unsigned char index = hasIndex ?
+            getRegisterNumber(memory->getOffset()) : 4; // 4 means no index
+    long long displacement = memory->getImmediateOffset();
+
+    unsigned char scale = 0;
+    switch (memory->getOffsetMultiplier()) {
+        case 0:
+        case 1: scale = 0; break;
+        case 2: scale = 1; break;
+        case 4: scale = 2; break;
+        case 8: scale = 3; break;
+        default:
+            throw AssemblyException("invalid operand: " + rm->toString());
+    }
+
+    if ((hasIndex && index == 4) || !fitsInt32(displacement))
+        throw AssemblyException("invalid operand: " + rm->toString());
+
+    // rbp and r13 cannot be encoded without displacement
+    unsigned char mod;
+    if (displacement == 0 && (base & 7) != 5)
+        mod = 0;
+    else if (displacement >= -128 && displacement <= 127)
+        mod = 1;
+    else
+        mod = 2;
+
+    // rsp and r12 can only be used as base in a SIB byte
+    bool needsSib = hasIndex || (base & 7) == 4;
+
+    code.emitByte(0x48 | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3));
+    if (escaped)
+        code.emitByte(0x0F);
+    code.emitByte(opcode);
+    code.emitByte((mod << 6) | ((reg & 7) << 3) | (needsSib ? 4 : base & 7));
+    if (needsSib)
+        code.emitByte((scale << 6) | ((index & 7) << 3) | (base & 7));
+
+    if (mod == 1)
+        code.emitByte((unsigned char) displacement);
+    else if (mod == 2)
+        code.emitInt32((int) displacement);
+}
+
+
+void SourceDestinationInstruction::encodeOperands(MachineCode& code,
+        unsigned char storeOpcode, unsigned char loadOpcode,
+        unsigned char immediateOpcode, unsigned char immediateExtension) const
+{
+    if (dynamic_cast<const ConstantOperand*>(destionation) != 0)
+        throw AssemblyException("invalid destination: " + toString());
+
+    const ConstantOperand* constant =
+            dynamic_cast<const ConstantOperand*>(source);
+    const RegisterOperand* sourceRegister =
+            dynamic_cast<const RegisterOperand*>(source);
+    const RegisterOperand* destinationRegister =
+            dynamic_cast<const RegisterOperand*>(destionation);
+
+    if (constant != 0) {
+        long long value = (long long) constant->getValue();
+        if (!fitsInt32(value))
+            throw AssemblyException("immediate too large: " + toString());
+
+        // the arithmetic instructions have a shorter form for constants
+        // fitting in one byte
+        if (immediateOpcode == 0x81 && value >= -128 && value <= 127) {
+            encodeModRM(code, 0x83, immediateExtension, destionation);
+            code.emitByte((unsigned char) value);
+        }
+        else {
+            encodeModRM(code, immediateOpcode, immediateExtension,
+                        destionation);
+            code.emitInt32((int) value);
+        }
+    }
+    else if (sourceRegister != 0) {
+        encodeModRM(code, storeOpcode,
+                    getRegisterNumber(sourceRegister->getRegister()),
+                    destionation);
+    }
+    else if (destinationRegister != 0) {
+        encodeModRM(code, loadOpcode,
+                    getRegisterNumber(destinationRegister->getRegister()),
+                    source);
+    }
+    else {
+        throw AssemblyException("two memory operands: " + toString());
+    }
+}
+
+
 Mov::Mov(const Source* source,
          const Destination* destionation) :
     SourceDestinationInstruction("mov", source, destionation)
@@ -280,6 +530,28 @@ Mov::Mov(const Source* source,
 }
 
 
+void Mov::encode(MachineCode& code) const
+{
+    const ConstantOperand* constant =
+            dynamic_cast<const ConstantOperand*>(source);
+    const RegisterOperand* destinationRegister =
+            dynamic_cast<const RegisterOperand*>(destionation);
+
+    // constants which do not fit in 32 bits can only be moved to registers
+    if (constant != 0 && destinationRegister != 0 &&
+        !fitsInt32((long long) constant->getValue())) {
+        unsigned char number =
+                getRegisterNumber(destinationRegister->getRegister());
+        code.emitByte(0x48 | (number >> 3));
+        code.emitByte(0xB8 + (number & 7));
+        code.emitInt64((long long) constant->getValue());
+        return;
+    }
+
+    encodeOperands(code, 0x89, 0x8B, 0xC7, 0);
+}
+
+
 Add::Add(const Source* source,
          const Destination* destionation) :
     SourceDestinationInstruction("add", source, destionation)
@@ -287,3 +559,93 @@ Add::Add(const Source* source,
 }
 
 
+void Add::encode(MachineCode& code) const
+{
+    encodeOperands(code, 0x01, 0x03, 0x81, 0);
+}
+
+
+Sub::Sub(const Source* source,
+         const Destination* destionation) :
+    SourceDestinationInstruction("sub", source, destionation)
+{
+}
+
+
+void Sub::encode(MachineCode& code) const
+{
+    encodeOperands(code, 0x29, 0x2B, 0x81, 5);
+}
+
+
+Imul::Imul(const Source* source,
+           const Destination* destionation) :
+    SourceDestinationInstruction("imul", source, destionation)
+{
+}
+
+
+void Imul::encode(MachineCode& code) const
+{
+    const RegisterOperand* destinationRegister =
+            dynamic_cast<const RegisterOperand*>(destionation);
+    if (destinationRegister == 0)
+        throw AssemblyException("invalid destination: " + toString());
+
+    unsigned char reg = getRegisterNumber(destinationRegister->getRegister());
+    const ConstantOperand* constant =
+            dynamic_cast<const ConstantOperand*>(source);
+
+    if (constant != 0) {
+        // three operand form, multiplying the destination by the constant
+        long long value = (long long) constant->getValue();
+        if (!fitsInt32(value))
+            throw AssemblyException("immediate too large: " + toString());
+        if (value >= -128 && value <= 127) {
+            encodeModRM(code, 0x6B, reg, destionation);
+            code.emitByte((unsigned char) value);
+        }
+        else {
+            encodeModRM(code, 0x69, reg, destionation);
+            code.emitInt32((int) value);
+        }
+    }
+    else {
+        encodeModRM(code, 0xAF, reg, source, true);
+    }
+}
+
+
+Idiv::Idiv(const Source* divisor) :
+    AssemblyInstruction("idiv"),
+    divisor(divisor)
+{
+}
+
+
+std::string Idiv::toString(void) const
+{
+    return instruction + " " + divisor->toString();
+}
+
+
+void Idiv::encode(MachineCode& code) const
+{
+    if (dynamic_cast<const ConstantOperand*>(divisor) != 0)
+        throw AssemblyException("invalid operand: " + toString());
+    encodeModRM(code, 0xF7, 7, divisor);
+}
+
+
+Cqo::Cqo(void) :
+    NoArgumentInstruction("cqo")
+{
+}
+
+
+void Cqo::encode(MachineCode& code) const
+{
+    code.emitByte(0x48); // REX.W
+    code.emitByte(0x99);
+}
+
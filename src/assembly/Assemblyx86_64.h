@@ -29,6 +29,8 @@ namespace uetli
 {
     namespace assembly
     {
+        class MachineCode;
+
         namespace x86_64
         {
             ///
@@ -104,6 +106,14 @@ namespace uetli
 
             const std::string& getRegisterName(Register reg);
 
+            ///
+            /// \return the number of a general purpose register as used in
+            ///         the encoding of an instruction
+            ///
+            /// \throws AssemblyException if reg is no general purpose register
+            ///
+            unsigned char getRegisterNumber(Register reg);
+
             class Operand;
 
             class Source;
@@ -116,13 +126,17 @@ namespace uetli
             class AssemblyInstruction;
                 class NoArgumentInstruction;
                     class Ret;
+                    class Cqo;
                 class SingleRegisterInstruction;
                     class Push;
                     class Pop;
                 class Call;
+                class Idiv;
                 class SourceDestinationInstruction;
                     class Mov;
                     class Add;
+                    class Sub;
+                    class Imul;
         }
     }
 }
@@ -132,6 +146,7 @@ namespace uetli
 class uetli::assembly::x86_64::Operand
 {
 public:
+    virtual ~Operand(void);
     virtual std::string toString(void) const = 0;
 };
 
@@ -157,9 +172,13 @@ class uetli::assembly::x86_64::RegisterOperand :
     Register reg;
     RegisterOperand(Register reg);
     static RegisterOperand* registers[registers_count];
+
+    static bool createRegisters(void);
 public:
     static const RegisterOperand* getRegisterOperand(Register reg);
 
+    Register getRegister(void) const;
+
     virtual std::string toString(void) const;
 };
 
@@ -178,6 +197,12 @@ public:
     MemoryOperand(Register address, long long immediateOffset);
     MemoryOperand(Register address, Register offset, char offsetMultiplier,
                   long long immediateOffset);
+
+    Register getAddress(void) const;
+    Register getOffset(void) const;
+    char getOffsetMultiplier(void) const;
+    long long getImmediateOffset(void) const;
+
     virtual std::string toString(void) const;
 };
 
@@ -189,6 +214,10 @@ class uetli::assembly::x86_64::ConstantOperand :
     unsigned long long value;
 
 public:
+    ConstantOperand(unsigned long long value);
+
+    unsigned long long getValue(void) const;
+
     virtual std::string toString(void) const;
 };
 
@@ -202,6 +231,13 @@ public:
     virtual ~AssemblyInstruction(void);
 
     virtual std::string toString(void) const;
+
+    ///
+    /// \brief append the machine code of the instruction
+    ///
+    /// \throws AssemblyException if the instruction cannot be encoded
+    ///
+    virtual void encode(MachineCode& code) const;
 };
 
 
@@ -218,6 +254,21 @@ class uetli::assembly::x86_64::Ret :
 {
 public:
     Ret(void);
+
+    virtual void encode(MachineCode& code) const;
+};
+
+
+///
+/// \brief sign-extends rax into rdx:rax
+///
+class uetli::assembly::x86_64::Cqo :
+        public NoArgumentInstruction
+{
+public:
+    Cqo(void);
+
+    virtual void encode(MachineCode& code) const;
 };
 
 
@@ -239,6 +290,8 @@ class uetli::assembly::x86_64::Push :
 {
 public:
     Push(const RegisterOperand* reg);
+
+    virtual void encode(MachineCode& code) const;
 };
 
 
@@ -247,6 +300,8 @@ class uetli::assembly::x86_64::Pop :
 {
 public:
     Pop(const RegisterOperand* reg);
+
+    virtual void encode(MachineCode& code) const;
 };
 
 
@@ -258,12 +313,30 @@ public:
     const std::string& getLabelName(void) const;
 
     virtual std::string toString(void) const;
+    virtual void encode(MachineCode& code) const;
+};
+
+
+///
+/// \brief signed division of rdx:rax
+///
+/// The quotient is stored in rax, the remainder in rdx.
+///
+class uetli::assembly::x86_64::Idiv : public AssemblyInstruction
+{
+    const Source* divisor;
+public:
+    Idiv(const Source* divisor);
+
+    virtual std::string toString(void) const;
+    virtual void encode(MachineCode& code) const;
 };
 
 
 class uetli::assembly::x86_64::SourceDestinationInstruction :
         public AssemblyInstruction
 {
+protected:
     const Source* source;
     const Destination* destionation;
 
@@ -274,6 +347,20 @@ public:
 
     virtual std::string toString(void) const;
 
+protected:
+    ///
+    /// \brief encode an instruction with the usual operand forms
+    ///
+    /// \param storeOpcode opcode of the form <code>r/m64, r64</code>
+    /// \param loadOpcode opcode of the form <code>r64, r/m64</code>
+    /// \param immediateOpcode opcode of the form <code>r/m64, imm32</code>
+    /// \param immediateExtension the opcode extension stored in the ModRM
+    ///                           byte of the immediate form
+    ///
+    void encodeOperands(MachineCode& code, unsigned char storeOpcode,
+                        unsigned char loadOpcode,
+                        unsigned char immediateOpcode,
+                        unsigned char immediateExtension) const;
 };
 
 
@@ -282,6 +369,8 @@ class uetli::assembly::x86_64::Mov : public SourceDestinationInstruction
 public:
     Mov(const Source* source,
         const Destination* destionation);
+
+    virtual void encode(MachineCode& code) const;
 };
 
 
@@ -290,6 +379,31 @@ class uetli::assembly::x86_64::Add : public SourceDestinationInstruction
 public:
     Add(const Source* source,
         const Destination* destionation);
+
+    virtual void encode(MachineCode& code) const;
+};
+
+
+class uetli::assembly::x86_64::Sub : public SourceDestinationInstruction
+{
+public:
+    Sub(const Source* source,
+        const Destination* destionation);
+
+    virtual void encode(MachineCode& code) const;
+};
+
+
+///
+/// \brief signed multiplication, the destination has to be a register
+///
+class uetli::assembly::x86_64::Imul : public SourceDestinationInstruction
+{
+public:
+    Imul(const Source* source,
+         const Destination* destionation);
+
+    virtual void encode(MachineCode& code) const;
 };
 
 
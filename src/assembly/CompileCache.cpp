@@ -0,0 +1,898 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "CompileCache.h"
+#include "../code/Optimizer.h"
+#include "../util/ThreadPool.h"
+
+#include <atomic>
+#include <cstdio>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+using namespace uetli::assembly;
+using uetli::code::DirectSubroutine;
+using uetli::code::StackInstruction;
+using uetli::parser::ClassDeclaration;
+using uetli::parser::MethodDeclaration;
+using uetli::parser::Identifier;
+using uetli::util::Fingerprint;
+using uetli::util::Symbol;
+using uetli::util::SymbolTable;
+
+
+namespace
+{
+    ///
+    /// \brief version of the keys and the entries
+    ///
+    /// It has to be incremented whenever the generated code changes, so
+    /// that entries written by older versions are not used anymore.
+    ///
+    const unsigned long long formatVersion = 2;
+
+    const char* const entryMagic = "uetli compile cache";
+
+    enum NodeTag
+    {
+        NO_NODE,
+        NEW_VARIABLE,
+        ASSIGNMENT,
+        BLOCK,
+        CALL_OR_VARIABLE,
+        BINARY_OPERATION,
+        UNARY_OPERATION,
+    };
+
+    enum InstructionTag
+    {
+        LOAD,
+        STORE,
+        DEREFERENCE,
+        DEREFERENCE_STORE,
+        POP,
+        CALL,
+        LOAD_CONSTANT,
+        ALLOCATE,
+        DUPLICATE,
+        PRINT,
+        INTRINSIC,
+    };
+
+    ///
+    /// \brief computes the keys of the methods of a set of classes
+    ///
+    class KeyBuilder
+    {
+        typedef std::vector<const ClassDeclaration*> DeclarationList;
+
+        /// all declarations of every class name
+        uetli::util::HashMap<Symbol, DeclarationList> declarations;
+
+        /// fingerprints of the signatures each type depends on
+        uetli::util::HashMap<Symbol, CompileCache::Key> dependencies;
+
+        unsigned int optimizationLevel;
+        size_t inlineLimit;
+
+        /// true, if the code of called methods may be inlined
+        bool inlining;
+
+    public:
+        KeyBuilder(const std::vector<ClassDeclaration*>& classes,
+                   unsigned int optimizationLevel, size_t inlineLimit);
+
+        CompileCache::Key getKey(const ClassDeclaration* owner,
+                                 const MethodDeclaration* method);
+
+    private:
+        ///
+        /// \return the fingerprint of the signatures of the type and of all
+        ///         types named in them, transitively
+        ///
+        /// If calls are inlined, the bodies of the methods are part of the
+        /// fingerprint, and the types of their local variables are named by
+        /// them as well.
+        ///
+        CompileCache::Key getDependencies(Symbol type);
+
+        ///
+        /// \param variableTypes if not 0, the types of new variables are
+        ///                      appended instead of adding the fingerprints
+        ///                      of their dependencies
+        ///
+        void addStatement(Fingerprint& fingerprint,
+                          const uetli::parser::Statement* statement,
+                          std::vector<Symbol>* variableTypes);
+        void addExpression(Fingerprint& fingerprint,
+                           const uetli::parser::Expression* expression);
+    };
+
+    ///
+    /// \brief stores the entry of one method per iteration
+    ///
+    class StoreLoop : public uetli::util::ThreadPool::Loop
+    {
+        const CompileCache& cache;
+        const std::vector<CompileCache::Key>& keys;
+        const std::vector<const DirectSubroutine*>& subroutines;
+        const std::vector<const SubroutineCode*>& code;
+    public:
+        StoreLoop(const CompileCache& cache,
+                  const std::vector<CompileCache::Key>& keys,
+                  const std::vector<const DirectSubroutine*>& subroutines,
+                  const std::vector<const SubroutineCode*>& code);
+
+        virtual void run(size_t index);
+    };
+
+    ///
+    /// \brief serializes the parts of a cache entry
+    ///
+    class EntryWriter
+    {
+        std::string data;
+    public:
+        void writeWord(unsigned long long value);
+        void writeString(const std::string& string);
+        void writeIdentifier(const Identifier& identifier);
+        void writeInstruction(const StackInstruction* instruction);
+        void writeSubroutine(const DirectSubroutine* subroutine);
+
+        const std::string& getData(void) const;
+    };
+
+    ///
+    /// \brief reads the parts of a cache entry
+    ///
+    /// All methods throw if the data is not well-formed.
+    ///
+    class EntryReader
+    {
+        const std::string& data;
+        size_t position;
+    public:
+        EntryReader(const std::string& data);
+
+        unsigned long long readWord(void);
+        std::string readString(void);
+        Identifier readIdentifier(void);
+        StackInstruction* readInstruction(void);
+        DirectSubroutine* readSubroutine(void);
+
+        bool isAtEnd(void) const;
+    };
+}
+
+
+static void addKey(Fingerprint& fingerprint, const CompileCache::Key& key)
+{
+    fingerprint.add(key.low);
+    fingerprint.add(key.high);
+}
+
+
+static void addSymbol(Fingerprint& fingerprint, Symbol symbol)
+{
+    // the numbers of the symbols differ between runs, their strings do not
+    fingerprint.add(SymbolTable::getString(symbol));
+}
+
+
+KeyBuilder::KeyBuilder(const std::vector<ClassDeclaration*>& classes,
+                       unsigned int optimizationLevel, size_t inlineLimit) :
+    optimizationLevel(optimizationLevel),
+    inlineLimit(inlineLimit),
+    inlining(optimizationLevel >= uetli::code::inliningLevel)
+{
+    for (size_t i = 0; i < classes.size(); i++) {
+        DeclarationList* list = declarations.getReference(classes[i]->name);
+        if (list != 0)
+            list->push_back(classes[i]);
+        else
+            declarations.put(classes[i]->name, DeclarationList(1, classes[i]));
+    }
+}
+
+
+CompileCache::Key KeyBuilder::getKey(const ClassDeclaration* owner,
+                                     const MethodDeclaration* method)
+{
+    Fingerprint fingerprint;
+    fingerprint.add(formatVersion);
+    fingerprint.add((unsigned long long) optimizationLevel);
+    if (inlining)
+        fingerprint.add((unsigned long long) inlineLimit);
+
+    // callees and unary operators are looked up in the own class
+    addKey(fingerprint, getDependencies(owner->name));
+
+    addSymbol(fingerprint, method->type);
+    addSymbol(fingerprint, method->name);
+    fingerprint.add((unsigned long long) method->arguments.size());
+    for (size_t i = 0; i < method->arguments.size(); i++) {
+        addSymbol(fingerprint, method->arguments[i]->type);
+        addSymbol(fingerprint, method->arguments[i]->name);
+    }
+
+    addStatement(fingerprint, method->body, 0);
+    return fingerprint.getValue();
+}
+
+
+CompileCache::Key KeyBuilder::getDependencies(Symbol type)
+{
+    const CompileCache::Key* known = dependencies.getReference(type);
+    if (known != 0)
+        return *known;
+
+    Fingerprint fingerprint;
+    std::vector<Symbol> types(1, type);
+    uetli::util::HashMap<Symbol, bool> visited;
+    visited.put(type, true);
+
+    for (size_t i = 0; i < types.size(); i++) {
+        addSymbol(fingerprint, types[i]);
+
+        // undefined and native classes have no declaration
+        const DeclarationList* list = declarations.getReference(types[i]);
+        if (list == 0) {
+            fingerprint.add(0ULL);
+            continue;
+        }
+
+        fingerprint.add((unsigned long long) list->size());
+        for (size_t j = 0; j < list->size(); j++) {
+            const uetli::parser::FeatureList& features = (*list)[j]->features;
+            fingerprint.add((unsigned long long) features.size());
+
+            for (size_t k = 0; k < features.size(); k++) {
+                const MethodDeclaration* method =
+                        dynamic_cast<const MethodDeclaration*>(features[k]);
+                std::vector<Symbol> named(1, features[k]->type);
+
+                fingerprint.add(method != 0 ? 1ULL : 0ULL);
+                addSymbol(fingerprint, features[k]->type);
+                addSymbol(fingerprint, features[k]->name);
+                if (method != 0) {
+                    fingerprint.add(
+                            (unsigned long long) method->arguments.size());
+                    for (size_t a = 0; a < method->arguments.size(); a++) {
+                        addSymbol(fingerprint, method->arguments[a]->type);
+                        named.push_back(method->arguments[a]->type);
+                    }
+
+                    // the code of the method may be inlined into callers
+                    if (inlining)
+                        addStatement(fingerprint, method->body, &named);
+                }
+
+                for (size_t n = 0; n < named.size(); n++) {
+                    if (named[n] == SymbolTable::emptySymbol ||
+                        visited.contains(named[n]))
+                        continue;
+                    visited.put(named[n], true);
+                    types.push_back(named[n]);
+                }
+            }
+        }
+    }
+
+    dependencies.put(type, fingerprint.getValue());
+    return fingerprint.getValue();
+}
+
+
+void KeyBuilder::addStatement(Fingerprint& fingerprint,
+                              const uetli::parser::Statement* statement,
+                              std::vector<Symbol>* variableTypes)
+{
+    using namespace uetli::parser;
+
+    const CallOrVariableStatement* callOrVariable = 0;
+    const NewVariableStatement* newVariable = 0;
+    const AssignmentStatement* assignment = 0;
+    const DoEndBlock* block = 0;
+
+    if (statement == 0) {
+        fingerprint.add((unsigned long long) NO_NODE);
+    }
+    else if ((callOrVariable =
+              dynamic_cast<const CallOrVariableStatement*>(statement))) {
+        addExpression(fingerprint, callOrVariable);
+    }
+    else if ((newVariable =
+              dynamic_cast<const NewVariableStatement*>(statement))) {
+        fingerprint.add((unsigned long long) NEW_VARIABLE);
+        addSymbol(fingerprint, newVariable->type);
+        if (variableTypes != 0)
+            variableTypes->push_back(newVariable->type);
+        else
+            addKey(fingerprint, getDependencies(newVariable->type));
+        addSymbol(fingerprint, newVariable->name);
+        addExpression(fingerprint, newVariable->initialValue);
+    }
+    else if ((assignment =
+              dynamic_cast<const AssignmentStatement*>(statement))) {
+        fingerprint.add((unsigned long long) ASSIGNMENT);
+        addExpression(fingerprint, assignment->leftSide);
+        addExpression(fingerprint, assignment->rightSide);
+    }
+    else if ((block = dynamic_cast<const DoEndBlock*>(statement))) {
+        fingerprint.add((unsigned long long) BLOCK);
+        fingerprint.add((unsigned long long) block->statements.size());
+        for (size_t i = 0; i < block->statements.size(); i++) {
+            addStatement(fingerprint, block->statements[i], variableTypes);
+        }
+    }
+    else {
+        throw "internal error: unknown statement";
+    }
+}
+
+
+void KeyBuilder::addExpression(Fingerprint& fingerprint,
+                               const uetli::parser::Expression* expression)
+{
+    using namespace uetli::parser;
+
+    const CallOrVariableStatement* callOrVariable = 0;
+    const BinaryOperationExpression* binary = 0;
+    const UnaryOperationExpression* unary = 0;
+
+    if (expression == 0) {
+        fingerprint.add((unsigned long long) NO_NODE);
+    }
+    else if ((callOrVariable =
+              dynamic_cast<const CallOrVariableStatement*>(expression))) {
+        fingerprint.add((unsigned long long) CALL_OR_VARIABLE);
+        addSymbol(fingerprint, callOrVariable->methodName);
+        addExpression(fingerprint, callOrVariable->target);
+        fingerprint.add(
+                (unsigned long long) callOrVariable->arguments.size());
+        for (size_t i = 0; i < callOrVariable->arguments.size(); i++) {
+            addExpression(fingerprint, callOrVariable->arguments[i]);
+        }
+    }
+    else if ((binary =
+              dynamic_cast<const BinaryOperationExpression*>(expression))) {
+        fingerprint.add((unsigned long long) BINARY_OPERATION);
+        addSymbol(fingerprint, binary->operatorToken);
+        addExpression(fingerprint, binary->left);
+        addExpression(fingerprint, binary->right);
+    }
+    else if ((unary =
+              dynamic_cast<const UnaryOperationExpression*>(expression))) {
+        fingerprint.add((unsigned long long) UNARY_OPERATION);
+        addSymbol(fingerprint, unary->operatorToken);
+        fingerprint.add((unsigned long long) unary->fix);
+        addExpression(fingerprint, unary->value);
+    }
+    else {
+        throw "internal error: unknown expression";
+    }
+}
+
+
+StoreLoop::StoreLoop(const CompileCache& cache,
+                     const std::vector<CompileCache::Key>& keys,
+                     const std::vector<const DirectSubroutine*>& subroutines,
+                     const std::vector<const SubroutineCode*>& code) :
+    cache(cache), keys(keys), subroutines(subroutines), code(code)
+{
+}
+
+
+void StoreLoop::run(size_t index)
+{
+    // an entry which cannot be stored is simply missing next time
+    cache.store(keys[index], subroutines[index], *code[index]);
+}
+
+
+void EntryWriter::writeWord(unsigned long long value)
+{
+    for (int i = 0; i < 8; i++) {
+        data += (char) (value >> (8 * i));
+    }
+}
+
+
+void EntryWriter::writeString(const std::string& string)
+{
+    writeWord(string.size());
+    data += string;
+}
+
+
+void EntryWriter::writeIdentifier(const Identifier& identifier)
+{
+    writeWord(identifier.getSegmentCount());
+    for (size_t i = 0; i < identifier.getSegmentCount(); i++) {
+        writeString(identifier.getSegment(i));
+    }
+}
+
+
+void EntryWriter::writeInstruction(const StackInstruction* instruction)
+{
+    using namespace uetli::code;
+
+    const LoadInstruction* load = 0;
+    const StoreInstruction* store = 0;
+    const DereferenceInstruction* dereference = 0;
+    const DereferenceStoreInstruction* dereferenceStore = 0;
+    const CallInstruction* call = 0;
+    const LoadConstantInstruction* loadConstant = 0;
+    const IntrinsicInstruction* intrinsic = 0;
+
+    if ((load = dynamic_cast<const LoadInstruction*>(instruction))) {
+        writeWord(LOAD);
+        writeWord(load->getFromTop());
+    }
+    else if ((store = dynamic_cast<const StoreInstruction*>(instruction))) {
+        writeWord(STORE);
+        writeWord(store->getFromTop());
+    }
+    else if ((dereference =
+              dynamic_cast<const DereferenceInstruction*>(instruction))) {
+        writeWord(DEREFERENCE);
+        writeWord(dereference->getOffset());
+    }
+    else if ((dereferenceStore =
+              dynamic_cast<const DereferenceStoreInstruction*>(instruction))) {
+        writeWord(DEREFERENCE_STORE);
+        writeWord(dereferenceStore->getOffset());
+    }
+    else if (dynamic_cast<const PopInstruction*>(instruction)) {
+        writeWord(POP);
+    }
+    else if ((call = dynamic_cast<const CallInstruction*>(instruction))) {
+        // resolved or not, the call is stored as a link to be resolved
+        writeWord(CALL);
+        writeIdentifier(call->getSubroutine()->getName());
+        writeWord(call->getSubroutine()->getArgumentCount());
+    }
+    else if ((loadConstant =
+              dynamic_cast<const LoadConstantInstruction*>(instruction))) {
+        writeWord(LOAD_CONSTANT);
+        writeWord(loadConstant->getConstant());
+    }
+    else if (dynamic_cast<const AllocateInstruction*>(instruction)) {
+        writeWord(ALLOCATE);
+    }
+    else if (dynamic_cast<const DuplicateInstruction*>(instruction)) {
+        writeWord(DUPLICATE);
+    }
+    else if (dynamic_cast<const PrintInstruction*>(instruction)) {
+        writeWord(PRINT);
+    }
+    else if ((intrinsic =
+              dynamic_cast<const IntrinsicInstruction*>(instruction))) {
+        writeWord(INTRINSIC);
+        writeWord(intrinsic->getIntrinsic());
+    }
+    else {
+        throw "instruction cannot be stored in the cache";
+    }
+}
+
+
+void EntryWriter::writeSubroutine(const DirectSubroutine* subroutine)
+{
+    writeIdentifier(subroutine->getName());
+    writeWord(subroutine->getArgumentCount());
+    writeWord(subroutine->getLocalVariableCount());
+
+    const std::vector<StackInstruction*>& instructions =
+            subroutine->getInstructions();
+    writeWord(instructions.size());
+    for (size_t i = 0; i < instructions.size(); i++) {
+        writeInstruction(instructions[i]);
+    }
+}
+
+
+const std::string& EntryWriter::getData(void) const
+{
+    return data;
+}
+
+
+EntryReader::EntryReader(const std::string& data) :
+    data(data), position(0)
+{
+}
+
+
+unsigned long long EntryReader::readWord(void)
+{
+    if (data.size() - position < 8)
+        throw "corrupt cache entry";
+
+    unsigned long long value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | (unsigned char) data[position + i];
+    }
+    position += 8;
+    return value;
+}
+
+
+std::string EntryReader::readString(void)
+{
+    unsigned long long length = readWord();
+    if (length > data.size() - position)
+        throw "corrupt cache entry";
+
+    std::string string = data.substr(position, length);
+    position += length;
+    return string;
+}
+
+
+Identifier EntryReader::readIdentifier(void)
+{
+    unsigned long long segmentCount = readWord();
+    if (segmentCount == 0 || segmentCount > data.size() - position)
+        throw "corrupt cache entry";
+
+    Identifier identifier(readString());
+    for (unsigned long long i = 1; i < segmentCount; i++) {
+        identifier.append(readString());
+    }
+    return identifier;
+}
+
+
+StackInstruction* EntryReader::readInstruction(void)
+{
+    using namespace uetli::code;
+
+    switch (readWord()) {
+        case LOAD:
+            return new LoadInstruction(readWord());
+        case STORE:
+            return new StoreInstruction(readWord());
+        case DEREFERENCE:
+            return new DereferenceInstruction(readWord());
+        case DEREFERENCE_STORE:
+            return new DereferenceStoreInstruction(readWord());
+        case POP:
+            return new PopInstruction();
+        case CALL: {
+            Identifier name = readIdentifier();
+            size_t argumentCount = readWord();
+            return new CallInstruction(new SubroutineLink(name,
+                                                          argumentCount));
+        }
+        case LOAD_CONSTANT:
+            return new LoadConstantInstruction(readWord());
+        case ALLOCATE:
+            return new AllocateInstruction();
+        case DUPLICATE:
+            return new DuplicateInstruction();
+        case PRINT:
+            return new PrintInstruction();
+        case INTRINSIC: {
+            unsigned long long intrinsic = readWord();
+            if (intrinsic >= intrinsics_count)
+                throw "corrupt cache entry";
+            return new IntrinsicInstruction((Intrinsic) intrinsic);
+        }
+        default:
+            throw "corrupt cache entry";
+    }
+}
+
+
+DirectSubroutine* EntryReader::readSubroutine(void)
+{
+    Identifier name = readIdentifier();
+    size_t argumentCount = readWord();
+    uetli::code::Word localVariableCount = readWord();
+
+    DirectSubroutine* subroutine =
+            new DirectSubroutine(localVariableCount, name, argumentCount);
+    try {
+        // every instruction takes at least one word
+        unsigned long long instructionCount = readWord();
+        if (instructionCount > (data.size() - position) / 8)
+            throw "corrupt cache entry";
+
+        for (unsigned long long i = 0; i < instructionCount; i++) {
+            subroutine->addInstruction(readInstruction());
+        }
+    }
+    catch (...) {
+        for (size_t i = 0; i < subroutine->getInstructions().size(); i++) {
+            delete subroutine->getInstructions()[i];
+        }
+        delete subroutine;
+        throw;
+    }
+    return subroutine;
+}
+
+
+bool EntryReader::isAtEnd(void) const
+{
+    return position == data.size();
+}
+
+
+CachedSubroutine::CachedSubroutine(
+        const std::string& labelName, const std::string& text,
+        const std::vector<unsigned char>& bytes,
+        const std::vector<MachineCode::Relocation>& relocations) :
+    labelName(labelName), text(text), bytes(bytes), relocations(relocations)
+{
+}
+
+
+const std::string& CachedSubroutine::getLabelName(void) const
+{
+    return labelName;
+}
+
+
+std::string CachedSubroutine::toString(void) const
+{
+    return text;
+}
+
+
+void CachedSubroutine::encode(MachineCode& code) const
+{
+    code.defineSymbol(labelName);
+
+    size_t position = 0;
+    for (size_t i = 0; i < relocations.size(); i++) {
+        for (; position < relocations[i].offset; position++) {
+            code.emitByte(bytes[position]);
+        }
+        code.emitRelocation(relocations[i].symbol);
+        position += 4;
+    }
+    for (; position < bytes.size(); position++) {
+        code.emitByte(bytes[position]);
+    }
+}
+
+
+CompileCache::CompileCache(const std::string& directory,
+                           unsigned int optimizationLevel,
+                           size_t inlineLimit) :
+    directory(directory), optimizationLevel(optimizationLevel),
+    inlineLimit(inlineLimit)
+{
+}
+
+
+CompileCache::~CompileCache(void)
+{
+    Entry entry;
+    for (size_t i = 0; i < cachedMethods.size(); i++) {
+        if (takeEntry(cachedMethods[i], entry)) {
+            delete entry.subroutine;
+            delete entry.code;
+        }
+    }
+}
+
+
+void CompileCache::lookUp(const std::vector<ClassDeclaration*>& classes)
+{
+    KeyBuilder builder(classes, optimizationLevel, inlineLimit);
+
+    for (size_t i = 0; i < classes.size(); i++) {
+        const uetli::parser::FeatureList& features = classes[i]->features;
+        for (size_t j = 0; j < features.size(); j++) {
+            const MethodDeclaration* method =
+                    dynamic_cast<const MethodDeclaration*>(features[j]);
+            if (method == 0)
+                continue;
+
+            Key key = builder.getKey(classes[i], method);
+            keys.put(method, key);
+
+            Entry entry;
+            if (load(key, entry)) {
+                entries.put(method, entry);
+                cachedMethods.push_back(method);
+            }
+        }
+    }
+}
+
+
+const std::vector<const MethodDeclaration*>&
+CompileCache::getCachedMethods(void) const
+{
+    return cachedMethods;
+}
+
+
+bool CompileCache::takeEntry(const MethodDeclaration* method, Entry& entry)
+{
+    Entry* found = entries.getReference(method);
+    if (found == 0 || found->subroutine == 0)
+        return false;
+
+    entry = *found;
+    found->subroutine = 0;
+    found->code = 0;
+    return true;
+}
+
+
+const CompileCache::Key& CompileCache::getKey(
+        const MethodDeclaration* method) const
+{
+    return keys.get(method);
+}
+
+
+bool CompileCache::store(const Key& key, const DirectSubroutine* subroutine,
+                         const SubroutineCode& code) const
+{
+    EntryWriter writer;
+    MachineCode machineCode;
+    try {
+        writer.writeString(entryMagic);
+        writer.writeWord(formatVersion);
+        writer.writeWord(key.low);
+        writer.writeWord(key.high);
+        writer.writeSubroutine(subroutine);
+        code.encode(machineCode);
+    }
+    catch (...) {
+        return false;
+    }
+
+    // the code can only be moved if its label is the only symbol it defines
+    if (machineCode.getSymbols().size() != 1)
+        return false;
+
+    writer.writeString(code.getLabelName());
+    writer.writeString(code.toString());
+    writer.writeString(std::string((const char*) machineCode.getBytes(),
+                                   machineCode.getSize()));
+
+    const std::vector<MachineCode::Relocation>& relocations =
+            machineCode.getRelocations();
+    writer.writeWord(relocations.size());
+    for (size_t i = 0; i < relocations.size(); i++) {
+        writer.writeWord(relocations[i].offset);
+        writer.writeString(relocations[i].symbol);
+    }
+
+    ::mkdir(directory.c_str(), 0777);
+
+    // the entry is renamed when it is complete, so other compilations
+    // reading the cache never see a partially written entry
+    static std::atomic<unsigned long> temporaryCount(0);
+    std::string path = getEntryPath(key);
+    char suffix[64];
+    ::snprintf(suffix, sizeof suffix, ".%ld.%lu.tmp", (long) ::getpid(),
+               temporaryCount++);
+    std::string temporaryPath = path + suffix;
+
+    FILE* file = ::fopen(temporaryPath.c_str(), "wb");
+    if (file == 0)
+        return false;
+
+    const std::string& data = writer.getData();
+    bool written = ::fwrite(data.data(), 1, data.size(), file) == data.size();
+    written = ::fclose(file) == 0 && written;
+
+    if (!written || ::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        ::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+void CompileCache::store(
+        const std::vector<Key>& keys,
+        const std::vector<const DirectSubroutine*>& subroutines,
+        const std::vector<const SubroutineCode*>& code,
+        size_t threadCount) const
+{
+    StoreLoop loop(*this, keys, subroutines, code);
+    util::ThreadPool::forEach(loop, keys.size(), threadCount);
+}
+
+
+bool CompileCache::load(const Key& key, Entry& entry) const
+{
+    FILE* file = ::fopen(getEntryPath(key).c_str(), "rb");
+    if (file == 0)
+        return false;
+
+    std::string data;
+    char buffer[4096];
+    size_t read;
+    while ((read = ::fread(buffer, 1, sizeof buffer, file)) > 0) {
+        data.append(buffer, read);
+    }
+    ::fclose(file);
+
+    EntryReader reader(data);
+    DirectSubroutine* subroutine = 0;
+    try {
+        if (reader.readString() != entryMagic ||
+            reader.readWord() != formatVersion ||
+            reader.readWord() != key.low ||
+            reader.readWord() != key.high)
+            return false;
+
+        subroutine = reader.readSubroutine();
+
+        std::string labelName = reader.readString();
+        std::string text = reader.readString();
+        std::string bytes = reader.readString();
+
+        unsigned long long relocationCount = reader.readWord();
+        std::vector<MachineCode::Relocation> relocations;
+        size_t end = 0;
+        for (unsigned long long i = 0; i < relocationCount; i++) {
+            MachineCode::Relocation relocation;
+            relocation.offset = reader.readWord();
+            relocation.symbol = reader.readString();
+
+            // the relocation fields must not overlap
+            if (relocation.offset < end || relocation.offset > bytes.size() ||
+                bytes.size() - relocation.offset < 4)
+                throw "corrupt cache entry";
+            end = relocation.offset + 4;
+            relocations.push_back(relocation);
+        }
+
+        if (!reader.isAtEnd())
+            throw "corrupt cache entry";
+
+        entry.subroutine = subroutine;
+        entry.code = new CachedSubroutine(labelName, text,
+                std::vector<unsigned char>(bytes.begin(), bytes.end()),
+                relocations);
+    }
+    catch (const char*) {
+        if (subroutine != 0) {
+            for (size_t i = 0; i < subroutine->getInstructions().size(); i++) {
+                delete subroutine->getInstructions()[i];
+            }
+            delete subroutine;
+        }
+        return false;
+    }
+    return true;
+}
+
+
+std::string CompileCache::getEntryPath(const Key& key) const
+{
+    return directory + "/" + key.toString();
+}
+
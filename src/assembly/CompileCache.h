@@ -0,0 +1,190 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_ASSEMBLY_COMPILECACHE_H_
+#define UETLI_ASSEMBLY_COMPILECACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "AssemblyGenerator.h"
+#include "MachineCode.h"
+
+#include "../parser/ParseObject.h"
+#include "../code/StackMachine.h"
+#include "../util/Fingerprint.h"
+#include "../util/HashMap.h"
+
+namespace uetli
+{
+    namespace assembly
+    {
+        class CachedSubroutine;
+        class CompileCache;
+    }
+}
+
+
+///
+/// \brief the code of a subroutine loaded from the compile cache
+///
+/// The machine code is kept as it was encoded on its own, with the
+/// relocation fields not filled in, so it can be appended at any position.
+///
+class uetli::assembly::CachedSubroutine : public SubroutineCode
+{
+    std::string labelName;
+    std::string text;
+    std::vector<unsigned char> bytes;
+
+    /// relocations in the order of their offsets
+    std::vector<MachineCode::Relocation> relocations;
+
+public:
+    CachedSubroutine(const std::string& labelName, const std::string& text,
+                     const std::vector<unsigned char>& bytes,
+                     const std::vector<MachineCode::Relocation>& relocations);
+
+    virtual const std::string& getLabelName(void) const;
+    virtual std::string toString(void) const;
+    virtual void encode(MachineCode& code) const;
+};
+
+
+///
+/// \brief on-disk cache of the code generated for single methods
+///
+/// Every method is identified by a key, which is the fingerprint of its
+/// declaration and body together with the signatures (fields, methods and
+/// their types) of all classes the code of the method can depend on: its
+/// own class, the types of its local variables and, transitively, all
+/// classes named in the signatures of these. The optimization level is part
+/// of the key as well. If small methods are inlined, the bodies of all
+/// methods of these classes are part of the key, too, so editing a method
+/// recompiles every method which might have inlined it. A method whose key
+/// is found in the cache is neither attributed nor compiled again, so the
+/// time to rebuild a project grows with the size of the edit rather than
+/// the size of the project.
+///
+/// Every entry is stored in its own file in the cache directory, named
+/// after the key. It holds the linked stack code of the method (calls
+/// refer to their targets by name) and the x86-64 code generated from it.
+///
+class uetli::assembly::CompileCache
+{
+public:
+    typedef util::Fingerprint::Value Key;
+
+    struct Entry
+    {
+        /// the stack code, which still has to be linked
+        code::DirectSubroutine* subroutine;
+        CachedSubroutine* code;
+    };
+
+private:
+    std::string directory;
+    unsigned int optimizationLevel;
+    size_t inlineLimit;
+
+    util::HashMap<const parser::MethodDeclaration*, Key> keys;
+
+    /// entries loaded by lookUp() which were not taken yet
+    util::HashMap<const parser::MethodDeclaration*, Entry> entries;
+
+    /// the methods for which an entry was loaded
+    std::vector<const parser::MethodDeclaration*> cachedMethods;
+
+public:
+    ///
+    /// \param directory the directory containing the entries, which is
+    ///                  created when the first entry is stored
+    /// \param optimizationLevel the level the code is optimized with
+    /// \param inlineLimit the maximum number of instructions of an inlined
+    ///                    method
+    ///
+    CompileCache(const std::string& directory,
+                 unsigned int optimizationLevel, size_t inlineLimit);
+    ~CompileCache(void);
+
+    ///
+    /// \brief compute the keys of all methods and load the entries stored
+    ///        under them
+    ///
+    /// Entries which cannot be read are treated as missing.
+    ///
+    void lookUp(const std::vector<parser::ClassDeclaration*>& classes);
+
+    ///
+    /// \return the methods for which lookUp() found an entry
+    ///
+    const std::vector<const parser::MethodDeclaration*>&
+    getCachedMethods(void) const;
+
+    ///
+    /// \brief take the loaded entry of a method
+    ///
+    /// The caller becomes the owner of the objects in the entry.
+    ///
+    /// \return <code>false</code>, if there is no (more) entry for the method
+    ///
+    bool takeEntry(const parser::MethodDeclaration* method, Entry& entry);
+
+    ///
+    /// \return the key computed for a method by lookUp()
+    ///
+    const Key& getKey(const parser::MethodDeclaration* method) const;
+
+    ///
+    /// \brief store the code of a method
+    ///
+    /// \param key the key of the method
+    /// \param subroutine the linked stack code of the method
+    /// \param code the machine code generated from the subroutine
+    ///
+    /// \return <code>false</code>, if the entry could not be written
+    ///
+    bool store(const Key& key, const code::DirectSubroutine* subroutine,
+               const SubroutineCode& code) const;
+
+    ///
+    /// \brief store the code of several methods concurrently
+    ///
+    /// \param keys the keys of the methods
+    /// \param subroutines the linked stack code of every method
+    /// \param code the machine code of every method
+    /// \param threadCount the maximum number of threads used
+    ///
+    void store(const std::vector<Key>& keys,
+               const std::vector<const code::DirectSubroutine*>& subroutines,
+               const std::vector<const SubroutineCode*>& code,
+               size_t threadCount) const;
+
+private:
+    bool load(const Key& key, Entry& entry) const;
+
+    std::string getEntryPath(const Key& key) const;
+};
+
+
+#endif // UETLI_ASSEMBLY_COMPILECACHE_H_
+
@@ -0,0 +1,271 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "ElfWriter.h"
+
+#include <elf.h>
+#include <cstring>
+
+using namespace uetli::assembly;
+
+
+namespace
+{
+
+///
+/// \brief section indices in the written file
+///
+enum
+{
+    SECTION_NULL = 0,
+    SECTION_TEXT,
+    SECTION_RELA_TEXT,
+    SECTION_SYMTAB,
+    SECTION_STRTAB,
+    SECTION_SHSTRTAB,
+    SECTION_NOTE_GNU_STACK,
+    sections_count
+};
+
+
+///
+/// \brief a string table as used by ELF
+///
+/// The table starts with an empty string, so offset 0 refers to "".
+///
+class StringTable
+{
+    std::vector<char> data;
+public:
+    StringTable(void) :
+        data(1, '\0')
+    {
+    }
+
+    Elf64_Word add(const std::string& str)
+    {
+        Elf64_Word offset = (Elf64_Word) data.size();
+        data.insert(data.end(), str.begin(), str.end());
+        data.push_back('\0');
+        return offset;
+    }
+
+    const std::vector<char>& getData(void) const
+    {
+        return data;
+    }
+};
+
+}
+
+
+template <typename T>
+static void append(std::vector<unsigned char>& output, const T& value)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+    output.insert(output.end(), bytes, bytes + sizeof(T));
+}
+
+
+static void appendBytes(std::vector<unsigned char>& output,
+                        const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    output.insert(output.end(), bytes, bytes + size);
+}
+
+
+static void align(std::vector<unsigned char>& output, size_t alignment)
+{
+    while (output.size() % alignment != 0)
+        output.push_back(0);
+}
+
+
+ElfWriter::ElfWriter(const MachineCode& code) :
+    code(code)
+{
+}
+
+
+void ElfWriter::write(FILE* file) const
+{
+    std::vector<unsigned char> output;
+    generate(output);
+
+    if (::fwrite(&output[0], 1, output.size(), file) != output.size())
+        throw AssemblyException("could not write object file");
+}
+
+
+void ElfWriter::generate(std::vector<unsigned char>& output) const
+{
+    const std::vector<std::string>& symbols = code.getSymbols();
+    const std::vector<MachineCode::Relocation>& relocations =
+            code.getRelocations();
+
+    StringTable strtab;
+    StringTable shstrtab;
+
+    // symbol table: null symbol and section symbol (local), then all
+    // defined and undefined symbols (global)
+    std::vector<Elf64_Sym> symtab;
+    Elf64_Sym symbol;
+
+    ::memset(&symbol, 0, sizeof symbol);
+    symtab.push_back(symbol);
+
+    symbol.st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION);
+    symbol.st_shndx = SECTION_TEXT;
+    symtab.push_back(symbol);
+
+    Elf64_Word firstGlobal = (Elf64_Word) symtab.size();
+
+    for (size_t i = 0; i < symbols.size(); i++) {
+        size_t offset = *code.findSymbol(symbols[i]);
+        size_t end = i + 1 < symbols.size() ?
+                *code.findSymbol(symbols[i + 1]) : code.getSize();
+
+        ::memset(&symbol, 0, sizeof symbol);
+        symbol.st_name = strtab.add(symbols[i]);
+        symbol.st_info = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC);
+        symbol.st_shndx = SECTION_TEXT;
+        symbol.st_value = offset;
+        symbol.st_size = end - offset;
+        symtab.push_back(symbol);
+    }
+
+    // relocations, each undefined symbol is added once
+    uetli::util::HashMap<std::string, Elf64_Word> undefinedSymbols;
+    std::vector<Elf64_Rela> rela;
+    for (size_t i = 0; i < relocations.size(); i++) {
+        const std::string& name = relocations[i].symbol;
+        const Elf64_Word* index = undefinedSymbols.getReference(name);
+        Elf64_Word symbolIndex;
+        if (index != 0) {
+            symbolIndex = *index;
+        }
+        else {
+            ::memset(&symbol, 0, sizeof symbol);
+            symbol.st_name = strtab.add(name);
+            symbol.st_info = ELF64_ST_INFO(STB_GLOBAL, STT_NOTYPE);
+            symbol.st_shndx = SHN_UNDEF;
+            symbolIndex = (Elf64_Word) symtab.size();
+            symtab.push_back(symbol);
+            undefinedSymbols.put(name, symbolIndex);
+        }
+
+        // the field holds the distance to the end of the field, which is
+        // 4 bytes after its start
+        Elf64_Rela entry;
+        entry.r_offset = relocations[i].offset;
+        entry.r_info = ELF64_R_INFO(symbolIndex, R_X86_64_PLT32);
+        entry.r_addend = -4;
+        rela.push_back(entry);
+    }
+
+    // section contents
+    Elf64_Shdr headers[sections_count];
+    ::memset(headers, 0, sizeof headers);
+
+    Elf64_Ehdr header;
+    ::memset(&header, 0, sizeof header);
+    append(output, header);
+
+    headers[SECTION_TEXT].sh_name = shstrtab.add(".text");
+    headers[SECTION_TEXT].sh_type = SHT_PROGBITS;
+    headers[SECTION_TEXT].sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+    headers[SECTION_TEXT].sh_addralign = 16;
+    align(output, 16);
+    headers[SECTION_TEXT].sh_offset = output.size();
+    headers[SECTION_TEXT].sh_size = code.getSize();
+    appendBytes(output, code.getBytes(), code.getSize());
+
+    headers[SECTION_RELA_TEXT].sh_name = shstrtab.add(".rela.text");
+    headers[SECTION_RELA_TEXT].sh_type = SHT_RELA;
+    headers[SECTION_RELA_TEXT].sh_flags = SHF_INFO_LINK;
+    headers[SECTION_RELA_TEXT].sh_link = SECTION_SYMTAB;
+    headers[SECTION_RELA_TEXT].sh_info = SECTION_TEXT;
+    headers[SECTION_RELA_TEXT].sh_addralign = 8;
+    headers[SECTION_RELA_TEXT].sh_entsize = sizeof(Elf64_Rela);
+    align(output, 8);
+    headers[SECTION_RELA_TEXT].sh_offset = output.size();
+    headers[SECTION_RELA_TEXT].sh_size = rela.size() * sizeof(Elf64_Rela);
+    for (size_t i = 0; i < rela.size(); i++)
+        append(output, rela[i]);
+
+    headers[SECTION_SYMTAB].sh_name = shstrtab.add(".symtab");
+    headers[SECTION_SYMTAB].sh_type = SHT_SYMTAB;
+    headers[SECTION_SYMTAB].sh_link = SECTION_STRTAB;
+    headers[SECTION_SYMTAB].sh_info = firstGlobal;
+    headers[SECTION_SYMTAB].sh_addralign = 8;
+    headers[SECTION_SYMTAB].sh_entsize = sizeof(Elf64_Sym);
+    headers[SECTION_SYMTAB].sh_offset = output.size();
+    headers[SECTION_SYMTAB].sh_size = symtab.size() * sizeof(Elf64_Sym);
+    for (size_t i = 0; i < symtab.size(); i++)
+        append(output, symtab[i]);
+
+    headers[SECTION_STRTAB].sh_name = shstrtab.add(".strtab");
+    headers[SECTION_STRTAB].sh_type = SHT_STRTAB;
+    headers[SECTION_STRTAB].sh_addralign = 1;
+    headers[SECTION_STRTAB].sh_offset = output.size();
+    headers[SECTION_STRTAB].sh_size = strtab.getData().size();
+    appendBytes(output, &strtab.getData()[0], strtab.getData().size());
+
+    // marks the stack as non-executable
+    headers[SECTION_NOTE_GNU_STACK].sh_name = shstrtab.add(".note.GNU-stack");
+    headers[SECTION_NOTE_GNU_STACK].sh_type = SHT_PROGBITS;
+    headers[SECTION_NOTE_GNU_STACK].sh_addralign = 1;
+    headers[SECTION_NOTE_GNU_STACK].sh_offset = output.size();
+
+    headers[SECTION_SHSTRTAB].sh_name = shstrtab.add(".shstrtab");
+    headers[SECTION_SHSTRTAB].sh_type = SHT_STRTAB;
+    headers[SECTION_SHSTRTAB].sh_addralign = 1;
+    headers[SECTION_SHSTRTAB].sh_offset = output.size();
+    headers[SECTION_SHSTRTAB].sh_size = shstrtab.getData().size();
+    appendBytes(output, &shstrtab.getData()[0], shstrtab.getData().size());
+
+    align(output, 8);
+    Elf64_Off sectionHeaderOffset = output.size();
+    for (size_t i = 0; i < sections_count; i++)
+        append(output, headers[i]);
+
+    // the file header can be completed now
+    header.e_ident[EI_MAG0] = ELFMAG0;
+    header.e_ident[EI_MAG1] = ELFMAG1;
+    header.e_ident[EI_MAG2] = ELFMAG2;
+    header.e_ident[EI_MAG3] = ELFMAG3;
+    header.e_ident[EI_CLASS] = ELFCLASS64;
+    header.e_ident[EI_DATA] = ELFDATA2LSB;
+    header.e_ident[EI_VERSION] = EV_CURRENT;
+    header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    header.e_type = ET_REL;
+    header.e_machine = EM_X86_64;
+    header.e_version = EV_CURRENT;
+    header.e_shoff = sectionHeaderOffset;
+    header.e_ehsize = sizeof(Elf64_Ehdr);
+    header.e_shentsize = sizeof(Elf64_Shdr);
+    header.e_shnum = sections_count;
+    header.e_shstrndx = SECTION_SHSTRTAB;
+    ::memcpy(&output[0], &header, sizeof header);
+}
+
@@ -0,0 +1,71 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_ASSEMBLY_ELFWRITER_H_
+#define UETLI_ASSEMBLY_ELFWRITER_H_
+
+#include <cstdio>
+#include <vector>
+#include <string>
+
+#include "MachineCode.h"
+
+namespace uetli
+{
+    namespace assembly
+    {
+        class ElfWriter;
+    }
+}
+
+
+///
+/// \brief writes machine code as a relocatable ELF64 object file
+///
+/// The code is placed in the .text section. Every symbol defined in the code
+/// becomes a global function, and every remaining relocation refers to an
+/// undefined global symbol to be resolved by the linker.
+///
+class uetli::assembly::ElfWriter
+{
+    const MachineCode& code;
+
+public:
+    ElfWriter(const MachineCode& code);
+
+    ///
+    /// \brief write the object file
+    ///
+    /// \throws AssemblyException if the file cannot be written
+    ///
+    void write(FILE* file) const;
+
+private:
+    ///
+    /// \brief build the content of the whole object file
+    ///
+    void generate(std::vector<unsigned char>& output) const;
+};
+
+
+#endif // UETLI_ASSEMBLY_ELFWRITER_H_
+
@@ -0,0 +1,130 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "JitCompiler.h"
+#include "Runtime.h"
+
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace uetli::assembly;
+
+
+JitCompiler::JitCompiler(unsigned int optimizationLevel) :
+    generator(optimizationLevel),
+    memory(0),
+    memorySize(0)
+{
+}
+
+
+JitCompiler::~JitCompiler(void)
+{
+    if (memory != 0)
+        ::munmap(memory, memorySize);
+}
+
+
+void JitCompiler::addSubroutine(const code::DirectSubroutine* subroutine)
+{
+    if (memory != 0)
+        throw AssemblyException("subroutine added after compilation");
+    generator.generateAssembly(subroutine);
+}
+
+
+void JitCompiler::compile(void)
+{
+    if (memory != 0)
+        throw AssemblyException("code already compiled");
+
+    generator.encode(code);
+    code.resolveRelocations();
+    addRuntimeStubs();
+    code.resolveRelocations();
+
+    if (!code.getRelocations().empty()) {
+        throw AssemblyException("undefined symbol: " +
+                                code.getRelocations()[0].symbol);
+    }
+
+    size_t pageSize = (size_t) ::sysconf(_SC_PAGESIZE);
+    size_t size = (code.getSize() + pageSize - 1) / pageSize * pageSize;
+    if (size == 0)
+        size = pageSize;
+
+    // the memory is never writable and executable at the same time
+    void* mapped = ::mmap(0, size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED)
+        throw AssemblyException("could not allocate memory for the code");
+
+    if (code.getSize() > 0)
+        ::memcpy(mapped, code.getBytes(), code.getSize());
+
+    if (::mprotect(mapped, size, PROT_READ | PROT_EXEC) != 0) {
+        ::munmap(mapped, size);
+        throw AssemblyException("could not make the code executable");
+    }
+
+    memory = mapped;
+    memorySize = size;
+}
+
+
+void* JitCompiler::getFunction(const parser::Identifier& name) const
+{
+    if (memory == 0)
+        return 0;
+
+    const size_t* offset = code.findSymbol(name.getAssemblySymbol());
+    if (offset == 0)
+        return 0;
+
+    return static_cast<char*>(memory) + *offset;
+}
+
+
+void JitCompiler::addRuntimeStubs(void)
+{
+    const std::vector<MachineCode::Relocation>& relocations =
+            code.getRelocations();
+
+    for (size_t i = 0; i < relocations.size(); i++) {
+        const std::string& symbol = relocations[i].symbol;
+        if (code.findSymbol(symbol) != 0)
+            continue;
+
+        void* function = findRuntimeFunction(symbol);
+        if (function == 0)
+            throw AssemblyException("undefined symbol: " + symbol);
+
+        // jmp [rip + 0], followed by the absolute address
+        code.defineSymbol(symbol);
+        code.emitByte(0xFF);
+        code.emitByte(0x25);
+        code.emitInt32(0);
+        code.emitInt64((long long) function);
+    }
+}
+
@@ -0,0 +1,107 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_ASSEMBLY_JITCOMPILER_H_
+#define UETLI_ASSEMBLY_JITCOMPILER_H_
+
+#include <cstddef>
+
+#include "AssemblyGenerator.h"
+#include "MachineCode.h"
+
+namespace uetli
+{
+    namespace assembly
+    {
+        class JitCompiler;
+    }
+}
+
+
+///
+/// \brief compiles subroutines to machine code which runs in this process
+///
+/// The subroutines are lowered by AssemblySubroutine, exactly as for the
+/// assembly output, but the instructions are encoded directly into executable
+/// memory instead of being written as text.
+///
+/// Calls to functions of the runtime are routed through small stubs behind
+/// the code, which jump to the absolute address of the function, since it
+/// might be too far away for a direct call.
+///
+class uetli::assembly::JitCompiler
+{
+    AssemblyGenerator generator;
+    MachineCode code;
+
+    /// executable memory holding the code or 0 if not yet compiled
+    void* memory;
+    size_t memorySize;
+
+public:
+    ///
+    /// \param optimizationLevel the level the AssemblyGenerator lowers the
+    ///                          subroutines at
+    ///
+    JitCompiler(unsigned int optimizationLevel = 0);
+    ~JitCompiler(void);
+
+private:
+    JitCompiler(const JitCompiler&);
+    JitCompiler& operator=(const JitCompiler&);
+
+public:
+    ///
+    /// \brief add a subroutine to be compiled
+    ///
+    /// All subroutines called by it have to be added as well before
+    /// compile() is called.
+    ///
+    void addSubroutine(const code::DirectSubroutine* subroutine);
+
+    ///
+    /// \brief encode all added subroutines and load them into executable
+    ///        memory
+    ///
+    /// \throws AssemblyException if a called subroutine has not been added
+    ///                           and is not part of the runtime, or if the
+    ///                           memory cannot be allocated
+    ///
+    void compile(void);
+
+    ///
+    /// \param name the full identifier of a compiled subroutine
+    /// \return the address of the machine code of the subroutine or 0 if
+    ///         there is no such subroutine
+    ///
+    void* getFunction(const parser::Identifier& name) const;
+
+private:
+    ///
+    /// \brief define a stub for every runtime function called by the code
+    ///
+    void addRuntimeStubs(void);
+};
+
+
+#endif // UETLI_ASSEMBLY_JITCOMPILER_H_
+
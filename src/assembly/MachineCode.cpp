@@ -0,0 +1,138 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "MachineCode.h"
+
+using namespace uetli::assembly;
+
+
+MachineCode::MachineCode(void)
+{
+}
+
+
+void MachineCode::emitByte(unsigned char byte)
+{
+    bytes.push_back(byte);
+}
+
+
+void MachineCode::emitInt32(int value)
+{
+    // x86 is little endian
+    for (int i = 0; i < 4; i++) {
+        bytes.push_back((unsigned char) (value >> (8 * i)));
+    }
+}
+
+
+void MachineCode::emitInt64(long long value)
+{
+    for (int i = 0; i < 8; i++) {
+        bytes.push_back((unsigned char) (value >> (8 * i)));
+    }
+}
+
+
+void MachineCode::emitRelocation(const std::string& symbol)
+{
+    Relocation relocation;
+    relocation.offset = bytes.size();
+    relocation.symbol = symbol;
+    relocations.push_back(relocation);
+    emitInt32(0);
+}
+
+
+void MachineCode::defineSymbol(const std::string& name)
+{
+    if (symbolOffsets.getReference(name) != 0)
+        throw AssemblyException("symbol defined twice: " + name);
+    symbolOffsets.put(name, bytes.size());
+    symbols.push_back(name);
+}
+
+
+const size_t* MachineCode::findSymbol(const std::string& name) const
+{
+    return symbolOffsets.getReference(name);
+}
+
+
+void MachineCode::resolveRelocations(void)
+{
+    std::vector<Relocation> unresolved;
+    for (size_t i = 0; i < relocations.size(); i++) {
+        const Relocation& relocation = relocations[i];
+        const size_t* target = findSymbol(relocation.symbol);
+        if (target == 0) {
+            unresolved.push_back(relocation);
+            continue;
+        }
+
+        int distance = (int) ((long long) *target -
+                              (long long) (relocation.offset + 4));
+        for (int j = 0; j < 4; j++) {
+            bytes[relocation.offset + j] =
+                    (unsigned char) (distance >> (8 * j));
+        }
+    }
+    relocations.swap(unresolved);
+}
+
+
+size_t MachineCode::getSize(void) const
+{
+    return bytes.size();
+}
+
+
+const unsigned char* MachineCode::getBytes(void) const
+{
+    return bytes.empty() ? 0 : &bytes[0];
+}
+
+
+const std::vector<std::string>& MachineCode::getSymbols(void) const
+{
+    return symbols;
+}
+
+
+const std::vector<MachineCode::Relocation>& MachineCode::getRelocations(
+        void) const
+{
+    return relocations;
+}
+
+
+AssemblyException::AssemblyException(const std::string& errorMessage) :
+    errorMessage(errorMessage)
+{
+}
+
+
+const std::string& AssemblyException::getErrorMessage(void) const
+{
+    return errorMessage;
+}
+
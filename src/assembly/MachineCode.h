@@ -0,0 +1,129 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_ASSEMBLY_MACHINECODE_H_
+#define UETLI_ASSEMBLY_MACHINECODE_H_
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+#include "../util/HashMap.h"
+
+namespace uetli
+{
+    namespace assembly
+    {
+        class MachineCode;
+        class AssemblyException;
+    }
+}
+
+
+///
+/// \brief a buffer of encoded machine instructions
+///
+/// Besides the bytes of the code, the buffer records the offsets of the
+/// defined symbols and all places where the address of a symbol has to be
+/// filled in (relocations).
+///
+/// Every relocation refers to a 32-bit field holding the distance between
+/// the end of the field and the symbol, as used by <code>call</code>.
+///
+class uetli::assembly::MachineCode
+{
+public:
+    struct Relocation
+    {
+        /// offset of the 32-bit field in the code
+        size_t offset;
+
+        /// the symbol whose address is needed
+        std::string symbol;
+    };
+
+private:
+    std::vector<unsigned char> bytes;
+
+    util::HashMap<std::string, size_t> symbolOffsets;
+
+    /// names of the defined symbols in the order of their definition
+    std::vector<std::string> symbols;
+
+    std::vector<Relocation> relocations;
+
+public:
+    MachineCode(void);
+
+    void emitByte(unsigned char byte);
+    void emitInt32(int value);
+    void emitInt64(long long value);
+
+    ///
+    /// \brief emit a 32-bit field which is filled in with the relative
+    ///        address of a symbol
+    ///
+    void emitRelocation(const std::string& symbol);
+
+    ///
+    /// \brief define a symbol at the current end of the code
+    ///
+    /// \throws AssemblyException if the symbol is already defined
+    ///
+    void defineSymbol(const std::string& name);
+
+    ///
+    /// \return the offset of the symbol or 0 if it is not defined
+    ///
+    const size_t* findSymbol(const std::string& name) const;
+
+    ///
+    /// \brief fill in all relocations referring to symbols defined in the
+    ///        code itself
+    ///
+    /// The resolved relocations are removed, so only the ones referring
+    /// to undefined symbols remain afterwards.
+    ///
+    void resolveRelocations(void);
+
+    size_t getSize(void) const;
+    const unsigned char* getBytes(void) const;
+
+    const std::vector<std::string>& getSymbols(void) const;
+    const std::vector<Relocation>& getRelocations(void) const;
+};
+
+
+///
+/// \brief thrown if machine code cannot be generated or loaded
+///
+class uetli::assembly::AssemblyException
+{
+    std::string errorMessage;
+public:
+    AssemblyException(const std::string& errorMessage);
+    const std::string& getErrorMessage(void) const;
+};
+
+
+#endif // UETLI_ASSEMBLY_MACHINECODE_H_
+
@@ -0,0 +1,362 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "RegisterAllocator.h"
+#include "MachineCode.h"
+
+#include <algorithm>
+
+using namespace uetli::assembly;
+using namespace uetli::assembly::x86_64;
+
+
+// rax, rdx, r10 and r11 are kept free as scratch registers for the
+// lowering of the instructions
+const size_t RegisterAllocator::nCallerSavedRegisters = 5;
+const Register RegisterAllocator::callerSavedRegisters[] = {
+    RCX, RSI, RDI, R8, R9
+};
+
+
+const size_t RegisterAllocator::nCalleeSavedRegisters = 5;
+const Register RegisterAllocator::calleeSavedRegisters[] = {
+    RBX, R12, R13, R14, R15
+};
+
+
+RegisterAllocator::RegisterAllocator(
+        const code::DirectSubroutine* subroutine) :
+    subroutine(subroutine),
+    function(0),
+    spillSlotCount(0)
+{
+}
+
+
+RegisterAllocator::RegisterAllocator(const ir::Function* function) :
+    subroutine(0),
+    function(function),
+    spillSlotCount(0)
+{
+}
+
+
+void RegisterAllocator::allocate(void)
+{
+    if (function != 0)
+        buildFunctionIntervals();
+    else
+        buildIntervals();
+    linearScan();
+}
+
+
+size_t RegisterAllocator::getValueCount(void) const
+{
+    return intervals.size();
+}
+
+
+const RegisterAllocator::Interval& RegisterAllocator::getInterval(
+        size_t value) const
+{
+    return intervals[value];
+}
+
+
+size_t RegisterAllocator::getValueNumber(
+        const ir::Instruction* instruction) const
+{
+    return valueNumbers.find(instruction)->second;
+}
+
+
+size_t RegisterAllocator::getSpillSlotCount(void) const
+{
+    return spillSlotCount;
+}
+
+
+const std::vector<Register>&
+RegisterAllocator::getUsedCalleeSavedRegisters(void) const
+{
+    return usedCalleeSavedRegisters;
+}
+
+
+RegisterAllocator::StackEffect RegisterAllocator::getStackEffect(
+        const code::StackInstruction* instruction)
+{
+    using namespace uetli::code;
+
+    StackEffect effect;
+    effect.uses = 0;
+    effect.pops = 0;
+    effect.pushes = 0;
+    effect.isCall = false;
+
+    const CallInstruction* call = 0;
+    const DirectSubroutine* inlineSubroutine = 0;
+
+    if (dynamic_cast<const LoadInstruction*>(instruction) ||
+        dynamic_cast<const LoadConstantInstruction*>(instruction)) {
+        effect.pushes = 1;
+    }
+    else if (dynamic_cast<const StoreInstruction*>(instruction) ||
+             dynamic_cast<const PopInstruction*>(instruction)) {
+        effect.uses = 1;
+        effect.pops = 1;
+    }
+    else if (dynamic_cast<const DereferenceInstruction*>(instruction) ||
+             dynamic_cast<const DuplicateInstruction*>(instruction)) {
+        effect.uses = 1;
+        effect.pushes = 1;
+    }
+    else if (dynamic_cast<const DereferenceStoreInstruction*>(instruction)) {
+        effect.uses = 2;
+        effect.pops = 1;
+    }
+    else if (dynamic_cast<const AllocateInstruction*>(instruction)) {
+        effect.uses = 1;
+        effect.pops = 1;
+        effect.pushes = 1;
+        effect.isCall = true;
+    }
+    else if (dynamic_cast<const PrintInstruction*>(instruction)) {
+        effect.uses = 1;
+        effect.isCall = true;
+    }
+    else if (dynamic_cast<const IntrinsicInstruction*>(instruction)) {
+        effect.uses = 2;
+        effect.pops = 2;
+        effect.pushes = 1;
+    }
+    else if ((call = dynamic_cast<const CallInstruction*>(instruction))) {
+        effect.uses = call->getSubroutine()->getArgumentCount();
+        effect.pops = effect.uses;
+        effect.pushes = 1;
+        effect.isCall = true;
+    }
+    else if ((inlineSubroutine =
+              dynamic_cast<const DirectSubroutine*>(instruction))) {
+        effect.uses = inlineSubroutine->getArgumentCount();
+        effect.pops = effect.uses;
+        effect.pushes = 1;
+        effect.isCall = true;
+    }
+    else {
+        throw AssemblyException("unknown stack instruction");
+    }
+
+    return effect;
+}
+
+
+void RegisterAllocator::buildIntervals(void)
+{
+    const std::vector<code::StackInstruction*>& instructions =
+            subroutine->getInstructions();
+
+    // the operation stack holding the numbers of the values
+    std::vector<size_t> stack;
+    std::vector<size_t> calls;
+
+    for (size_t i = 0; i < instructions.size(); i++) {
+        StackEffect effect = getStackEffect(instructions[i]);
+        if (effect.uses > stack.size())
+            throw AssemblyException("operation stack underflow in " +
+                                    subroutine->getName().getAsString());
+
+        for (size_t j = stack.size() - effect.uses; j < stack.size(); j++) {
+            intervals[stack[j]].end = i;
+        }
+        stack.resize(stack.size() - effect.pops);
+
+        for (size_t j = 0; j < effect.pushes; j++) {
+            stack.push_back(addInterval(i));
+        }
+
+        if (effect.isCall)
+            calls.push_back(i);
+    }
+
+    // the topmost value is the result of the subroutine
+    if (!stack.empty())
+        intervals[stack.back()].end = instructions.size();
+
+    markCallCrossings(calls);
+}
+
+
+void RegisterAllocator::buildFunctionIntervals(void)
+{
+    std::vector<size_t> calls;
+
+    // the instructions of all blocks are numbered in their order
+    size_t index = 0;
+    const std::vector<ir::BasicBlock*>& blocks = function->getBlocks();
+    for (size_t i = 0; i < blocks.size(); i++) {
+        const std::vector<ir::Instruction*>& instructions =
+                blocks[i]->getInstructions();
+        for (size_t j = 0; j < instructions.size(); j++, index++) {
+            const ir::Instruction* instruction = instructions[j];
+
+            for (size_t k = 0; k < instruction->getOperandCount(); k++) {
+                std::map<const ir::Instruction*, size_t>::const_iterator
+                        operand = valueNumbers.find(
+                            instruction->getOperand(k));
+                if (operand != valueNumbers.end())
+                    intervals[operand->second].end = index;
+            }
+
+            if (instruction->getType() == ir::WORD &&
+                !dynamic_cast<const ir::ConstantInstruction*>(instruction))
+                valueNumbers[instruction] = addInterval(index);
+
+            if (dynamic_cast<const ir::CallInstruction*>(instruction))
+                calls.push_back(index);
+        }
+    }
+
+    markCallCrossings(calls);
+}
+
+
+size_t RegisterAllocator::addInterval(size_t start)
+{
+    Interval interval;
+    interval.start = start;
+    interval.end = start;
+    interval.crossesCall = false;
+    interval.spilled = false;
+    interval.reg = RAX;
+    interval.spillSlot = 0;
+    intervals.push_back(interval);
+    return intervals.size() - 1;
+}
+
+
+void RegisterAllocator::markCallCrossings(const std::vector<size_t>& calls)
+{
+    // calls are sorted, so the first one after the start of an interval
+    // decides whether it crosses a call
+    for (size_t i = 0; i < intervals.size(); i++) {
+        Interval& interval = intervals[i];
+        std::vector<size_t>::const_iterator call =
+                std::upper_bound(calls.begin(), calls.end(), interval.start);
+        interval.crossesCall = call != calls.end() && *call < interval.end;
+    }
+}
+
+
+void RegisterAllocator::linearScan(void)
+{
+    // values are numbered in the order they are pushed, so the intervals
+    // are already sorted by their start
+    std::vector<size_t> active;
+    std::vector<Register> freeCallerSaved(callerSavedRegisters,
+            callerSavedRegisters + nCallerSavedRegisters);
+    std::vector<Register> freeCalleeSaved(calleeSavedRegisters,
+            calleeSavedRegisters + nCalleeSavedRegisters);
+    std::vector<size_t> freeSpillSlots;
+
+    // registers are taken from the back, so the first ones in the lists
+    // are used first
+    std::reverse(freeCallerSaved.begin(), freeCallerSaved.end());
+    std::reverse(freeCalleeSaved.begin(), freeCalleeSaved.end());
+
+    for (size_t i = 0; i < intervals.size(); i++) {
+        Interval& current = intervals[i];
+
+        // expire intervals ending before (or where) the current one starts;
+        // instructions read their operands before writing their results
+        for (size_t j = 0; j < active.size(); ) {
+            Interval& old = intervals[active[j]];
+            if (old.end > current.start) {
+                j++;
+                continue;
+            }
+            if (old.spilled)
+                freeSpillSlots.push_back(old.spillSlot);
+            else if (std::find(callerSavedRegisters, callerSavedRegisters +
+                               nCallerSavedRegisters, old.reg) !=
+                     callerSavedRegisters + nCallerSavedRegisters)
+                freeCallerSaved.push_back(old.reg);
+            else
+                freeCalleeSaved.push_back(old.reg);
+            active.erase(active.begin() + j);
+        }
+
+        if (!current.crossesCall && !freeCallerSaved.empty()) {
+            current.reg = freeCallerSaved.back();
+            freeCallerSaved.pop_back();
+            active.push_back(i);
+            continue;
+        }
+        if (!freeCalleeSaved.empty()) {
+            current.reg = freeCalleeSaved.back();
+            freeCalleeSaved.pop_back();
+            if (std::find(usedCalleeSavedRegisters.begin(),
+                          usedCalleeSavedRegisters.end(), current.reg) ==
+                    usedCalleeSavedRegisters.end())
+                usedCalleeSavedRegisters.push_back(current.reg);
+            active.push_back(i);
+            continue;
+        }
+
+        // no register left: spill the interval ending last, unless it is the
+        // current one; only registers the current interval may use are
+        // taken into account
+        size_t victim = i;
+        for (size_t j = 0; j < active.size(); j++) {
+            Interval& candidate = intervals[active[j]];
+            if (candidate.spilled)
+                continue;
+            bool calleeSaved = std::find(calleeSavedRegisters,
+                    calleeSavedRegisters + nCalleeSavedRegisters,
+                    candidate.reg) !=
+                    calleeSavedRegisters + nCalleeSavedRegisters;
+            if (current.crossesCall && !calleeSaved)
+                continue;
+            if (candidate.end > intervals[victim].end)
+                victim = active[j];
+        }
+
+        if (victim != i) {
+            current.reg = intervals[victim].reg;
+            active.push_back(i);
+        }
+
+        Interval& spilled = intervals[victim];
+        spilled.spilled = true;
+        if (!freeSpillSlots.empty()) {
+            spilled.spillSlot = freeSpillSlots.back();
+            freeSpillSlots.pop_back();
+        }
+        else {
+            spilled.spillSlot = spillSlotCount++;
+        }
+        if (victim == i)
+            active.push_back(i);
+    }
+}
+
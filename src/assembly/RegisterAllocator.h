@@ -0,0 +1,183 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_ASSEMBLY_REGISTERALLOCATOR_H_
+#define UETLI_ASSEMBLY_REGISTERALLOCATOR_H_
+
+#include <map>
+#include <vector>
+#include <cstddef>
+
+#include "Assemblyx86_64.h"
+#include "../code/StackMachine.h"
+#include "../ir/Function.h"
+
+namespace uetli
+{
+    namespace assembly
+    {
+        class RegisterAllocator;
+    }
+}
+
+
+///
+/// \brief assigns registers to the values on the operation stack
+///
+/// Every value pushed on the operation stack of a subroutine is numbered in
+/// the order the values are pushed. The live interval of a value reaches from
+/// the instruction pushing it to the last instruction reading it. The
+/// intervals are then assigned to registers by linear scan. Values which do
+/// not get a register are kept in spill slots in the stack frame.
+///
+/// Values living across a call only get callee-saved registers (or are
+/// spilled), so nothing has to be saved around calls.
+///
+/// The values of a function in SSA form are the instructions defining a
+/// word, numbered in the order of the instructions. Constants are not
+/// numbered, they are used as immediate operands instead.
+///
+class uetli::assembly::RegisterAllocator
+{
+public:
+    ///
+    /// \brief the live interval and location of one value
+    ///
+    struct Interval
+    {
+        /// index of the instruction pushing the value
+        size_t start;
+
+        /// index of the last instruction reading the value (the number of
+        /// instructions, if the value is returned)
+        size_t end;
+
+        /// true, if a call lies strictly inside the interval
+        bool crossesCall;
+
+        /// true, if the value is kept in a spill slot instead of register
+        bool spilled;
+
+        x86_64::Register reg;
+        size_t spillSlot;
+    };
+
+    ///
+    /// \brief how an instruction affects the operation stack
+    ///
+    struct StackEffect
+    {
+        /// number of values read from the top of the stack (including the
+        /// popped ones)
+        size_t uses;
+
+        /// number of values removed from the stack
+        size_t pops;
+
+        /// number of values pushed after removing the popped ones
+        size_t pushes;
+
+        /// true, if the instruction is implemented by calling a function,
+        /// which clobbers all caller-saved registers
+        bool isCall;
+    };
+
+    static const size_t nCallerSavedRegisters;
+    static const x86_64::Register callerSavedRegisters[];
+
+    static const size_t nCalleeSavedRegisters;
+    static const x86_64::Register calleeSavedRegisters[];
+
+private:
+    /// the code to allocate the registers for, one of them is 0
+    const code::DirectSubroutine* subroutine;
+    const ir::Function* function;
+
+    /// the numbers of the values of the function
+    std::map<const ir::Instruction*, size_t> valueNumbers;
+
+    /// intervals indexed by the number of the value
+    std::vector<Interval> intervals;
+
+    size_t spillSlotCount;
+    std::vector<x86_64::Register> usedCalleeSavedRegisters;
+
+public:
+    RegisterAllocator(const code::DirectSubroutine* subroutine);
+    RegisterAllocator(const ir::Function* function);
+
+    ///
+    /// \brief compute the live intervals and assign the locations
+    ///
+    /// \throws AssemblyException if an instruction reads more values than
+    ///                           there are on the stack
+    ///
+    void allocate(void);
+
+    size_t getValueCount(void) const;
+    const Interval& getInterval(size_t value) const;
+
+    ///
+    /// \return the number of the value defined by an instruction of the
+    ///         function
+    ///
+    size_t getValueNumber(const ir::Instruction* instruction) const;
+
+    ///
+    /// \return the number of spill slots needed
+    ///
+    size_t getSpillSlotCount(void) const;
+
+    ///
+    /// \return all callee-saved registers which have been assigned to any
+    ///         value and have to be saved by the subroutine
+    ///
+    const std::vector<x86_64::Register>& getUsedCalleeSavedRegisters(
+            void) const;
+
+    ///
+    /// \brief determine the stack effect of an instruction
+    ///
+    static StackEffect getStackEffect(
+            const code::StackInstruction* instruction);
+
+private:
+    void buildIntervals(void);
+    void buildFunctionIntervals(void);
+
+    ///
+    /// \param start the index of the instruction defining the value
+    /// \return the number of the new value
+    ///
+    size_t addInterval(size_t start);
+
+    ///
+    /// \param calls the indices of the calls in ascending order
+    ///
+    void markCallCrossings(const std::vector<size_t>& calls);
+
+    void linearScan(void);
+};
+
+
+#endif // UETLI_ASSEMBLY_REGISTERALLOCATOR_H_
+
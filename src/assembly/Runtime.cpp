@@ -0,0 +1,68 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "Runtime.h"
+
+#include <iostream>
+#include <cstdlib>
+
+using uetli::code::Word;
+
+
+extern "C" void uetli_print(Word value)
+{
+    std::cout << (void*) value << std::endl;
+}
+
+
+namespace uetli
+{
+namespace assembly
+{
+
+const char* const allocateSymbol = "malloc";
+const char* const printSymbol = "uetli_print";
+
+
+void* findRuntimeFunction(const std::string& symbol)
+{
+    struct RuntimeFunction
+    {
+        const char* symbol;
+        void* address;
+    };
+
+    static const RuntimeFunction functions[] = {
+        { allocateSymbol, (void*) &::malloc },
+        { printSymbol, (void*) &::uetli_print },
+    };
+
+    for (size_t i = 0; i < sizeof functions / sizeof functions[0]; i++) {
+        if (symbol == functions[i].symbol)
+            return functions[i].address;
+    }
+    return 0;
+}
+
+}
+}
+
@@ -0,0 +1,61 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_ASSEMBLY_RUNTIME_H_
+#define UETLI_ASSEMBLY_RUNTIME_H_
+
+#include <string>
+
+#include "../code/StackMachine.h"
+
+///
+/// \brief print a value like the PrintInstruction does
+///
+extern "C" void uetli_print(uetli::code::Word value);
+
+namespace uetli
+{
+    namespace assembly
+    {
+        ///
+        /// \brief symbol of the runtime function memory is allocated with
+        ///
+        extern const char* const allocateSymbol;
+
+        ///
+        /// \brief symbol of the runtime function printing values
+        ///
+        extern const char* const printSymbol;
+
+        ///
+        /// \brief look up a function the generated code may call
+        ///
+        /// \return the address of the function or 0 if the symbol is not
+        ///         part of the runtime
+        ///
+        void* findRuntimeFunction(const std::string& symbol);
+    }
+}
+
+
+#endif // UETLI_ASSEMBLY_RUNTIME_H_
+
@@ -0,0 +1,224 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+#include "Bytecode.h"
+
+using namespace uetli::code;
+
+
+BytecodeSubroutine::BytecodeSubroutine(const DirectSubroutine* source) :
+    source(source),
+    argumentCount(source->getArgumentCount()),
+    localVariableCount(source->getLocalVariableCount()),
+    maxOperands(source->getInstructions().size())
+{
+}
+
+
+const DirectSubroutine* BytecodeSubroutine::getSource(void) const
+{
+    return source;
+}
+
+
+Word BytecodeSubroutine::getArgumentCount(void) const
+{
+    return argumentCount;
+}
+
+
+Word BytecodeSubroutine::getLocalVariableCount(void) const
+{
+    return localVariableCount;
+}
+
+
+Word BytecodeSubroutine::getMaxOperands(void) const
+{
+    return maxOperands;
+}
+
+
+const Word* BytecodeSubroutine::getCode(void) const
+{
+    return &code[0];
+}
+
+
+size_t BytecodeSubroutine::getCodeLength(void) const
+{
+    return code.size();
+}
+
+
+void BytecodeSubroutine::emit(Opcode opcode)
+{
+    code.push_back(opcode);
+}
+
+
+void BytecodeSubroutine::emit(Opcode opcode, Word argument)
+{
+    code.push_back(opcode);
+    code.push_back(argument);
+}
+
+
+uetli::code::Opcode uetli::code::getIntrinsicOpcode(Intrinsic intrinsic)
+{
+    switch (intrinsic) {
+        case INTEGER_ADD:
+            return OP_INTEGER_ADD;
+        case INTEGER_SUBTRACT:
+            return OP_INTEGER_SUBTRACT;
+        case INTEGER_MULTIPLY:
+            return OP_INTEGER_MULTIPLY;
+        case INTEGER_DIVIDE:
+            return OP_INTEGER_DIVIDE;
+        default:
+            throw "invalid intrinsic";
+    }
+}
+
+
+BytecodeModule::BytecodeModule(void)
+{
+}
+
+
+BytecodeModule::~BytecodeModule(void)
+{
+    for (size_t i = 0; i < subroutines.size(); i++) {
+        delete subroutines[i];
+    }
+    subroutines.clear();
+}
+
+
+BytecodeSubroutine* BytecodeModule::getBytecode(
+        const DirectSubroutine* subroutine)
+{
+    std::vector<BytecodeSubroutine*> toTranslate;
+    BytecodeSubroutine* result = getOrCreate(subroutine, toTranslate);
+
+    while (!toTranslate.empty()) {
+        BytecodeSubroutine* next = toTranslate.back();
+        toTranslate.pop_back();
+        translate(next, toTranslate);
+    }
+
+    return result;
+}
+
+
+BytecodeSubroutine* BytecodeModule::getOrCreate(
+        const DirectSubroutine* subroutine,
+        std::vector<BytecodeSubroutine*>& toTranslate)
+{
+    BytecodeSubroutine** existing = translated.getReference(subroutine);
+    if (existing != 0)
+        return *existing;
+
+    BytecodeSubroutine* created = new BytecodeSubroutine(subroutine);
+    translated.put(subroutine, created);
+    subroutines.push_back(created);
+    toTranslate.push_back(created);
+    return created;
+}
+
+
+void BytecodeModule::translate(BytecodeSubroutine* target,
+                               std::vector<BytecodeSubroutine*>& toTranslate)
+{
+    const std::vector<StackInstruction*>& instructions =
+            target->source->getInstructions();
+
+    for (size_t i = 0; i < instructions.size(); i++) {
+        const StackInstruction* instruction = instructions[i];
+
+        const LoadInstruction* load = 0;
+        const StoreInstruction* store = 0;
+        const DereferenceInstruction* dereference = 0;
+        const DereferenceStoreInstruction* dereferenceStore = 0;
+        const CallInstruction* call = 0;
+        const LoadConstantInstruction* loadConstant = 0;
+        const IntrinsicInstruction* intrinsic = 0;
+        const DirectSubroutine* inlineSubroutine = 0;
+
+        if ((load = dynamic_cast<const LoadInstruction*>(instruction))) {
+            target->emit(OP_LOAD, load->getFromTop());
+        }
+        else if ((store = dynamic_cast<const StoreInstruction*>(instruction))) {
+            target->emit(OP_STORE, store->getFromTop());
+        }
+        else if ((dereference =
+                  dynamic_cast<const DereferenceInstruction*>(instruction))) {
+            target->emit(OP_DEREFERENCE, dereference->getOffset());
+        }
+        else if ((dereferenceStore =
+                  dynamic_cast<const DereferenceStoreInstruction*>
+                  (instruction))) {
+            target->emit(OP_DEREFERENCE_STORE, dereferenceStore->getOffset());
+        }
+        else if (dynamic_cast<const PopInstruction*>(instruction)) {
+            target->emit(OP_POP);
+        }
+        else if ((call = dynamic_cast<const CallInstruction*>(instruction))) {
+            const DirectSubroutine* callee = call->getTarget();
+
+            // calls to unresolved links are skipped, just like
+            // CallInstruction::execute does
+            if (callee != 0) {
+                BytecodeSubroutine* bc = getOrCreate(callee, toTranslate);
+                target->emit(OP_CALL, reinterpret_cast<Word>(bc));
+            }
+        }
+        else if ((loadConstant =
+                  dynamic_cast<const LoadConstantInstruction*>(instruction))) {
+            target->emit(OP_LOAD_CONSTANT, loadConstant->getConstant());
+        }
+        else if (dynamic_cast<const AllocateInstruction*>(instruction)) {
+            target->emit(OP_ALLOCATE);
+        }
+        else if (dynamic_cast<const DuplicateInstruction*>(instruction)) {
+            target->emit(OP_DUPLICATE);
+        }
+        else if (dynamic_cast<const PrintInstruction*>(instruction)) {
+            target->emit(OP_PRINT);
+        }
+        else if ((intrinsic =
+                  dynamic_cast<const IntrinsicInstruction*>(instruction))) {
+            target->emit(getIntrinsicOpcode(intrinsic->getIntrinsic()));
+        }
+        else if ((inlineSubroutine =
+                  dynamic_cast<const DirectSubroutine*>(instruction))) {
+            // a subroutine used as an instruction executes its whole body
+            BytecodeSubroutine* bc = getOrCreate(inlineSubroutine, toTranslate);
+            target->emit(OP_CALL, reinterpret_cast<Word>(bc));
+        }
+        else {
+            throw "unknown stack instruction";
+        }
+    }
+
+    target->emit(OP_RETURN);
+}
+
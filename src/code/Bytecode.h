@@ -0,0 +1,146 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+#ifndef UETLI_CODE_BYTECODE_H_
+#define UETLI_CODE_BYTECODE_H_
+
+#include <vector>
+
+#include "StackMachine.h"
+#include "../util/HashMap.h"
+
+namespace uetli
+{
+    namespace code
+    {
+        ///
+        /// \brief operation codes of the flat bytecode
+        ///
+        /// Every opcode occupies one word in the bytecode. Opcodes taking an
+        /// argument are directly followed by one more word holding it.
+        ///
+        enum Opcode
+        {
+            OP_LOAD = 0,            // argument: index from top
+            OP_STORE,               // argument: index from top
+            OP_DEREFERENCE,         // argument: offset
+            OP_DEREFERENCE_STORE,   // argument: offset
+            OP_POP,
+            OP_CALL,                // argument: BytecodeSubroutine*
+            OP_LOAD_CONSTANT,       // argument: constant
+            OP_ALLOCATE,
+            OP_DUPLICATE,
+            OP_PRINT,
+            OP_RETURN,
+
+            // intrinsics
+            OP_INTEGER_ADD,
+            OP_INTEGER_SUBTRACT,
+            OP_INTEGER_MULTIPLY,
+            OP_INTEGER_DIVIDE,
+
+            /// contains the number of opcodes
+            opcodes_count
+        };
+
+        ///
+        /// \return the opcode executing the intrinsic
+        ///
+        Opcode getIntrinsicOpcode(Intrinsic intrinsic);
+
+        class BytecodeSubroutine;
+        class BytecodeModule;
+    }
+}
+
+
+///
+/// \brief a subroutine translated to flat bytecode
+///
+/// The bytecode is a contiguous array of words which can be interpreted
+/// without any virtual dispatch. It always ends with an OP_RETURN.
+///
+class uetli::code::BytecodeSubroutine
+{
+    friend class BytecodeModule;
+
+    const DirectSubroutine* source;
+    Word argumentCount;
+    Word localVariableCount;
+
+    /// upper bound for the number of values pushed on the operation stack
+    Word maxOperands;
+
+    std::vector<Word> code;
+
+public:
+    BytecodeSubroutine(const DirectSubroutine* source);
+
+    const DirectSubroutine* getSource(void) const;
+    Word getArgumentCount(void) const;
+    Word getLocalVariableCount(void) const;
+    Word getMaxOperands(void) const;
+
+    ///
+    /// \return a pointer to the first word of the bytecode
+    ///
+    const Word* getCode(void) const;
+    size_t getCodeLength(void) const;
+
+private:
+    void emit(Opcode opcode);
+    void emit(Opcode opcode, Word argument);
+};
+
+
+///
+/// \brief translates DirectSubroutines into bytecode
+///
+/// The module keeps exactly one BytecodeSubroutine per DirectSubroutine, so
+/// subroutines calling each other (even recursively) are only translated once.
+///
+class uetli::code::BytecodeModule
+{
+    util::HashMap<const DirectSubroutine*, BytecodeSubroutine*> translated;
+    std::vector<BytecodeSubroutine*> subroutines;
+
+public:
+    BytecodeModule(void);
+    ~BytecodeModule(void);
+
+    ///
+    /// \brief get the bytecode of a subroutine, translating it if necessary
+    ///
+    /// All subroutines called by it are translated as well.
+    ///
+    BytecodeSubroutine* getBytecode(const DirectSubroutine* subroutine);
+
+private:
+    BytecodeSubroutine* getOrCreate(const DirectSubroutine* subroutine,
+            std::vector<BytecodeSubroutine*>& toTranslate);
+
+    void translate(BytecodeSubroutine* target,
+                   std::vector<BytecodeSubroutine*>& toTranslate);
+};
+
+
+#endif // UETLI_CODE_BYTECODE_H_
+
@@ -0,0 +1,217 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "ConstantFolder.h"
+
+using namespace uetli::code;
+
+
+void ConstantFolder::optimize(DirectSubroutine* subroutine)
+{
+    if (!canFold(subroutine))
+        return;
+
+    std::vector<StackInstruction*>& instructions =
+            subroutine->getInstructions();
+
+    // the arguments are below the local variables, which are zeroed
+    Value unknown = { false, 0, 0 };
+    Value zero = { true, 0, 0 };
+    Word localCount = subroutine->getLocalVariableCount();
+    variables.assign(localCount + subroutine->getArgumentCount(), unknown);
+    for (Word i = 0; i < localCount; i++) {
+        variables[i] = zero;
+    }
+
+    output.clear();
+    stack.clear();
+    for (size_t i = 0; i < instructions.size(); i++) {
+        fold(instructions[i]);
+    }
+
+    instructions.clear();
+    for (size_t i = 0; i < output.size(); i++) {
+        if (output[i] != 0)
+            instructions.push_back(output[i]);
+    }
+    output.clear();
+}
+
+
+bool ConstantFolder::canFold(const DirectSubroutine* subroutine)
+{
+    const std::vector<StackInstruction*>& instructions =
+            subroutine->getInstructions();
+
+    for (size_t i = 0; i < instructions.size(); i++) {
+        const StackInstruction* instruction = instructions[i];
+        const CallInstruction* call =
+                dynamic_cast<const CallInstruction*>(instruction);
+
+        if (call != 0) {
+            if (call->getTarget() == 0)
+                return false;
+        }
+        else if (dynamic_cast<const LoadInstruction*>(instruction) == 0 &&
+                 dynamic_cast<const StoreInstruction*>(instruction) == 0 &&
+                 dynamic_cast<const LoadConstantInstruction*>(instruction)
+                        == 0 &&
+                 dynamic_cast<const DuplicateInstruction*>(instruction) == 0 &&
+                 dynamic_cast<const PopInstruction*>(instruction) == 0 &&
+                 dynamic_cast<const IntrinsicInstruction*>(instruction) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void ConstantFolder::fold(StackInstruction* instruction)
+{
+    LoadInstruction* load = 0;
+    StoreInstruction* store = 0;
+    LoadConstantInstruction* loadConstant = 0;
+    IntrinsicInstruction* intrinsic = 0;
+    CallInstruction* call = 0;
+
+    if ((load = dynamic_cast<LoadInstruction*>(instruction))) {
+        const Value& variable = variables[load->getFromTop()];
+        if (variable.known) {
+            delete load;
+            pushConstant(variable.constant);
+        }
+        else {
+            output.push_back(load);
+            pushUnknown();
+        }
+    }
+    else if ((store = dynamic_cast<StoreInstruction*>(instruction))) {
+        variables[store->getFromTop()] = stack.back();
+        stack.pop_back();
+        output.push_back(store);
+    }
+    else if ((loadConstant =
+              dynamic_cast<LoadConstantInstruction*>(instruction))) {
+        Value value = { true, loadConstant->getConstant(), output.size() };
+        output.push_back(loadConstant);
+        stack.push_back(value);
+    }
+    else if (dynamic_cast<DuplicateInstruction*>(instruction)) {
+        Value top = stack.back();
+        if (top.known) {
+            delete instruction;
+            pushConstant(top.constant);
+        }
+        else {
+            output.push_back(instruction);
+            pushUnknown();
+        }
+    }
+    else if (dynamic_cast<PopInstruction*>(instruction)) {
+        stack.pop_back();
+        output.push_back(instruction);
+    }
+    else if ((intrinsic = dynamic_cast<IntrinsicInstruction*>(instruction))) {
+        foldIntrinsic(intrinsic);
+    }
+    else if ((call = dynamic_cast<CallInstruction*>(instruction))) {
+        stack.resize(stack.size() - call->getTarget()->getArgumentCount());
+        output.push_back(call);
+        pushUnknown();
+    }
+}
+
+
+void ConstantFolder::foldIntrinsic(IntrinsicInstruction* instruction)
+{
+    Value right = stack.back();
+    stack.pop_back();
+    Value left = stack.back();
+    stack.pop_back();
+
+    Intrinsic operation = instruction->getIntrinsic();
+    bool isAdditive =
+            operation == INTEGER_ADD || operation == INTEGER_SUBTRACT;
+    bool isMultiplicative =
+            operation == INTEGER_MULTIPLY || operation == INTEGER_DIVIDE;
+
+    if (left.known && right.known &&
+        !(operation == INTEGER_DIVIDE && right.constant == 0)) {
+        removeProducer(left);
+        removeProducer(right);
+        delete instruction;
+        pushConstant(evaluateIntrinsic(operation, left.constant,
+                                       right.constant));
+    }
+    else if (right.known &&
+             ((isAdditive && right.constant == 0) ||
+              (isMultiplicative && right.constant == 1))) {
+        // the left operand is the result
+        removeProducer(right);
+        delete instruction;
+        stack.push_back(left);
+    }
+    else if (left.known &&
+             ((operation == INTEGER_ADD && left.constant == 0) ||
+              (operation == INTEGER_MULTIPLY && left.constant == 1))) {
+        // the right operand is the result
+        removeProducer(left);
+        delete instruction;
+        stack.push_back(right);
+    }
+    else if (operation == INTEGER_MULTIPLY &&
+             ((left.known && left.constant == 0) ||
+              (right.known && right.constant == 0))) {
+        // the other operand might have side effects, so it is only popped
+        removeProducer(left.known && left.constant == 0 ? left : right);
+        delete instruction;
+        output.push_back(new PopInstruction());
+        pushConstant(0);
+    }
+    else {
+        output.push_back(instruction);
+        pushUnknown();
+    }
+}
+
+
+void ConstantFolder::pushConstant(Word constant)
+{
+    Value value = { true, constant, output.size() };
+    output.push_back(new LoadConstantInstruction(constant));
+    stack.push_back(value);
+}
+
+
+void ConstantFolder::pushUnknown(void)
+{
+    Value value = { false, 0, 0 };
+    stack.push_back(value);
+}
+
+
+void ConstantFolder::removeProducer(const Value& value)
+{
+    delete output[value.producer];
+    output[value.producer] = 0;
+}
+
@@ -0,0 +1,110 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_CODE_CONSTANTFOLDER_H_
+#define UETLI_CODE_CONSTANTFOLDER_H_
+
+#include <vector>
+
+#include "StackMachine.h"
+
+namespace uetli
+{
+    namespace code
+    {
+        class ConstantFolder;
+    }
+}
+
+
+///
+/// \brief evaluates intrinsics on constant operands at compile time
+///
+/// The code of a subroutine is executed symbolically, keeping track of the
+/// values on the operation stack and in the variables which are known at
+/// compile time. Local variables start out as 0 and keep the constant last
+/// stored into them, so loading them is replaced by loading the constant.
+/// An intrinsic with two constant operands is replaced by its result, the
+/// instructions pushing the operands are removed.
+///
+/// Operations with a single constant operand are simplified if the result
+/// does not depend on it (x + 0, x - 0, 0 + x, x * 1, 1 * x and x / 1) or
+/// on the other operand (x * 0 and 0 * x, where x is still evaluated and
+/// popped). A division by zero is left for run time.
+///
+/// The code must be linked. Subroutines containing instructions whose
+/// stack effect is not known (unresolved calls and memory accesses) are
+/// left as they are.
+///
+class uetli::code::ConstantFolder
+{
+    struct Value
+    {
+        bool known;
+        Word constant;
+
+        /// the index of the load_const pushing the value in the output,
+        /// if the value is known
+        size_t producer;
+    };
+
+    /// the folded instructions, where removed ones are set to 0
+    std::vector<StackInstruction*> output;
+
+    std::vector<Value> stack;
+
+    /// the values of the variables, indexed from the top
+    std::vector<Value> variables;
+
+public:
+    ///
+    /// \brief fold the constants in the code of a subroutine
+    ///
+    /// Replaced instructions are deleted.
+    ///
+    void optimize(DirectSubroutine* subroutine);
+
+private:
+    ///
+    /// \return <code>true</code>, if the stack effect of every instruction
+    ///         is known
+    ///
+    static bool canFold(const DirectSubroutine* subroutine);
+
+    void fold(StackInstruction* instruction);
+    void foldIntrinsic(IntrinsicInstruction* instruction);
+
+    ///
+    /// \brief append a load_const and push its value
+    ///
+    void pushConstant(Word constant);
+    void pushUnknown(void);
+
+    ///
+    /// \brief delete the instruction which pushed a known value
+    ///
+    void removeProducer(const Value& value);
+};
+
+
+#endif // UETLI_CODE_CONSTANTFOLDER_H_
+
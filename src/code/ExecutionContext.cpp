@@ -0,0 +1,126 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+#include "ExecutionContext.h"
+
+#include <cstring>
+
+using uetli::code::ExecutionContext;
+using uetli::code::ExecutionException;
+
+
+ExecutionContext::ExecutionContext(size_t operandCapacity,
+                                   size_t variableCapacity,
+                                   size_t frameCapacity)
+{
+    operands = new Word[operandCapacity];
+    operandTop = operands;
+    operandEnd = operands + operandCapacity;
+
+    variables = new Word[variableCapacity];
+    variableTop = variables;
+    variableEnd = variables + variableCapacity;
+
+    frames = new Frame[frameCapacity];
+    frameTop = frames;
+    frameEnd = frames + frameCapacity;
+}
+
+
+ExecutionContext::~ExecutionContext(void)
+{
+    delete[] operands;
+    delete[] variables;
+    delete[] frames;
+}
+
+
+size_t ExecutionContext::getOperandCount(void) const
+{
+    return operandTop - operands;
+}
+
+
+size_t ExecutionContext::getVariableCount(void) const
+{
+    return variableTop - variables;
+}
+
+
+size_t ExecutionContext::getFrameCount(void) const
+{
+    return frameTop - frames;
+}
+
+
+void ExecutionContext::enterFrame(Word argumentCount, Word localVariableCount,
+                                  Word maxOperands, const Word* returnAddress)
+{
+    Word frameSize = argumentCount + localVariableCount;
+
+    if (getOperandCount() < argumentCount)
+        throw ExecutionException("operation stack underflow");
+
+    if (frameTop == frameEnd ||
+            Word(variableEnd - variableTop) < frameSize ||
+            Word(operandEnd - operandTop) + argumentCount < maxOperands)
+        throw ExecutionException("stack overflow");
+
+    operandTop -= argumentCount;
+
+    frameTop->operandBase = operandTop;
+    frameTop->variableBase = variableTop;
+    frameTop->returnAddress = returnAddress;
+    frameTop++;
+
+    ::memcpy(variableTop, operandTop, argumentCount * sizeof(Word));
+    ::memset(variableTop + argumentCount, 0, localVariableCount * sizeof(Word));
+    variableTop += frameSize;
+}
+
+
+const uetli::code::Word* ExecutionContext::leaveFrame(void)
+{
+    frameTop--;
+
+    Word result = 0;
+    if (operandTop > frameTop->operandBase)
+        result = top();
+
+    operandTop = frameTop->operandBase;
+    *operandTop++ = result;
+    variableTop = frameTop->variableBase;
+
+    return frameTop->returnAddress;
+}
+
+
+ExecutionException::ExecutionException(const std::string& errorMessage) :
+    errorMessage(errorMessage)
+{
+}
+
+
+const std::string& ExecutionException::getErrorMessage(void) const
+{
+    return errorMessage;
+}
+
@@ -0,0 +1,154 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+#ifndef UETLI_CODE_EXECUTIONCONTEXT_H_
+#define UETLI_CODE_EXECUTIONCONTEXT_H_
+
+#include <string>
+#include <cstddef>
+
+#include "StackMachine.h"
+
+namespace uetli
+{
+    namespace code
+    {
+        class ExecutionContext;
+        class ExecutionException;
+    }
+}
+
+
+///
+/// \brief holds the stacks a subroutine is executed on
+///
+/// All stacks are allocated once with a fixed capacity. Single pushes and
+/// pops are not checked; instead, enterFrame checks if the stacks can hold
+/// everything the subroutine might need before it is executed.
+///
+/// When a subroutine is entered, its arguments are moved from the operation
+/// stack to the bottom of a new variable frame, followed by its (zeroed)
+/// local variables. The topmost local variable has index 0 from top. When
+/// the subroutine returns, everything it left on the operation stack is
+/// removed and replaced by its result, which is the topmost value it left
+/// there (or 0, if it left nothing).
+///
+class uetli::code::ExecutionContext
+{
+public:
+    ///
+    /// \brief a subroutine call in progress
+    ///
+    struct Frame
+    {
+        /// the top of the operation stack after the arguments were removed
+        Word* operandBase;
+
+        /// the top of the variable stack before the frame was entered
+        Word* variableBase;
+
+        /// bytecode position to continue at when returning (only used by
+        /// the interpreter)
+        const Word* returnAddress;
+    };
+
+private:
+    Word* operands;
+    Word* operandTop;
+    Word* operandEnd;
+
+    Word* variables;
+    Word* variableTop;
+    Word* variableEnd;
+
+    Frame* frames;
+    Frame* frameTop;
+    Frame* frameEnd;
+
+public:
+    static const size_t defaultOperandCapacity = 1 << 20;
+    static const size_t defaultVariableCapacity = 1 << 20;
+    static const size_t defaultFrameCapacity = 1 << 16;
+
+    ExecutionContext(size_t operandCapacity = defaultOperandCapacity,
+                     size_t variableCapacity = defaultVariableCapacity,
+                     size_t frameCapacity = defaultFrameCapacity);
+    ~ExecutionContext(void);
+
+private:
+    ExecutionContext(const ExecutionContext&);
+    ExecutionContext& operator=(const ExecutionContext&);
+
+public:
+    inline void push(Word value);
+    inline Word pop(void);
+    inline Word& top(void);
+
+    ///
+    /// \param fromTop the index of the variable (where 0 is the topmost
+    ///                element on the variable stack)
+    ///
+    inline Word& variable(Word fromTop);
+
+    size_t getOperandCount(void) const;
+    size_t getVariableCount(void) const;
+    size_t getFrameCount(void) const;
+
+    ///
+    /// \brief set up the frame of a subroutine
+    ///
+    /// \param argumentCount number of values to move from the operation
+    ///                      stack into the new variable frame
+    /// \param localVariableCount number of local variables
+    /// \param maxOperands the maximum number of values the subroutine can
+    ///                    push on the operation stack
+    /// \param returnAddress stored in the frame to be returned by leaveFrame
+    ///
+    /// \throws ExecutionException if the stacks are too small
+    ///
+    void enterFrame(Word argumentCount, Word localVariableCount,
+                    Word maxOperands, const Word* returnAddress = 0);
+
+    ///
+    /// \brief remove the topmost frame and push the result
+    ///
+    /// \return the return address stored when entering the frame
+    ///
+    const Word* leaveFrame(void);
+};
+
+
+///
+/// \brief thrown if the executed code does something invalid
+///
+class uetli::code::ExecutionException
+{
+    std::string errorMessage;
+public:
+    ExecutionException(const std::string& errorMessage);
+    const std::string& getErrorMessage(void) const;
+};
+
+
+#include "ExecutionContext.inl"
+
+#endif // UETLI_CODE_EXECUTIONCONTEXT_H_
+
@@ -0,0 +1,45 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+inline void uetli::code::ExecutionContext::push(Word value)
+{
+    *operandTop++ = value;
+}
+
+
+inline uetli::code::Word uetli::code::ExecutionContext::pop(void)
+{
+    return *--operandTop;
+}
+
+
+inline uetli::code::Word& uetli::code::ExecutionContext::top(void)
+{
+    return operandTop[-1];
+}
+
+
+inline uetli::code::Word& uetli::code::ExecutionContext::variable(Word fromTop)
+{
+    return variableTop[-1 - (long) fromTop];
+}
+
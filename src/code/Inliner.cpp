@@ -0,0 +1,306 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "Inliner.h"
+
+using namespace uetli::code;
+
+
+///
+/// \brief determine how an instruction affects the operation stack
+///
+/// \param uses the number of values read from the top of the stack
+/// \param pushes the number of values pushed after removing the read ones
+///               (values which are left count as pushed again)
+/// \return <code>false</code>, if the instruction is not known
+///
+static bool getStackEffect(const StackInstruction* instruction, size_t& uses,
+                           size_t& pushes)
+{
+    const CallInstruction* call = 0;
+
+    if (dynamic_cast<const LoadInstruction*>(instruction) ||
+        dynamic_cast<const LoadConstantInstruction*>(instruction)) {
+        uses = 0;
+        pushes = 1;
+    }
+    else if (dynamic_cast<const StoreInstruction*>(instruction) ||
+             dynamic_cast<const PopInstruction*>(instruction)) {
+        uses = 1;
+        pushes = 0;
+    }
+    else if (dynamic_cast<const DereferenceInstruction*>(instruction) ||
+             dynamic_cast<const AllocateInstruction*>(instruction)) {
+        uses = 1;
+        pushes = 1;
+    }
+    else if (dynamic_cast<const DuplicateInstruction*>(instruction)) {
+        uses = 1;
+        pushes = 2;
+    }
+    else if (dynamic_cast<const PrintInstruction*>(instruction)) {
+        // the printed value stays on the stack
+        uses = 1;
+        pushes = 1;
+    }
+    else if (dynamic_cast<const DereferenceStoreInstruction*>(instruction)) {
+        // the pointer stays on the stack
+        uses = 2;
+        pushes = 1;
+    }
+    else if (dynamic_cast<const IntrinsicInstruction*>(instruction)) {
+        uses = 2;
+        pushes = 1;
+    }
+    else if ((call = dynamic_cast<const CallInstruction*>(instruction))) {
+        uses = call->getSubroutine()->getArgumentCount();
+        pushes = 1;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+
+Inliner::Inliner(size_t sizeLimit) :
+    sizeLimit(sizeLimit)
+{
+}
+
+
+Inliner::~Inliner(void)
+{
+    for (size_t i = 0; i < ownedBodies.size(); i++) {
+        for (size_t j = 0; j < ownedBodies[i]->instructions.size(); j++) {
+            delete ownedBodies[i]->instructions[j];
+        }
+        delete ownedBodies[i];
+    }
+}
+
+
+void Inliner::addCallees(const std::vector<DirectSubroutine*>& subroutines)
+{
+    for (size_t i = 0; i < subroutines.size(); i++) {
+        const std::vector<StackInstruction*>& instructions =
+                subroutines[i]->getInstructions();
+
+        for (size_t j = 0; j < instructions.size(); j++) {
+            const CallInstruction* call =
+                    dynamic_cast<const CallInstruction*>(instructions[j]);
+            if (call == 0 || call->getTarget() == 0 ||
+                bodies.getReference(call->getTarget()) != 0)
+                continue;
+
+            Body* body = createBody(call->getTarget());
+            bodies.put(call->getTarget(), body);
+            if (body != 0)
+                ownedBodies.push_back(body);
+        }
+    }
+}
+
+
+void Inliner::inlineCalls(DirectSubroutine* subroutine) const
+{
+    std::vector<StackInstruction*>& instructions =
+            subroutine->getInstructions();
+
+    // the slots of the largest inlined frame
+    bool inlining = false;
+    Word frameSize = 0;
+    for (size_t i = 0; i < instructions.size(); i++) {
+        const Body* body = getInlinedBody(subroutine, instructions[i]);
+        if (body == 0)
+            continue;
+
+        Word size = body->argumentCount + body->localVariableCount +
+                (body->resultCount > 1 ? 1 : 0);
+        if (size > frameSize)
+            frameSize = size;
+        inlining = true;
+    }
+    if (!inlining)
+        return;
+
+    std::vector<StackInstruction*> output;
+    for (size_t i = 0; i < instructions.size(); i++) {
+        StackInstruction* instruction = instructions[i];
+        const Body* body = getInlinedBody(subroutine, instruction);
+
+        if (body != 0) {
+            appendBody(*body, output);
+            delete instruction;
+        }
+        else if (dynamic_cast<const LoadInstruction*>(instruction) ||
+                 dynamic_cast<const StoreInstruction*>(instruction)) {
+            output.push_back(copyInstruction(instruction, frameSize));
+            delete instruction;
+        }
+        else {
+            output.push_back(instruction);
+        }
+    }
+
+    instructions.swap(output);
+    subroutine->setLocalVariableCount(subroutine->getLocalVariableCount() +
+                                      frameSize);
+}
+
+
+Inliner::Body* Inliner::createBody(const DirectSubroutine* callee) const
+{
+    const std::vector<StackInstruction*>& instructions =
+            callee->getInstructions();
+    if (instructions.size() > sizeLimit)
+        return 0;
+
+    Body* body = new Body();
+    body->localVariableCount = callee->getLocalVariableCount();
+    body->argumentCount = callee->getArgumentCount();
+
+    // the callee must not read values below its own ones
+    size_t depth = 0;
+    for (size_t i = 0; i < instructions.size(); i++) {
+        size_t uses = 0;
+        size_t pushes = 0;
+        StackInstruction* copy = 0;
+        if (getStackEffect(instructions[i], uses, pushes) && uses <= depth)
+            copy = copyInstruction(instructions[i], 0);
+
+        if (copy == 0) {
+            for (size_t j = 0; j < body->instructions.size(); j++) {
+                delete body->instructions[j];
+            }
+            delete body;
+            return 0;
+        }
+
+        body->instructions.push_back(copy);
+        depth = depth - uses + pushes;
+    }
+
+    body->resultCount = depth;
+    return body;
+}
+
+
+const Inliner::Body* Inliner::getInlinedBody(
+        const DirectSubroutine* caller,
+        const StackInstruction* instruction) const
+{
+    const CallInstruction* call =
+            dynamic_cast<const CallInstruction*>(instruction);
+    if (call == 0 || call->getTarget() == 0 || call->getTarget() == caller)
+        return 0;
+
+    Body* const* body = bodies.getReference(call->getTarget());
+    return body != 0 ? *body : 0;
+}
+
+
+void Inliner::appendBody(const Body& body,
+                         std::vector<StackInstruction*>& output)
+{
+    // the last argument is on top of the operation stack
+    for (size_t i = 0; i < body.argumentCount; i++) {
+        output.push_back(new StoreInstruction(body.localVariableCount + i));
+    }
+    for (Word i = 0; i < body.localVariableCount; i++) {
+        output.push_back(new LoadConstantInstruction(0));
+        output.push_back(new StoreInstruction(i));
+    }
+
+    for (size_t i = 0; i < body.instructions.size(); i++) {
+        output.push_back(copyInstruction(body.instructions[i], 0));
+    }
+
+    // leave exactly the result on the operation stack
+    if (body.resultCount == 0) {
+        output.push_back(new LoadConstantInstruction(0));
+    }
+    else if (body.resultCount > 1) {
+        Word result = body.argumentCount + body.localVariableCount;
+        output.push_back(new StoreInstruction(result));
+        for (size_t i = 1; i < body.resultCount; i++) {
+            output.push_back(new PopInstruction());
+        }
+        output.push_back(new LoadInstruction(result));
+    }
+}
+
+
+StackInstruction* Inliner::copyInstruction(
+        const StackInstruction* instruction, Word offset)
+{
+    const LoadInstruction* load = 0;
+    const StoreInstruction* store = 0;
+    const DereferenceInstruction* dereference = 0;
+    const DereferenceStoreInstruction* dereferenceStore = 0;
+    const CallInstruction* call = 0;
+    const LoadConstantInstruction* loadConstant = 0;
+    const IntrinsicInstruction* intrinsic = 0;
+
+    if ((load = dynamic_cast<const LoadInstruction*>(instruction))) {
+        return new LoadInstruction(load->getFromTop() + offset);
+    }
+    else if ((store = dynamic_cast<const StoreInstruction*>(instruction))) {
+        return new StoreInstruction(store->getFromTop() + offset);
+    }
+    else if ((dereference =
+              dynamic_cast<const DereferenceInstruction*>(instruction))) {
+        return new DereferenceInstruction(dereference->getOffset());
+    }
+    else if ((dereferenceStore =
+              dynamic_cast<const DereferenceStoreInstruction*>(instruction))) {
+        return new DereferenceStoreInstruction(dereferenceStore->getOffset());
+    }
+    else if (dynamic_cast<const PopInstruction*>(instruction)) {
+        return new PopInstruction();
+    }
+    else if ((call = dynamic_cast<const CallInstruction*>(instruction))) {
+        // unresolved calls own their link, which is not copied
+        if (call->getTarget() == 0)
+            return 0;
+        return new CallInstruction(call->getTarget());
+    }
+    else if ((loadConstant =
+              dynamic_cast<const LoadConstantInstruction*>(instruction))) {
+        return new LoadConstantInstruction(loadConstant->getConstant());
+    }
+    else if (dynamic_cast<const AllocateInstruction*>(instruction)) {
+        return new AllocateInstruction();
+    }
+    else if (dynamic_cast<const DuplicateInstruction*>(instruction)) {
+        return new DuplicateInstruction();
+    }
+    else if (dynamic_cast<const PrintInstruction*>(instruction)) {
+        return new PrintInstruction();
+    }
+    else if ((intrinsic =
+              dynamic_cast<const IntrinsicInstruction*>(instruction))) {
+        return new IntrinsicInstruction(intrinsic->getIntrinsic());
+    }
+    return 0;
+}
+
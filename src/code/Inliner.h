@@ -0,0 +1,146 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_CODE_INLINER_H_
+#define UETLI_CODE_INLINER_H_
+
+#include <vector>
+
+#include "StackMachine.h"
+#include "../util/HashMap.h"
+
+namespace uetli
+{
+    namespace code
+    {
+        class Inliner;
+    }
+}
+
+
+///
+/// \brief replaces calls to small subroutines by their code
+///
+/// The frame of an inlined subroutine is placed on top of the local
+/// variables of the caller. All calls inlined into one caller share these
+/// slots, since the code is straight-line and they are used one after the
+/// other:
+///
+/// - The arguments are stored from the operation stack into their slots,
+///   and the local variables of the callee are set to 0.
+///
+/// - The code of the callee follows, with its variables still counted from
+///   the top. The variables of the caller move down by the size of the
+///   largest inlined frame.
+///
+/// - The result of the callee is the topmost value it leaves on the
+///   operation stack, or 0 if it leaves none. Other values left by it are
+///   removed, using one more slot.
+///
+/// Only the bodies of the callees are inlined, calls inside of them are
+/// left as they are. Recursive calls of a subroutine to itself are never
+/// inlined.
+///
+class uetli::code::Inliner
+{
+    struct Body
+    {
+        /// copies of the instructions of the callee
+        std::vector<StackInstruction*> instructions;
+
+        Word localVariableCount;
+        size_t argumentCount;
+
+        /// number of values the code leaves on the operation stack
+        size_t resultCount;
+    };
+
+    /// the maximum number of instructions of an inlined subroutine
+    size_t sizeLimit;
+
+    /// the body of every callee which has been considered or 0, if it can
+    /// not be inlined
+    util::HashMap<const DirectSubroutine*, Body*> bodies;
+    std::vector<Body*> ownedBodies;
+
+public:
+    ///
+    /// \param sizeLimit the maximum number of instructions of a subroutine
+    ///                  which is inlined
+    ///
+    Inliner(size_t sizeLimit);
+    ~Inliner(void);
+
+private:
+    Inliner(const Inliner&);
+    Inliner& operator=(const Inliner&);
+
+public:
+    ///
+    /// \brief copy the code of all small subroutines called by the given
+    ///        ones
+    ///
+    /// The copies are taken before any caller is changed, so the calls
+    /// can be inlined concurrently afterwards, even into callees.
+    ///
+    void addCallees(const std::vector<DirectSubroutine*>& subroutines);
+
+    ///
+    /// \brief inline the calls to the added callees
+    ///
+    /// The replaced instructions are deleted.
+    ///
+    void inlineCalls(DirectSubroutine* subroutine) const;
+
+private:
+    ///
+    /// \return the copy of the code of the callee or 0, if it is too large
+    ///         or can not be inlined
+    ///
+    Body* createBody(const DirectSubroutine* callee) const;
+
+    ///
+    /// \return the body to inline in place of the instruction or 0, if it
+    ///         is not an inlined call
+    ///
+    const Body* getInlinedBody(const DirectSubroutine* caller,
+                               const StackInstruction* instruction) const;
+
+    ///
+    /// \brief append the instructions replacing a call
+    ///
+    static void appendBody(const Body& body,
+                           std::vector<StackInstruction*>& output);
+
+    ///
+    /// \brief copy an instruction, moving the variables it accesses
+    ///
+    /// \param offset the number added to the index of the variables
+    /// \return the copy or 0, if the instruction can not be copied
+    ///
+    static StackInstruction* copyInstruction(
+            const StackInstruction* instruction, Word offset);
+};
+
+
+#endif // UETLI_CODE_INLINER_H_
+
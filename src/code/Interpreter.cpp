@@ -0,0 +1,186 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+#include "Interpreter.h"
+
+#include <iostream>
+
+using namespace uetli::code;
+
+
+// labels as values are a GNU extension (also supported by clang)
+#if defined(__GNUC__)
+#   define UETLI_THREADED_DISPATCH
+#endif
+
+#ifdef UETLI_THREADED_DISPATCH
+#   define INSTRUCTION(name) label_##name:
+#   define DISPATCH() goto *dispatchTable[*ip++]
+#else
+#   define INSTRUCTION(name) case name:
+#   define DISPATCH() break
+#endif
+
+
+Interpreter::Interpreter(void)
+{
+}
+
+
+void Interpreter::execute(const BytecodeSubroutine* subroutine,
+                          ExecutionContext& context) const
+{
+    // frame count at which the outermost subroutine returns
+    size_t entryFrames = context.getFrameCount();
+
+    const Word* ip = subroutine->getCode();
+    context.enterFrame(subroutine->getArgumentCount(),
+                       subroutine->getLocalVariableCount(),
+                       subroutine->getMaxOperands());
+
+#ifdef UETLI_THREADED_DISPATCH
+    static const void* const dispatchTable[opcodes_count] = {
+        &&label_OP_LOAD,
+        &&label_OP_STORE,
+        &&label_OP_DEREFERENCE,
+        &&label_OP_DEREFERENCE_STORE,
+        &&label_OP_POP,
+        &&label_OP_CALL,
+        &&label_OP_LOAD_CONSTANT,
+        &&label_OP_ALLOCATE,
+        &&label_OP_DUPLICATE,
+        &&label_OP_PRINT,
+        &&label_OP_RETURN,
+        &&label_OP_INTEGER_ADD,
+        &&label_OP_INTEGER_SUBTRACT,
+        &&label_OP_INTEGER_MULTIPLY,
+        &&label_OP_INTEGER_DIVIDE,
+    };
+
+    DISPATCH();
+    {
+#else
+    for (;;) {
+        switch (*ip++) {
+#endif
+
+    INSTRUCTION(OP_LOAD) {
+        Word fromTop = *ip++;
+        context.push(context.variable(fromTop));
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_STORE) {
+        Word fromTop = *ip++;
+        context.variable(fromTop) = context.pop();
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_DEREFERENCE) {
+        Word offset = *ip++;
+        Word* pointer = reinterpret_cast<Word*>(context.top() + offset);
+        context.push(*pointer);
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_DEREFERENCE_STORE) {
+        Word offset = *ip++;
+        Word value = context.pop();
+        Word* pointer = reinterpret_cast<Word*>(context.top() + offset);
+        *pointer = value;
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_POP) {
+        context.pop();
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_CALL) {
+        const BytecodeSubroutine* callee =
+                reinterpret_cast<const BytecodeSubroutine*>(*ip++);
+        context.enterFrame(callee->getArgumentCount(),
+                           callee->getLocalVariableCount(),
+                           callee->getMaxOperands(), ip);
+        ip = callee->getCode();
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_LOAD_CONSTANT) {
+        context.push(*ip++);
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_ALLOCATE) {
+        Word size = context.top();
+        context.top() = reinterpret_cast<Word>(new char[size]);
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_DUPLICATE) {
+        context.push(context.top());
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_PRINT) {
+        std::cout << reinterpret_cast<void*>(context.top()) << std::endl;
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_RETURN) {
+        ip = context.leaveFrame();
+        if (context.getFrameCount() == entryFrames)
+            return;
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_INTEGER_ADD) {
+        Word right = context.pop();
+        context.top() += right;
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_INTEGER_SUBTRACT) {
+        Word right = context.pop();
+        context.top() -= right;
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_INTEGER_MULTIPLY) {
+        Word right = context.pop();
+        context.top() *= right;
+        DISPATCH();
+    }
+
+    INSTRUCTION(OP_INTEGER_DIVIDE) {
+        Word right = context.pop();
+        context.top() = evaluateIntrinsic(INTEGER_DIVIDE, context.top(), right);
+        DISPATCH();
+    }
+
+#ifndef UETLI_THREADED_DISPATCH
+        default:
+            throw "invalid bytecode";
+        }
+#endif
+    }
+}
+
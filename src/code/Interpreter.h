@@ -0,0 +1,68 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+#ifndef UETLI_CODE_INTERPRETER_H_
+#define UETLI_CODE_INTERPRETER_H_
+
+#include "Bytecode.h"
+#include "ExecutionContext.h"
+
+namespace uetli
+{
+    namespace code
+    {
+        class Interpreter;
+    }
+}
+
+
+///
+/// \brief executes bytecode
+///
+/// The interpreter behaves exactly like DirectSubroutine::execute, but
+/// operates on the flat bytecode. If the compiler supports it, the
+/// instructions are dispatched using computed gotos (threaded code),
+/// otherwise a switch statement is used.
+///
+/// Calls do not recurse on the native stack; the return addresses are kept
+/// in the frames of the execution context instead.
+///
+class uetli::code::Interpreter
+{
+public:
+    Interpreter(void);
+
+    ///
+    /// \brief execute a subroutine
+    ///
+    /// The arguments of the subroutine are taken from the operation stack of
+    /// the context. When the subroutine returns, its result is pushed there.
+    ///
+    /// \param subroutine the subroutine to execute
+    /// \param context the stacks to operate on
+    ///
+    void execute(const BytecodeSubroutine* subroutine,
+                 ExecutionContext& context) const;
+};
+
+
+#endif // UETLI_CODE_INTERPRETER_H_
+
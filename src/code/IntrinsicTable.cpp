@@ -0,0 +1,43 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+#include "IntrinsicTable.h"
+
+using uetli::code::IntrinsicTable;
+using uetli::code::Intrinsic;
+
+
+IntrinsicTable::IntrinsicTable(void)
+{
+}
+
+
+void IntrinsicTable::add(const parser::Identifier& method, Intrinsic intrinsic)
+{
+    intrinsics.put(method.getAsString(), intrinsic);
+}
+
+
+const Intrinsic* IntrinsicTable::find(const parser::Identifier& method) const
+{
+    return intrinsics.getReference(method.getAsString());
+}
+
@@ -0,0 +1,70 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+#ifndef UETLI_CODE_INTRINSICTABLE_H_
+#define UETLI_CODE_INTRINSICTABLE_H_
+
+#include <string>
+
+#include "StackMachine.h"
+#include "../util/HashMap.h"
+#include "../parser/Identifier.h"
+
+namespace uetli
+{
+    namespace code
+    {
+        class IntrinsicTable;
+    }
+}
+
+
+///
+/// \brief links the names of native methods to intrinsics
+///
+/// Calls to a method found in this table can be replaced by an
+/// IntrinsicInstruction.
+///
+class uetli::code::IntrinsicTable
+{
+    util::HashMap<std::string, Intrinsic> intrinsics;
+
+public:
+    IntrinsicTable(void);
+
+    ///
+    /// \brief register an intrinsic
+    ///
+    /// \param method the full identifier of the native method
+    /// \param intrinsic the operation which implements the method
+    ///
+    void add(const parser::Identifier& method, Intrinsic intrinsic);
+
+    ///
+    /// \param method the full identifier of a method
+    /// \return the intrinsic implementing the method or 0 if there is none
+    ///
+    const Intrinsic* find(const parser::Identifier& method) const;
+};
+
+
+#endif // UETLI_CODE_INTRINSICTABLE_H_
+
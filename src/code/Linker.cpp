@@ -0,0 +1,99 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "Linker.h"
+
+using namespace uetli::code;
+
+
+Linker::Linker(const IntrinsicTable* intrinsics) :
+    intrinsics(intrinsics),
+    unresolvedCount(0)
+{
+}
+
+
+void Linker::addSubroutine(DirectSubroutine* subroutine)
+{
+    subroutines.push_back(subroutine);
+
+    // the first subroutine added under a name is kept
+    const std::string& symbol = subroutine->getName().getAsString();
+    if (symbols.getReference(symbol) == 0)
+        symbols.put(symbol, subroutine);
+}
+
+
+void Linker::link(void)
+{
+    unresolvedCount = 0;
+    for (size_t i = 0; i < subroutines.size(); i++) {
+        link(subroutines[i]);
+    }
+}
+
+
+DirectSubroutine* Linker::find(const parser::Identifier& name) const
+{
+    DirectSubroutine* const* subroutine =
+            symbols.getReference(name.getAsString());
+    return subroutine != 0 ? *subroutine : 0;
+}
+
+
+size_t Linker::getUnresolvedCount(void) const
+{
+    return unresolvedCount;
+}
+
+
+void Linker::link(DirectSubroutine* subroutine)
+{
+    std::vector<StackInstruction*>& instructions =
+            subroutine->getInstructions();
+
+    for (size_t i = 0; i < instructions.size(); i++) {
+        CallInstruction* call = dynamic_cast<CallInstruction*>(instructions[i]);
+        if (call == 0 || call->getTarget() != 0)
+            continue;
+
+        const Subroutine* link = call->getSubroutine();
+        const Intrinsic* intrinsic = intrinsics != 0 ?
+                intrinsics->find(link->getName()) : 0;
+
+        if (intrinsic != 0) {
+            instructions[i] = new IntrinsicInstruction(*intrinsic);
+            delete call;
+        }
+        else {
+            DirectSubroutine* target = find(link->getName());
+            if (target == 0) {
+                unresolvedCount++;
+                continue;
+            }
+            call->resolve(target);
+        }
+
+        delete link;
+    }
+}
+
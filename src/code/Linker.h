@@ -0,0 +1,104 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_CODE_LINKER_H_
+#define UETLI_CODE_LINKER_H_
+
+#include <string>
+#include <vector>
+
+#include "StackMachine.h"
+#include "IntrinsicTable.h"
+#include "../util/HashMap.h"
+
+namespace uetli
+{
+    namespace code
+    {
+        class Linker;
+    }
+}
+
+
+///
+/// \brief resolves the calls between the generated subroutines
+///
+/// The code generator emits a SubroutineLink for every call, which only
+/// contains the name of the called method. The linker looks up all these names
+/// once, after all subroutines have been generated, and lets each call point
+/// directly to the called DirectSubroutine, so nothing has to be looked up or
+/// cast while the code is executed.
+///
+/// Calls to methods implemented by an intrinsic are replaced by an
+/// IntrinsicInstruction. Calls to methods which are not defined in any of the
+/// added subroutines are left unresolved (they might be defined externally).
+///
+class uetli::code::Linker
+{
+    /// the added subroutines, indexed by the string of their full identifier
+    util::HashMap<std::string, DirectSubroutine*> symbols;
+    std::vector<DirectSubroutine*> subroutines;
+
+    const IntrinsicTable* intrinsics;
+
+    size_t unresolvedCount;
+
+public:
+    ///
+    /// \param intrinsics if specified, calls to the methods in this table
+    ///                   are replaced by the corresponding intrinsics
+    ///
+    Linker(const IntrinsicTable* intrinsics = 0);
+
+    ///
+    /// \brief add a subroutine to the symbol table
+    ///
+    /// The calls in the subroutine are resolved by the next call to link().
+    ///
+    void addSubroutine(DirectSubroutine* subroutine);
+
+    ///
+    /// \brief resolve the calls in all added subroutines
+    ///
+    /// Resolved links are deleted.
+    ///
+    void link(void);
+
+    ///
+    /// \param name the full identifier of a method
+    /// \return the subroutine implementing the method or 0 if there is none
+    ///
+    DirectSubroutine* find(const parser::Identifier& name) const;
+
+    ///
+    /// \return the number of calls which could not be resolved by the last
+    ///         call to link()
+    ///
+    size_t getUnresolvedCount(void) const;
+
+private:
+    void link(DirectSubroutine* subroutine);
+};
+
+
+#endif // UETLI_CODE_LINKER_H_
+
@@ -0,0 +1,99 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "Optimizer.h"
+#include "ConstantFolder.h"
+#include "Inliner.h"
+#include "PeepholeOptimizer.h"
+#include "SlotAllocator.h"
+#include "../util/ThreadPool.h"
+#include "../util/Trace.h"
+
+using namespace uetli::code;
+
+
+namespace
+{
+    ///
+    /// \brief optimizes one subroutine per iteration
+    ///
+    class OptimizerLoop : public uetli::util::ThreadPool::Loop
+    {
+        const std::vector<DirectSubroutine*>& subroutines;
+        const Inliner& inliner;
+    public:
+        OptimizerLoop(const std::vector<DirectSubroutine*>& subroutines,
+                      const Inliner& inliner);
+
+        virtual void run(size_t index);
+    };
+}
+
+
+OptimizerLoop::OptimizerLoop(
+        const std::vector<DirectSubroutine*>& subroutines,
+        const Inliner& inliner) :
+    subroutines(subroutines), inliner(inliner)
+{
+}
+
+
+void OptimizerLoop::run(size_t index)
+{
+    DirectSubroutine* subroutine = subroutines[index];
+
+    uetli::util::TraceSpan span("optimize");
+    if (span.isRecording())
+        span.setName(subroutine->getName().getAsString());
+
+    inliner.inlineCalls(subroutine);
+
+    ConstantFolder folder;
+    folder.optimize(subroutine);
+
+    SlotAllocator slotAllocator;
+    slotAllocator.optimize(subroutine);
+
+    // folding and removing dead stores leave values which are only popped
+    PeepholeOptimizer peephole;
+    peephole.optimize(subroutine);
+}
+
+
+void uetli::code::optimizeCode(
+        const std::vector<DirectSubroutine*>& subroutines,
+        unsigned int level, size_t inlineLimit, size_t threadCount)
+{
+    if (level == 0)
+        return;
+
+    util::TraceSpan span("optimization");
+
+    // the callees are copied before any of the subroutines is changed
+    Inliner inliner(inlineLimit);
+    if (level >= inliningLevel)
+        inliner.addCallees(subroutines);
+
+    OptimizerLoop loop(subroutines, inliner);
+    util::ThreadPool::forEach(loop, subroutines.size(), threadCount);
+}
+
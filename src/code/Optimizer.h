@@ -0,0 +1,71 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_CODE_OPTIMIZER_H_
+#define UETLI_CODE_OPTIMIZER_H_
+
+#include <vector>
+
+#include "StackMachine.h"
+
+namespace uetli
+{
+    namespace code
+    {
+        ///
+        /// \brief the optimization level used if none is specified
+        ///
+        const unsigned int defaultOptimizationLevel = 1;
+
+        ///
+        /// \brief the lowest optimization level inlining small subroutines
+        ///
+        const unsigned int inliningLevel = 2;
+
+        ///
+        /// \brief the maximum number of instructions of an inlined
+        ///        subroutine used if none is specified
+        ///
+        const size_t defaultInlineLimit = 16;
+
+        ///
+        /// \brief optimize the code of several subroutines concurrently
+        ///
+        /// The subroutines have to be linked already. Only the code of the
+        /// given subroutines is changed. From the inlining level on, the
+        /// code of the small subroutines they call is inlined first, so
+        /// the other optimizations see through these calls.
+        ///
+        /// \param level the optimization level; 0 leaves the code as it is
+        /// \param inlineLimit the maximum number of instructions of an
+        ///                    inlined subroutine
+        /// \param threadCount the maximum number of threads used
+        ///
+        void optimizeCode(const std::vector<DirectSubroutine*>& subroutines,
+                          unsigned int level, size_t inlineLimit,
+                          size_t threadCount);
+    }
+}
+
+
+#endif // UETLI_CODE_OPTIMIZER_H_
+
@@ -0,0 +1,142 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "PeepholeOptimizer.h"
+
+using namespace uetli::code;
+
+
+///
+/// \return <code>true</code>, if the instruction only pushes a value without
+///         any other effect
+///
+static bool isPurePush(const StackInstruction* instruction)
+{
+    return dynamic_cast<const LoadInstruction*>(instruction) != 0 ||
+           dynamic_cast<const LoadConstantInstruction*>(instruction) != 0 ||
+           dynamic_cast<const DuplicateInstruction*>(instruction) != 0;
+}
+
+
+void PeepholeOptimizer::optimize(DirectSubroutine* subroutine)
+{
+    std::vector<StackInstruction*>& instructions =
+            subroutine->getInstructions();
+
+    output.clear();
+    output.reserve(instructions.size());
+    for (size_t i = 0; i < instructions.size(); i++) {
+        output.push_back(instructions[i]);
+        while (rewriteEnd()) {
+        }
+    }
+
+    instructions.swap(output);
+    output.clear();
+}
+
+
+bool PeepholeOptimizer::rewriteEnd(void)
+{
+    StackInstruction* last = getFromEnd(0);
+    StackInstruction* previous = getFromEnd(1);
+    if (previous == 0)
+        return false;
+
+    const LoadInstruction* load = dynamic_cast<LoadInstruction*>(last);
+    const StoreInstruction* store = dynamic_cast<StoreInstruction*>(last);
+    const LoadInstruction* previousLoad =
+            dynamic_cast<LoadInstruction*>(previous);
+    const StoreInstruction* previousStore =
+            dynamic_cast<StoreInstruction*>(previous);
+
+    // load n; store n
+    if (store != 0 && previousLoad != 0 &&
+        previousLoad->getFromTop() == store->getFromTop()) {
+        removeFromEnd(2);
+        return true;
+    }
+
+    // load n; pop, load_const c; pop and dup; pop
+    if (dynamic_cast<PopInstruction*>(last) != 0 && isPurePush(previous)) {
+        removeFromEnd(2);
+        return true;
+    }
+
+    // store n; load n
+    if (load != 0 && previousStore != 0 &&
+        previousStore->getFromTop() == load->getFromTop()) {
+        const LoadConstantInstruction* constant =
+                dynamic_cast<LoadConstantInstruction*>(getFromEnd(2));
+        if (constant != 0) {
+            // the constant is cheaper to repeat than to copy
+            removeFromEnd(1);
+            output.push_back(
+                    new LoadConstantInstruction(constant->getConstant()));
+        }
+        else {
+            removeFromEnd(1);
+            output.back() = new DuplicateInstruction();
+            output.push_back(previous);
+        }
+        return true;
+    }
+
+    // dup; store n; pop
+    if (dynamic_cast<PopInstruction*>(last) != 0 && previousStore != 0 &&
+        dynamic_cast<DuplicateInstruction*>(getFromEnd(2)) != 0) {
+        output.pop_back();
+        output.pop_back();
+        removeFromEnd(1);
+        output.push_back(previous);
+        delete last;
+        return true;
+    }
+
+    // load n; load n
+    if (load != 0 && previousLoad != 0 &&
+        previousLoad->getFromTop() == load->getFromTop()) {
+        removeFromEnd(1);
+        output.push_back(new DuplicateInstruction());
+        return true;
+    }
+
+    return false;
+}
+
+
+StackInstruction* PeepholeOptimizer::getFromEnd(size_t fromEnd) const
+{
+    if (fromEnd >= output.size())
+        return 0;
+    return output[output.size() - 1 - fromEnd];
+}
+
+
+void PeepholeOptimizer::removeFromEnd(size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        delete output.back();
+        output.pop_back();
+    }
+}
+
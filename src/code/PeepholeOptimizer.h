@@ -0,0 +1,96 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_CODE_PEEPHOLEOPTIMIZER_H_
+#define UETLI_CODE_PEEPHOLEOPTIMIZER_H_
+
+#include <vector>
+
+#include "StackMachine.h"
+
+namespace uetli
+{
+    namespace code
+    {
+        class PeepholeOptimizer;
+    }
+}
+
+
+///
+/// \brief removes redundant instruction sequences from the stack code
+///
+/// The instructions are copied one by one into the output. After every
+/// instruction, the end of the output is matched against the following
+/// patterns until none of them applies, so a rewrite can enable the next:
+///
+/// <pre>
+/// load n; store n          -> (nothing)
+/// load n; pop              -> (nothing)
+/// load_const c; pop        -> (nothing)
+/// dup; pop                 -> (nothing)
+/// load_const c; store n;
+///     load n               -> load_const c; store n; load_const c
+/// store n; load n          -> dup; store n
+/// dup; store n; pop        -> store n
+/// load n; load n           -> load n; dup
+/// </pre>
+///
+/// None of the patterns changes the values left on the operation stack or
+/// in the variables, so the result of the subroutine stays the same.
+///
+class uetli::code::PeepholeOptimizer
+{
+    /// the optimized instructions
+    std::vector<StackInstruction*> output;
+
+public:
+    ///
+    /// \brief rewrite the instructions of a subroutine
+    ///
+    /// Removed instructions are deleted.
+    ///
+    void optimize(DirectSubroutine* subroutine);
+
+private:
+    ///
+    /// \brief apply the first matching pattern to the end of the output
+    ///
+    /// \return <code>false</code>, if no pattern matched
+    ///
+    bool rewriteEnd(void);
+
+    ///
+    /// \param fromEnd the position counted from the last instruction (0)
+    /// \return the instruction or 0 if the output is too short
+    ///
+    StackInstruction* getFromEnd(size_t fromEnd) const;
+
+    ///
+    /// \brief delete the last instructions of the output
+    ///
+    void removeFromEnd(size_t count);
+};
+
+
+#endif // UETLI_CODE_PEEPHOLEOPTIMIZER_H_
+
@@ -0,0 +1,159 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "SlotAllocator.h"
+
+#include <algorithm>
+
+using namespace uetli::code;
+
+
+bool SlotAllocator::LiveRange::operator < (const LiveRange& other) const
+{
+    return start < other.start;
+}
+
+
+void SlotAllocator::optimize(DirectSubroutine* subroutine)
+{
+    removeDeadStores(subroutine);
+    compactSlots(subroutine);
+}
+
+
+void SlotAllocator::removeDeadStores(DirectSubroutine* subroutine)
+{
+    std::vector<StackInstruction*>& instructions =
+            subroutine->getInstructions();
+
+    // nothing is live after the subroutine returns
+    std::vector<bool> live(subroutine->getLocalVariableCount() +
+                           subroutine->getArgumentCount(), false);
+
+    for (size_t i = instructions.size(); i > 0; i--) {
+        StackInstruction* instruction = instructions[i - 1];
+        const LoadInstruction* load =
+                dynamic_cast<const LoadInstruction*>(instruction);
+        const StoreInstruction* store =
+                dynamic_cast<const StoreInstruction*>(instruction);
+
+        if (load != 0) {
+            live[load->getFromTop()] = true;
+        }
+        else if (store != 0) {
+            Word fromTop = store->getFromTop();
+            if (!live[fromTop]) {
+                // the value still has to be removed from the stack
+                instructions[i - 1] = new PopInstruction();
+                delete instruction;
+            }
+            live[fromTop] = false;
+        }
+    }
+}
+
+
+void SlotAllocator::compactSlots(DirectSubroutine* subroutine)
+{
+    std::vector<StackInstruction*>& instructions =
+            subroutine->getInstructions();
+    Word localCount = subroutine->getLocalVariableCount();
+
+    const long unused = -2;
+    std::vector<LiveRange> ranges(localCount);
+    for (Word i = 0; i < localCount; i++) {
+        ranges[i].start = unused;
+        ranges[i].end = unused;
+        ranges[i].variable = i;
+    }
+
+    for (size_t i = 0; i < instructions.size(); i++) {
+        const LoadInstruction* load =
+                dynamic_cast<const LoadInstruction*>(instructions[i]);
+        const StoreInstruction* store =
+                dynamic_cast<const StoreInstruction*>(instructions[i]);
+
+        if (load != 0 && load->getFromTop() < localCount) {
+            LiveRange& range = ranges[load->getFromTop()];
+            if (range.start == unused)
+                range.start = -1;
+            range.end = i;
+        }
+        else if (store != 0 && store->getFromTop() < localCount) {
+            LiveRange& range = ranges[store->getFromTop()];
+            if (range.start == unused)
+                range.start = i;
+        }
+    }
+
+    // after removing the dead stores, every variable which is stored is
+    // loaded as well
+    std::vector<LiveRange> used;
+    for (Word i = 0; i < localCount; i++) {
+        if (ranges[i].end != unused)
+            used.push_back(ranges[i]);
+    }
+    std::stable_sort(used.begin(), used.end());
+
+    // the end of the live range last assigned to every slot
+    std::vector<long> slotEnds;
+    std::vector<Word> slots(localCount, 0);
+    for (size_t i = 0; i < used.size(); i++) {
+        size_t slot = 0;
+        while (slot < slotEnds.size() && slotEnds[slot] >= used[i].start)
+            slot++;
+        if (slot == slotEnds.size())
+            slotEnds.push_back(0);
+
+        slotEnds[slot] = used[i].end;
+        slots[used[i].variable] = slot;
+    }
+
+    Word slotCount = slotEnds.size();
+    if (slotCount == localCount)
+        return;
+
+    for (size_t i = 0; i < instructions.size(); i++) {
+        StackInstruction* instruction = instructions[i];
+        const LoadInstruction* load =
+                dynamic_cast<const LoadInstruction*>(instruction);
+        const StoreInstruction* store =
+                dynamic_cast<const StoreInstruction*>(instruction);
+
+        if (load == 0 && store == 0)
+            continue;
+
+        Word fromTop = load != 0 ? load->getFromTop() : store->getFromTop();
+        if (fromTop < localCount)
+            fromTop = slots[fromTop];
+        else
+            fromTop = fromTop - localCount + slotCount;
+
+        if (load != 0)
+            instructions[i] = new LoadInstruction(fromTop);
+        else
+            instructions[i] = new StoreInstruction(fromTop);
+        delete instruction;
+    }
+    subroutine->setLocalVariableCount(slotCount);
+}
+
@@ -0,0 +1,90 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_CODE_SLOTALLOCATOR_H_
+#define UETLI_CODE_SLOTALLOCATOR_H_
+
+#include <vector>
+
+#include "StackMachine.h"
+
+namespace uetli
+{
+    namespace code
+    {
+        class SlotAllocator;
+    }
+}
+
+
+///
+/// \brief removes dead stores and lets local variables share their slots
+///
+/// Every local variable gets its own slot in the frame of a subroutine when
+/// the code is generated. This pass computes which variables are live at
+/// each instruction. Since the code is straight-line, a single backward
+/// scan is enough:
+///
+/// - A store into a variable which is not loaded before it is overwritten
+///   or the subroutine returns is dead. It is replaced by a pop, which the
+///   peephole optimizer can remove together with the pushed value.
+///
+/// - The live range of a local variable spans from its first store (or
+///   the entry of the subroutine, if its initial 0 is loaded) to its last
+///   load. Variables with disjoint live ranges are assigned to the same
+///   slot, so the frame shrinks to the maximum number of variables live at
+///   the same time. Variables which are never loaded get no slot at all.
+///
+/// Arguments keep their slots below the local variables.
+///
+class uetli::code::SlotAllocator
+{
+    struct LiveRange
+    {
+        /// the index of the first store or -1, if the variable is live when
+        /// the subroutine is entered
+        long start;
+
+        /// the index of the last load
+        long end;
+
+        Word variable;
+
+        bool operator < (const LiveRange& other) const;
+    };
+
+public:
+    ///
+    /// \brief remove the dead stores and compact the local variables
+    ///
+    /// Replaced instructions are deleted.
+    ///
+    void optimize(DirectSubroutine* subroutine);
+
+private:
+    void removeDeadStores(DirectSubroutine* subroutine);
+    void compactSlots(DirectSubroutine* subroutine);
+};
+
+
+#endif // UETLI_CODE_SLOTALLOCATOR_H_
+
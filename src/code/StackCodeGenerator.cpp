@@ -21,9 +21,67 @@
 
 
 #include "StackCodeGenerator.h"
+#include "../util/ThreadPool.h"
+#include "../util/Trace.h"
 
 using namespace uetli::code;
 
+
+namespace
+{
+    ///
+    /// \brief generates the code of one method per iteration
+    ///
+    class GeneratorLoop : public uetli::util::ThreadPool::Loop
+    {
+        const std::vector<uetli::semantic::Method*>& methods;
+        std::vector<DirectSubroutine*>& output;
+    public:
+        GeneratorLoop(const std::vector<uetli::semantic::Method*>& methods,
+                      std::vector<DirectSubroutine*>& output);
+
+        virtual void run(size_t index);
+    };
+}
+
+
+GeneratorLoop::GeneratorLoop(
+        const std::vector<uetli::semantic::Method*>& methods,
+        std::vector<DirectSubroutine*>& output) :
+    methods(methods), output(output)
+{
+}
+
+
+void GeneratorLoop::run(size_t index)
+{
+    StackCodeGenerator generator(methods[index]);
+    output[index] = generator.getGeneratedCode();
+    generator.generateCode();
+}
+
+
+std::vector<DirectSubroutine*> uetli::code::generateCode(
+        const std::vector<semantic::Method*>& methods, size_t threadCount)
+{
+    util::TraceSpan span("stack code generation");
+
+    // every iteration writes its own element, so no locking is needed
+    std::vector<DirectSubroutine*> output(methods.size(), 0);
+    GeneratorLoop loop(methods, output);
+
+    try {
+        util::ThreadPool::forEach(loop, methods.size(), threadCount);
+    }
+    catch (...) {
+        for (size_t i = 0; i < output.size(); i++) {
+            delete output[i];
+        }
+        throw;
+    }
+    return output;
+}
+
 StackCodeGenerator::StackCodeGenerator(const semantic::Method* method) :
     method(method)
 {
@@ -34,6 +92,10 @@ StackCodeGenerator::StackCodeGenerator(const semantic::Method* method) :
 
 void StackCodeGenerator::generateCode(void)
 {
+    util::TraceSpan span("generate stack code");
+    if (span.isRecording())
+        span.setName(output->getName().getAsString());
+
     method->getContent().generateStatementCode(output->getInstructions());
 }
 
@@ -25,11 +25,23 @@
 #include "StackMachine.h"
 #include "../semantic/AttributedSyntaxTree.h"
 
+#include <vector>
+
 namespace uetli
 {
     namespace code
     {
         class StackCodeGenerator;
+
+        ///
+        /// \brief generate the code of several methods concurrently
+        ///
+        /// \param threadCount the maximum number of threads used
+        /// \return the generated subroutines in the order of the methods
+        ///
+        std::vector<DirectSubroutine*> generateCode(
+                const std::vector<semantic::Method*>& methods,
+                size_t threadCount);
     }
 }
 
@@ -20,22 +20,27 @@
 // =============================================================================
 
 #include "StackMachine.h"
+#include "ExecutionContext.h"
 #include <iostream>
 #include <sstream>
 
 using namespace uetli::code;
 
 
+StackInstruction::~StackInstruction(void)
+{
+}
+
+
 LoadInstruction::LoadInstruction(Word fromTop) :
     fromTop(fromTop)
 {
 }
 
 
-void LoadInstruction::execute(std::vector<void*>& stack,
-                              std::vector<void*>& variableStack) const
+void LoadInstruction::execute(ExecutionContext& context) const
 {
-    stack.push_back(variableStack[variableStack.size() - 1 - fromTop]);
+    context.push(context.variable(fromTop));
 }
 
 
@@ -60,11 +65,15 @@ StoreInstruction::StoreInstruction(Word fromTop) :
 }
 
 
-void StoreInstruction::execute(std::vector<void*>& stack,
-                               std::vector<void*>& variableStack) const
+void StoreInstruction::execute(ExecutionContext& context) const
+{
+    context.variable(fromTop) = context.pop();
+}
+
+
+Word StoreInstruction::getFromTop(void) const
 {
-    variableStack[variableStack.size() - 1 - fromTop] = *(stack.end() - 1);
-    stack.pop_back();
+    return fromTop;
 }
 
 
@@ -83,12 +92,16 @@ DereferenceInstruction::DereferenceInstruction(Word offset) :
 }
 
 
-void DereferenceInstruction::execute(std::vector<void*>& stack,
-                                     std::vector<void*>&) const
+void DereferenceInstruction::execute(ExecutionContext& context) const
 {
-    void* pointer = *(stack.end() - 1);
-    pointer = (void*) (((char*) pointer) + offset);
-    stack.push_back(*((void**) pointer));
+    Word* pointer = (Word*) (((char*) context.top()) + offset);
+    context.push(*pointer);
+}
+
+
+Word DereferenceInstruction::getOffset(void) const
+{
+    return offset;
 }
 
 
@@ -107,14 +120,17 @@ DereferenceStoreInstruction::DereferenceStoreInstruction(Word offset) :
 }
 
 
-void DereferenceStoreInstruction::execute(std::vector<void*>& stack,
-                                          std::vector<void*>&) const
+void DereferenceStoreInstruction::execute(ExecutionContext& context) const
+{
+    Word value = context.pop();
+    Word* pointer = (Word*) (((char*) context.top()) + offset);
+    *pointer = value;
+}
+
+
+Word DereferenceStoreInstruction::getOffset(void) const
 {
-    void* pointer = *(stack.end() - 2);
-    void* value = *(stack.end() - 1);
-    stack.pop_back();
-    pointer = (void*) (((char*) pointer) + offset);
-    *((void**) pointer) = value;
+    return offset;
 }
 
 
@@ -128,10 +144,9 @@ std::string DereferenceStoreInstruction::toString(void) const
 }
 
 
-void PopInstruction::execute(std::vector<void*>& stack,
-                             std::vector<void*>& variableStack) const
+void PopInstruction::execute(ExecutionContext& context) const
 {
-    stack.pop_back();
+    context.pop();
 }
 
 
@@ -145,17 +160,16 @@ std::string PopInstruction::toString(void) const
 
 
 CallInstruction::CallInstruction(Subroutine* subroutine) :
-    subroutine(subroutine)
+    subroutine(subroutine),
+    target(dynamic_cast<DirectSubroutine*> (subroutine))
 {
 }
 
 
-void CallInstruction::execute(std::vector<void*>& stack,
-                              std::vector<void*>& variableStack) const
+void CallInstruction::execute(ExecutionContext& context) const
 {
-    DirectSubroutine* ds = dynamic_cast<DirectSubroutine*> (subroutine);
-    if (ds != 0) {
-        ds->execute(stack, variableStack);
+    if (target != 0) {
+        target->execute(context);
     }
 }
 
@@ -175,16 +189,34 @@ const Subroutine* CallInstruction::getSubroutine(void) const
 }
 
 
+DirectSubroutine* CallInstruction::getTarget(void) const
+{
+    return target;
+}
+
+
+void CallInstruction::resolve(DirectSubroutine* target)
+{
+    this->subroutine = target;
+    this->target = target;
+}
+
+
 LoadConstantInstruction::LoadConstantInstruction(Word constant) :
     constant(constant)
 {
 }
 
 
-void LoadConstantInstruction::execute(std::vector<void*>& stack,
-                                      std::vector<void*>& variableStack) const
+void LoadConstantInstruction::execute(ExecutionContext& context) const
 {
-    stack.push_back((void*) constant);
+    context.push(constant);
+}
+
+
+Word LoadConstantInstruction::getConstant(void) const
+{
+    return constant;
 }
 
 
@@ -198,12 +230,10 @@ std::string LoadConstantInstruction::toString(void) const
 
 
 
-void AllocateInstruction::execute(std::vector<void*>& stack,
-                                  std::vector<void*>&) const
+void AllocateInstruction::execute(ExecutionContext& context) const
 {
-    Word val = (Word) *(stack.end() - 1);
-    stack.pop_back();
-    stack.push_back(new char[val]);
+    Word val = context.top();
+    context.top() = (Word) new char[val];
 }
 
 
@@ -216,10 +246,9 @@ std::string AllocateInstruction::toString(void) const
 }
 
 
-void DuplicateInstruction::execute(std::vector<void*>& stack,
-                                   std::vector<void*>&) const
+void DuplicateInstruction::execute(ExecutionContext& context) const
 {
-    stack.push_back(*(stack.end() - 1));
+    context.push(context.top());
 }
 
 
@@ -232,10 +261,9 @@ std::string DuplicateInstruction::toString(void) const
 }
 
 
-void PrintInstruction::execute(std::vector<void*>& stack,
-                               std::vector<void*>&) const
+void PrintInstruction::execute(ExecutionContext& context) const
 {
-    std::cout << *(stack.end() - 1) << std::endl;
+    std::cout << (void*) context.top() << std::endl;
 }
 
 
@@ -248,6 +276,34 @@ std::string PrintInstruction::toString(void) const
 }
 
 
+IntrinsicInstruction::IntrinsicInstruction(Intrinsic intrinsic) :
+    intrinsic(intrinsic)
+{
+}
+
+
+void IntrinsicInstruction::execute(ExecutionContext& context) const
+{
+    Word right = context.pop();
+    context.top() = evaluateIntrinsic(intrinsic, context.top(), right);
+}
+
+
+Intrinsic IntrinsicInstruction::getIntrinsic(void) const
+{
+    return intrinsic;
+}
+
+
+std::string IntrinsicInstruction::toString(void) const
+{
+    std::stringstream str;
+    str << "intrinsic " << getIntrinsicName(intrinsic) <<
+           " # built-in operation on the two topmost values" << std::endl;
+    return str.str();
+}
+
+
 Subroutine::Subroutine(const parser::Identifier& name,
                        size_t argumentCount) :
     name(name),
@@ -288,20 +344,19 @@ DirectSubroutine::DirectSubroutine(Word localVariableCount,
 }
 
 
-void DirectSubroutine::execute(std::vector<void*>& stack,
-                         std::vector<void*>& variableStack) const
+void DirectSubroutine::execute(ExecutionContext& context) const
 {
-    for (Word i = 0; i < localVariableCount; i++)
-        variableStack.push_back(0);
+    // every instruction pushes at most one value, so the operation stack
+    // can never grow by more than the number of instructions
+    context.enterFrame(argumentCount, localVariableCount, instructions.size());
 
     typedef std::vector<StackInstruction*>::const_iterator InstructionIterator;
     for (InstructionIterator i = instructions.begin();
          i != instructions.end(); i++) {
-        (*i)->execute(stack, variableStack);
+        (*i)->execute(context);
     }
 
-    for (Word i = 0; i < localVariableCount; i++)
-        variableStack.pop_back();
+    context.leaveFrame();
 }
 
 
@@ -362,6 +417,40 @@ std::string getDescription(uetli::code::StackInstruction* si)
     return siInfo.name();
 }
 
+
+Word evaluateIntrinsic(Intrinsic intrinsic, Word left, Word right)
+{
+    switch (intrinsic) {
+        case INTEGER_ADD:
+            return left + right;
+        case INTEGER_SUBTRACT:
+            return left - right;
+        case INTEGER_MULTIPLY:
+            return left * right;
+        case INTEGER_DIVIDE:
+            if (right == 0)
+                throw ExecutionException("division by zero");
+            // the only signed division that overflows
+            if (right == Word(-1))
+                return Word(0) - left;
+            return Word(long(left) / long(right));
+        default:
+            throw "invalid intrinsic";
+    }
+}
+
+
+const char* getIntrinsicName(Intrinsic intrinsic)
+{
+    static const char* const names[intrinsics_count] = {
+        "integer_add",
+        "integer_subtract",
+        "integer_multiply",
+        "integer_divide",
+    };
+    return names[intrinsic];
+}
+
 }}
 
 
@@ -36,6 +36,25 @@ namespace uetli
         ///
         typedef unsigned long Word;
 
+        ///
+        /// \brief operations that are built into the executors
+        ///
+        /// Intrinsics replace calls to native methods. All of them take two
+        /// operands from the stack and push the result.
+        ///
+        enum Intrinsic
+        {
+            INTEGER_ADD = 0,
+            INTEGER_SUBTRACT,
+            INTEGER_MULTIPLY,
+            INTEGER_DIVIDE,
+
+            /// contains the number of intrinsics
+            intrinsics_count
+        };
+
+        class ExecutionContext;
+
         class StackInstruction;
             class LoadInstruction;
             class StoreInstruction;
@@ -47,6 +66,7 @@ namespace uetli
             class AllocateInstruction;
             class DuplicateInstruction;
             class PrintInstruction;
+            class IntrinsicInstruction;
 
             class Subroutine;
                 class SubroutineLink;
@@ -54,6 +74,21 @@ namespace uetli
 
         // only for debug purpose
         std::string getDescription(StackInstruction*);
+
+        ///
+        /// \brief calculate the result of an intrinsic
+        ///
+        /// Integers are treated as signed two's complement words.
+        ///
+        /// \param intrinsic the operation
+        /// \param left the first (deeper) operand on the stack
+        /// \param right the second (topmost) operand on the stack
+        ///
+        /// \throws ExecutionException on a division by zero
+        ///
+        Word evaluateIntrinsic(Intrinsic intrinsic, Word left, Word right);
+
+        const char* getIntrinsicName(Intrinsic intrinsic);
     }
 }
 
@@ -68,16 +103,16 @@ namespace uetli
 class uetli::code::StackInstruction
 {
 public:
+    virtual ~StackInstruction(void);
+
     ///
     /// \brief execute the instruction on a stack
     ///
     /// The implementation of this method is used for testing purposes.
     ///
-    /// \param stack the actual stack parameter (the last element in the list
-    ///              is treated as the topmost element in the stack.
+    /// \param context the stacks to operate on
     ///
-    virtual void execute(std::vector<void*>& stack,
-                         std::vector<void*>& variableStack) const = 0;
+    virtual void execute(ExecutionContext& context) const = 0;
 
     ///
     /// \brief create a short description of the instruction
@@ -101,8 +136,7 @@ class uetli::code::LoadInstruction : public StackInstruction
 public:
     LoadInstruction(Word fromTop);
 
-    virtual void execute(std::vector<void*>& stack,
-                         std::vector<void*>& variableStack) const;
+    virtual void execute(ExecutionContext& context) const;
 
     ///
     /// \return the index of the value to load (where 0 is the topmost element
@@ -128,8 +162,13 @@ class uetli::code::StoreInstruction : public StackInstruction
 public:
     StoreInstruction(Word fromTop);
 
-    virtual void execute(std::vector<void*>& stack,
-                         std::vector<void*>& variableStack) const;
+    virtual void execute(ExecutionContext& context) const;
+
+    ///
+    /// \return the index of the variable to overwrite (where 0 is the topmost
+    ///         element on the variable stack)
+    ///
+    Word getFromTop(void) const;
     
     virtual std::string toString(void) const;
 };
@@ -148,7 +187,9 @@ class uetli::code::DereferenceInstruction : public StackInstruction
 public:
     DereferenceInstruction(Word offset);
 
-    virtual void execute(std::vector<void*>& stack, std::vector<void*>&) const;
+    virtual void execute(ExecutionContext& context) const;
+
+    Word getOffset(void) const;
     
     virtual std::string toString(void) const;
 };
@@ -167,7 +208,9 @@ class uetli::code::DereferenceStoreInstruction : public StackInstruction
 public:
     DereferenceStoreInstruction(Word offset);
 
-    virtual void execute(std::vector<void*>& stack, std::vector<void*>&) const;
+    virtual void execute(ExecutionContext& context) const;
+
+    Word getOffset(void) const;
     
     virtual std::string toString(void) const;
 };
@@ -182,8 +225,7 @@ class uetli::code::PopInstruction : public StackInstruction
 {
 public:
 
-    virtual void execute(std::vector<void*>& stack,
-                         std::vector<void*>& variableStack) const;
+    virtual void execute(ExecutionContext& context) const;
 
     virtual std::string toString(void) const;
 };
@@ -192,18 +234,36 @@ public:
 ///
 /// \brief calls a subroutine
 ///
+/// The called subroutine is either a DirectSubroutine, in which case the call
+/// is resolved, or a SubroutineLink, which has to be resolved by the Linker.
+/// Calls to unresolved links are not executed.
+///
 class uetli::code::CallInstruction : public StackInstruction
 {
     Subroutine* subroutine;
+
+    /// the called subroutine, if the call is resolved
+    DirectSubroutine* target;
 public:
 
     CallInstruction(Subroutine* subroutine);
 
-    virtual void execute(std::vector<void*>& stack,
-                         std::vector<void*>& variableStack) const;
+    virtual void execute(ExecutionContext& context) const;
     
     virtual std::string toString(void) const;
     virtual const Subroutine* getSubroutine(void) const;
+
+    ///
+    /// \return the called subroutine or 0, if the call is not resolved
+    ///
+    DirectSubroutine* getTarget(void) const;
+
+    ///
+    /// \brief let the call point to a subroutine
+    ///
+    /// The previously called subroutine is not deleted.
+    ///
+    void resolve(DirectSubroutine* target);
 };
 
 
@@ -218,8 +278,9 @@ class uetli::code::LoadConstantInstruction : public StackInstruction
 public:
     LoadConstantInstruction(Word constant);
 
-    virtual void execute(std::vector<void*>& stack,
-                         std::vector<void*>& variableStack) const;
+    virtual void execute(ExecutionContext& context) const;
+
+    Word getConstant(void) const;
     
     virtual std::string toString(void) const;
 };
@@ -235,7 +296,7 @@ class uetli::code::AllocateInstruction : public StackInstruction
 {
 public:
 
-    virtual void execute(std::vector<void*>& stack, std::vector<void*>&) const;
+    virtual void execute(ExecutionContext& context) const;
     
     virtual std::string toString(void) const;
 };
@@ -251,8 +312,7 @@ class uetli::code::DuplicateInstruction : public StackInstruction
 {
 public:
 
-    virtual void execute(std::vector<void*>& stack,
-                         std::vector<void*>& variableStack) const;
+    virtual void execute(ExecutionContext& context) const;
     
     virtual std::string toString(void) const;
 };
@@ -261,13 +321,32 @@ public:
 class uetli::code::PrintInstruction : public StackInstruction
 {
 public:
-    virtual void execute(std::vector<void*>& stack,
-                         std::vector<void*>& variableStack) const;
+    virtual void execute(ExecutionContext& context) const;
     
     virtual std::string toString(void) const;
 };
 
 
+///
+/// \brief executes an intrinsic
+///
+/// The two topmost values on the stack are replaced by the result of the
+/// operation.
+///
+class uetli::code::IntrinsicInstruction : public StackInstruction
+{
+    Intrinsic intrinsic;
+public:
+    IntrinsicInstruction(Intrinsic intrinsic);
+
+    virtual void execute(ExecutionContext& context) const;
+
+    Intrinsic getIntrinsic(void) const;
+
+    virtual std::string toString(void) const;
+};
+
+
 class uetli::code::Subroutine
 {
 protected:
@@ -303,7 +382,7 @@ public:
     DirectSubroutine(Word localVariableCount, const parser::Identifier& name,
                      size_t argumentCount);
 
-    virtual void execute(std::vector<void*>& stack, std::vector<void*>&) const;
+    virtual void execute(ExecutionContext& context) const;
 
     virtual std::string toString(void) const;
 
@@ -0,0 +1,60 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "BasicBlock.h"
+
+using namespace uetli::ir;
+
+
+BasicBlock::BasicBlock(void)
+{
+}
+
+
+BasicBlock::~BasicBlock(void)
+{
+    // the users of an instruction follow it, so they are deleted first
+    for (size_t i = instructions.size(); i > 0; i--) {
+        delete instructions[i - 1];
+    }
+}
+
+
+Instruction* BasicBlock::append(Instruction* instruction)
+{
+    instruction->setBlock(this);
+    instructions.push_back(instruction);
+    return instruction;
+}
+
+
+std::vector<Instruction*>& BasicBlock::getInstructions(void)
+{
+    return instructions;
+}
+
+
+const std::vector<Instruction*>& BasicBlock::getInstructions(void) const
+{
+    return instructions;
+}
+
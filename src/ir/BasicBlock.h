@@ -0,0 +1,76 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_IR_BASICBLOCK_H_
+#define UETLI_IR_BASICBLOCK_H_
+
+#include <vector>
+
+#include "Instruction.h"
+
+namespace uetli
+{
+    namespace ir
+    {
+        class BasicBlock;
+    }
+}
+
+
+///
+/// \brief a sequence of instructions which are always executed together,
+///        ended by a ReturnInstruction
+///
+/// The block owns its instructions.
+///
+class uetli::ir::BasicBlock
+{
+    std::vector<Instruction*> instructions;
+public:
+    BasicBlock(void);
+    ~BasicBlock(void);
+
+private:
+    BasicBlock(const BasicBlock&);
+    BasicBlock& operator=(const BasicBlock&);
+
+public:
+    ///
+    /// \brief add an instruction at the end of the block
+    ///
+    /// \return the added instruction
+    ///
+    Instruction* append(Instruction* instruction);
+
+    ///
+    /// \brief the instructions in the order they are executed
+    ///
+    /// Passes may delete instructions which are not used anymore and remove
+    /// them from the list.
+    ///
+    std::vector<Instruction*>& getInstructions(void);
+    const std::vector<Instruction*>& getInstructions(void) const;
+};
+
+
+#endif // UETLI_IR_BASICBLOCK_H_
+
@@ -0,0 +1,44 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "CopyPropagation.h"
+
+using namespace uetli::ir;
+
+
+void CopyPropagation::optimize(Function* function)
+{
+    const std::vector<BasicBlock*>& blocks = function->getBlocks();
+    for (size_t i = 0; i < blocks.size(); i++) {
+        const std::vector<Instruction*>& instructions =
+                blocks[i]->getInstructions();
+
+        // the operand of a copy is never a copy itself afterwards, since
+        // the copies are visited in the order they are defined
+        for (size_t j = 0; j < instructions.size(); j++) {
+            if (dynamic_cast<CopyInstruction*>(instructions[j]))
+                instructions[j]->replaceAllUsesWith(
+                            instructions[j]->getOperand(0));
+        }
+    }
+}
+
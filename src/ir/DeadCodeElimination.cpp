@@ -0,0 +1,53 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "DeadCodeElimination.h"
+
+using namespace uetli::ir;
+
+
+void DeadCodeElimination::optimize(Function* function)
+{
+    const std::vector<BasicBlock*>& blocks = function->getBlocks();
+    for (size_t i = blocks.size(); i > 0; i--) {
+        std::vector<Instruction*>& instructions =
+                blocks[i - 1]->getInstructions();
+
+        // removed instructions are set to 0 and compacted at the end
+        for (size_t j = instructions.size(); j > 0; j--) {
+            Instruction* instruction = instructions[j - 1];
+            if (instruction->getUsers().empty() &&
+                !instruction->hasSideEffects()) {
+                delete instruction;
+                instructions[j - 1] = 0;
+            }
+        }
+
+        size_t kept = 0;
+        for (size_t j = 0; j < instructions.size(); j++) {
+            if (instructions[j] != 0)
+                instructions[kept++] = instructions[j];
+        }
+        instructions.resize(kept);
+    }
+}
+
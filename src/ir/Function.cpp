@@ -0,0 +1,100 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "Function.h"
+
+#include <map>
+#include <sstream>
+
+using namespace uetli::ir;
+
+
+Function::Function(const parser::Identifier& name, size_t argumentCount) :
+    name(name), argumentCount(argumentCount)
+{
+}
+
+
+Function::~Function(void)
+{
+    for (size_t i = blocks.size(); i > 0; i--) {
+        delete blocks[i - 1];
+    }
+}
+
+
+const uetli::parser::Identifier& Function::getName(void) const
+{
+    return name;
+}
+
+
+size_t Function::getArgumentCount(void) const
+{
+    return argumentCount;
+}
+
+
+BasicBlock* Function::addBlock(void)
+{
+    BasicBlock* block = new BasicBlock();
+    blocks.push_back(block);
+    return block;
+}
+
+
+const std::vector<BasicBlock*>& Function::getBlocks(void) const
+{
+    return blocks;
+}
+
+
+std::string Function::toString(void) const
+{
+    std::map<const Instruction*, size_t> numbers;
+    std::stringstream str;
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        str << "block " << i << ":" << std::endl;
+
+        const std::vector<Instruction*>& instructions =
+                blocks[i]->getInstructions();
+        for (size_t j = 0; j < instructions.size(); j++) {
+            const Instruction* instruction = instructions[j];
+            str << "    ";
+            if (instruction->getType() == WORD) {
+                size_t number = numbers.size();
+                numbers[instruction] = number;
+                str << "%" << number << " = ";
+            }
+
+            str << instruction->getMnemonic();
+            for (size_t k = 0; k < instruction->getOperandCount(); k++) {
+                str << (k == 0 ? " " : ", ") << "%" <<
+                       numbers[instruction->getOperand(k)];
+            }
+            str << std::endl;
+        }
+    }
+    return str.str();
+}
+
@@ -0,0 +1,81 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_IR_FUNCTION_H_
+#define UETLI_IR_FUNCTION_H_
+
+#include <string>
+#include <vector>
+
+#include "BasicBlock.h"
+#include "../parser/Identifier.h"
+
+namespace uetli
+{
+    namespace ir
+    {
+        class Function;
+    }
+}
+
+
+///
+/// \brief a subroutine in static single assignment form
+///
+/// The first block is the entry of the function. Since the stack code has
+/// no branches, the functions built from it consist of this block only.
+///
+class uetli::ir::Function
+{
+    parser::Identifier name;
+    size_t argumentCount;
+
+    std::vector<BasicBlock*> blocks;
+public:
+    Function(const parser::Identifier& name, size_t argumentCount);
+    ~Function(void);
+
+private:
+    Function(const Function&);
+    Function& operator=(const Function&);
+
+public:
+    const parser::Identifier& getName(void) const;
+    size_t getArgumentCount(void) const;
+
+    ///
+    /// \return a new empty block at the end of the function
+    ///
+    BasicBlock* addBlock(void);
+
+    const std::vector<BasicBlock*>& getBlocks(void) const;
+
+    ///
+    /// \return a listing of the instructions, where the values are named
+    ///         by numbering them in the order they are defined
+    ///
+    std::string toString(void) const;
+};
+
+
+#endif // UETLI_IR_FUNCTION_H_
+
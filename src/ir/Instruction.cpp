@@ -0,0 +1,262 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "Instruction.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace uetli::ir;
+
+
+Instruction::Instruction(Type type) :
+    type(type), block(0)
+{
+}
+
+
+Instruction::~Instruction(void)
+{
+    for (size_t i = 0; i < operands.size(); i++) {
+        operands[i]->removeUser(this);
+    }
+}
+
+
+Type Instruction::getType(void) const
+{
+    return type;
+}
+
+
+BasicBlock* Instruction::getBlock(void) const
+{
+    return block;
+}
+
+
+void Instruction::setBlock(BasicBlock* block)
+{
+    this->block = block;
+}
+
+
+size_t Instruction::getOperandCount(void) const
+{
+    return operands.size();
+}
+
+
+Instruction* Instruction::getOperand(size_t index) const
+{
+    return operands[index];
+}
+
+
+void Instruction::setOperand(size_t index, Instruction* operand)
+{
+    operands[index]->removeUser(this);
+    operands[index] = operand;
+    operand->users.push_back(this);
+}
+
+
+const std::vector<Instruction*>& Instruction::getUsers(void) const
+{
+    return users;
+}
+
+
+void Instruction::replaceAllUsesWith(Instruction* replacement)
+{
+    while (!users.empty()) {
+        Instruction* user = users.back();
+        for (size_t i = 0; i < user->operands.size(); i++) {
+            if (user->operands[i] == this)
+                user->setOperand(i, replacement);
+        }
+    }
+}
+
+
+bool Instruction::hasSideEffects(void) const
+{
+    return false;
+}
+
+
+void Instruction::addOperand(Instruction* operand)
+{
+    operands.push_back(operand);
+    operand->users.push_back(this);
+}
+
+
+void Instruction::removeUser(Instruction* user)
+{
+    std::vector<Instruction*>::iterator found =
+            std::find(users.begin(), users.end(), user);
+    if (found != users.end())
+        users.erase(found);
+}
+
+
+ArgumentInstruction::ArgumentInstruction(size_t index) :
+    Instruction(WORD), index(index)
+{
+}
+
+
+size_t ArgumentInstruction::getIndex(void) const
+{
+    return index;
+}
+
+
+std::string ArgumentInstruction::getMnemonic(void) const
+{
+    std::stringstream str;
+    str << "argument " << index;
+    return str.str();
+}
+
+
+ConstantInstruction::ConstantInstruction(code::Word value) :
+    Instruction(WORD), value(value)
+{
+}
+
+
+uetli::code::Word ConstantInstruction::getValue(void) const
+{
+    return value;
+}
+
+
+std::string ConstantInstruction::getMnemonic(void) const
+{
+    std::stringstream str;
+    str << "constant " << value;
+    return str.str();
+}
+
+
+CopyInstruction::CopyInstruction(Instruction* value) :
+    Instruction(WORD)
+{
+    addOperand(value);
+}
+
+
+std::string CopyInstruction::getMnemonic(void) const
+{
+    return "copy";
+}
+
+
+IntrinsicInstruction::IntrinsicInstruction(code::Intrinsic intrinsic,
+                                           Instruction* left,
+                                           Instruction* right) :
+    Instruction(WORD), intrinsic(intrinsic)
+{
+    addOperand(left);
+    addOperand(right);
+}
+
+
+uetli::code::Intrinsic IntrinsicInstruction::getIntrinsic(void) const
+{
+    return intrinsic;
+}
+
+
+bool IntrinsicInstruction::isCommutative(void) const
+{
+    return intrinsic == code::INTEGER_ADD ||
+           intrinsic == code::INTEGER_MULTIPLY;
+}
+
+
+bool IntrinsicInstruction::hasSideEffects(void) const
+{
+    if (intrinsic != code::INTEGER_DIVIDE)
+        return false;
+
+    const ConstantInstruction* divisor =
+            dynamic_cast<const ConstantInstruction*>(getOperand(1));
+    return divisor == 0 || divisor->getValue() == 0 ||
+           divisor->getValue() == (code::Word) -1;
+}
+
+
+std::string IntrinsicInstruction::getMnemonic(void) const
+{
+    return code::getIntrinsicName(intrinsic);
+}
+
+
+CallInstruction::CallInstruction(const parser::Identifier& callee,
+                                 const std::vector<Instruction*>& arguments) :
+    Instruction(WORD), callee(callee)
+{
+    for (size_t i = 0; i < arguments.size(); i++) {
+        addOperand(arguments[i]);
+    }
+}
+
+
+const uetli::parser::Identifier& CallInstruction::getCallee(void) const
+{
+    return callee;
+}
+
+
+bool CallInstruction::hasSideEffects(void) const
+{
+    return true;
+}
+
+
+std::string CallInstruction::getMnemonic(void) const
+{
+    return "call " + callee.getAsString();
+}
+
+
+ReturnInstruction::ReturnInstruction(Instruction* value) :
+    Instruction(VOID)
+{
+    addOperand(value);
+}
+
+
+bool ReturnInstruction::hasSideEffects(void) const
+{
+    return true;
+}
+
+
+std::string ReturnInstruction::getMnemonic(void) const
+{
+    return "return";
+}
+
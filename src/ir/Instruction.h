@@ -0,0 +1,232 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_IR_INSTRUCTION_H_
+#define UETLI_IR_INSTRUCTION_H_
+
+#include <string>
+#include <vector>
+
+#include "../code/StackMachine.h"
+#include "../parser/Identifier.h"
+
+namespace uetli
+{
+    namespace ir
+    {
+        ///
+        /// \brief the type of the value defined by an instruction
+        ///
+        enum Type
+        {
+            /// the instruction does not define a value
+            VOID,
+
+            /// a machine word (an integer or a pointer)
+            WORD
+        };
+
+        class BasicBlock;
+
+        class Instruction;
+
+        class ArgumentInstruction;
+        class ConstantInstruction;
+        class CopyInstruction;
+        class IntrinsicInstruction;
+        class CallInstruction;
+        class ReturnInstruction;
+    }
+}
+
+
+///
+/// \brief an instruction of the SSA form, which is also the value it defines
+///
+/// Every value is defined by exactly one instruction, and the operands of an
+/// instruction refer to the instructions defining them. Each instruction
+/// keeps the list of its users (the def-use chain), so all uses of a value
+/// can be replaced without searching the function.
+///
+class uetli::ir::Instruction
+{
+    Type type;
+
+    /// the block containing the instruction
+    BasicBlock* block;
+
+    std::vector<Instruction*> operands;
+
+    /// the instructions using this one, once for every operand referring
+    /// to it
+    std::vector<Instruction*> users;
+
+public:
+    Instruction(Type type);
+
+    ///
+    /// \brief remove the instruction from the users of its operands
+    ///
+    /// The instruction must not be used anymore.
+    ///
+    virtual ~Instruction(void);
+
+private:
+    Instruction(const Instruction&);
+    Instruction& operator=(const Instruction&);
+
+public:
+    Type getType(void) const;
+
+    BasicBlock* getBlock(void) const;
+    void setBlock(BasicBlock* block);
+
+    size_t getOperandCount(void) const;
+    Instruction* getOperand(size_t index) const;
+    void setOperand(size_t index, Instruction* operand);
+
+    const std::vector<Instruction*>& getUsers(void) const;
+
+    ///
+    /// \brief let all users of this instruction use another one instead
+    ///
+    void replaceAllUsesWith(Instruction* replacement);
+
+    ///
+    /// \return <code>true</code>, if the instruction has an effect apart
+    ///         from defining its value, so it must not be removed even if
+    ///         the value is not used
+    ///
+    virtual bool hasSideEffects(void) const;
+
+    ///
+    /// \return the mnemonic of the instruction and its attributes (but not
+    ///         its operands)
+    ///
+    virtual std::string getMnemonic(void) const = 0;
+
+protected:
+    void addOperand(Instruction* operand);
+
+private:
+    void removeUser(Instruction* user);
+};
+
+
+///
+/// \brief the value of an argument passed to the function
+///
+class uetli::ir::ArgumentInstruction : public Instruction
+{
+    /// the index of the argument, where 0 is the first one
+    size_t index;
+public:
+    ArgumentInstruction(size_t index);
+
+    size_t getIndex(void) const;
+
+    virtual std::string getMnemonic(void) const;
+};
+
+
+class uetli::ir::ConstantInstruction : public Instruction
+{
+    code::Word value;
+public:
+    ConstantInstruction(code::Word value);
+
+    code::Word getValue(void) const;
+
+    virtual std::string getMnemonic(void) const;
+};
+
+
+///
+/// \brief a copy of a value, as created for every store into a variable
+///
+class uetli::ir::CopyInstruction : public Instruction
+{
+public:
+    CopyInstruction(Instruction* value);
+
+    virtual std::string getMnemonic(void) const;
+};
+
+
+///
+/// \brief a binary operation implemented by the machine
+///
+/// A division traps if the divisor is zero (or if the most negative number
+/// is divided by -1), so it is only free of side effects if its divisor is
+/// a constant for which this can not happen.
+///
+class uetli::ir::IntrinsicInstruction : public Instruction
+{
+    code::Intrinsic intrinsic;
+public:
+    IntrinsicInstruction(code::Intrinsic intrinsic, Instruction* left,
+                         Instruction* right);
+
+    code::Intrinsic getIntrinsic(void) const;
+
+    ///
+    /// \return <code>true</code>, if the operands may be swapped
+    ///
+    bool isCommutative(void) const;
+
+    virtual bool hasSideEffects(void) const;
+    virtual std::string getMnemonic(void) const;
+};
+
+
+///
+/// \brief a call to a subroutine, the operands are the arguments
+///
+class uetli::ir::CallInstruction : public Instruction
+{
+    parser::Identifier callee;
+public:
+    CallInstruction(const parser::Identifier& callee,
+                    const std::vector<Instruction*>& arguments);
+
+    const parser::Identifier& getCallee(void) const;
+
+    virtual bool hasSideEffects(void) const;
+    virtual std::string getMnemonic(void) const;
+};
+
+
+///
+/// \brief leaves the function, returning its operand
+///
+class uetli::ir::ReturnInstruction : public Instruction
+{
+public:
+    ReturnInstruction(Instruction* value);
+
+    virtual bool hasSideEffects(void) const;
+    virtual std::string getMnemonic(void) const;
+};
+
+
+#endif // UETLI_IR_INSTRUCTION_H_
+
@@ -0,0 +1,46 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_IR_OPTIMIZER_H_
+#define UETLI_IR_OPTIMIZER_H_
+
+#include "Function.h"
+
+namespace uetli
+{
+    namespace ir
+    {
+        ///
+        /// \brief run the passes on the SSA form of a function
+        ///
+        /// Copies are propagated first, so values stored in and loaded from
+        /// variables are numbered like the values themselves. The dead code
+        /// elimination then removes the copies and everything else whose
+        /// value is not used.
+        ///
+        void optimizeFunction(Function* function);
+    }
+}
+
+
+#endif // UETLI_IR_OPTIMIZER_H_
+
@@ -0,0 +1,146 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "SsaBuilder.h"
+
+using namespace uetli::ir;
+
+
+SsaBuilder::SsaBuilder(void) :
+    function(0), block(0)
+{
+}
+
+
+Function* SsaBuilder::build(const code::DirectSubroutine* subroutine)
+{
+    size_t argumentCount = subroutine->getArgumentCount();
+    size_t localVariableCount = subroutine->getLocalVariableCount();
+
+    function = new Function(subroutine->getName(), argumentCount);
+    block = function->addBlock();
+    stack.clear();
+    variables.assign(argumentCount + localVariableCount, 0);
+
+    // the arguments are the bottommost variables
+    for (size_t i = 0; i < argumentCount; i++) {
+        variables[variables.size() - 1 - i] =
+                block->append(new ArgumentInstruction(i));
+    }
+    if (localVariableCount > 0) {
+        Instruction* zero = block->append(new ConstantInstruction(0));
+        for (size_t i = 0; i < localVariableCount; i++) {
+            variables[i] = zero;
+        }
+    }
+
+    const std::vector<code::StackInstruction*>& instructions =
+            subroutine->getInstructions();
+    for (size_t i = 0; i < instructions.size(); i++) {
+        if (!translate(instructions[i])) {
+            delete function;
+            return 0;
+        }
+    }
+
+    Instruction* result = stack.empty() ?
+            block->append(new ConstantInstruction(0)) : stack.back();
+    block->append(new ReturnInstruction(result));
+    return function;
+}
+
+
+bool SsaBuilder::translate(const code::StackInstruction* instruction)
+{
+    using namespace uetli::code;
+
+    const LoadInstruction* load = 0;
+    const StoreInstruction* store = 0;
+    const LoadConstantInstruction* loadConstant = 0;
+    const code::IntrinsicInstruction* intrinsic = 0;
+    const code::CallInstruction* call = 0;
+    const DirectSubroutine* inlineSubroutine = 0;
+
+    if ((load = dynamic_cast<const LoadInstruction*>(instruction))) {
+        if (load->getFromTop() >= variables.size())
+            return false;
+        stack.push_back(variables[load->getFromTop()]);
+    }
+    else if ((store = dynamic_cast<const StoreInstruction*>(instruction))) {
+        if (stack.empty() || store->getFromTop() >= variables.size())
+            return false;
+        variables[store->getFromTop()] =
+                block->append(new CopyInstruction(pop(1)[0]));
+    }
+    else if ((loadConstant =
+              dynamic_cast<const LoadConstantInstruction*>(instruction))) {
+        stack.push_back(block->append(
+                new ConstantInstruction(loadConstant->getConstant())));
+    }
+    else if (dynamic_cast<const DuplicateInstruction*>(instruction)) {
+        if (stack.empty())
+            return false;
+        stack.push_back(stack.back());
+    }
+    else if (dynamic_cast<const PopInstruction*>(instruction)) {
+        if (stack.empty())
+            return false;
+        stack.pop_back();
+    }
+    else if ((intrinsic =
+              dynamic_cast<const code::IntrinsicInstruction*>(instruction))) {
+        if (stack.size() < 2)
+            return false;
+        std::vector<Instruction*> operands = pop(2);
+        stack.push_back(block->append(new ir::IntrinsicInstruction(
+                intrinsic->getIntrinsic(), operands[0], operands[1])));
+    }
+    else if ((call = dynamic_cast<const code::CallInstruction*>(instruction))) {
+        const Subroutine* callee = call->getSubroutine();
+        if (stack.size() < callee->getArgumentCount())
+            return false;
+        stack.push_back(block->append(new ir::CallInstruction(
+                callee->getName(), pop(callee->getArgumentCount()))));
+    }
+    else if ((inlineSubroutine =
+              dynamic_cast<const DirectSubroutine*>(instruction))) {
+        if (stack.size() < inlineSubroutine->getArgumentCount())
+            return false;
+        stack.push_back(block->append(new ir::CallInstruction(
+                inlineSubroutine->getName(),
+                pop(inlineSubroutine->getArgumentCount()))));
+    }
+    else {
+        // memory accesses, allocations and prints
+        return false;
+    }
+    return true;
+}
+
+
+std::vector<Instruction*> SsaBuilder::pop(size_t count)
+{
+    std::vector<Instruction*> values(stack.end() - count, stack.end());
+    stack.resize(stack.size() - count);
+    return values;
+}
+
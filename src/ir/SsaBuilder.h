@@ -0,0 +1,91 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_IR_SSABUILDER_H_
+#define UETLI_IR_SSABUILDER_H_
+
+#include <vector>
+
+#include "Function.h"
+#include "../code/StackMachine.h"
+
+namespace uetli
+{
+    namespace ir
+    {
+        class SsaBuilder;
+    }
+}
+
+
+///
+/// \brief translates the stack code of a subroutine into SSA form
+///
+/// The stack code is executed symbolically: the operation stack and the
+/// variables hold the instructions defining their current values. Loading
+/// a variable or duplicating a value does not create any instruction, a
+/// store creates a CopyInstruction, which becomes the new value of the
+/// variable. Local variables start out as the constant 0, arguments as an
+/// ArgumentInstruction. The function returns the topmost value of the
+/// operation stack or 0, like the subroutine.
+///
+/// Since the stack code is straight-line, the function consists of a single
+/// block and no phi instructions are needed.
+///
+class uetli::ir::SsaBuilder
+{
+    Function* function;
+    BasicBlock* block;
+
+    std::vector<Instruction*> stack;
+
+    /// the current values of the variables, indexed from the top
+    std::vector<Instruction*> variables;
+
+public:
+    SsaBuilder(void);
+
+    ///
+    /// \brief translate the code of a linked subroutine
+    ///
+    /// \return the new function or 0, if the code accesses memory (which is
+    ///         not modelled by the SSA form) or is malformed
+    ///
+    Function* build(const code::DirectSubroutine* subroutine);
+
+private:
+    ///
+    /// \return <code>false</code>, if the instruction can not be translated
+    ///
+    bool translate(const code::StackInstruction* instruction);
+
+    ///
+    /// \brief pop the given number of values
+    ///
+    /// \return the popped values, the deepest first
+    ///
+    std::vector<Instruction*> pop(size_t count);
+};
+
+
+#endif // UETLI_IR_SSABUILDER_H_
+
@@ -0,0 +1,115 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "ValueNumbering.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace uetli::ir;
+
+
+namespace
+{
+    /// the operations of arguments and constants, following the intrinsics
+    const int argumentOperation = uetli::code::intrinsics_count;
+    const int constantOperation = uetli::code::intrinsics_count + 1;
+}
+
+
+bool ValueNumbering::Key::operator < (const Key& other) const
+{
+    if (operation != other.operation)
+        return operation < other.operation;
+    if (attribute != other.attribute)
+        return attribute < other.attribute;
+    std::less<Instruction*> less;
+    if (left != other.left)
+        return less(left, other.left);
+    return less(right, other.right);
+}
+
+
+void ValueNumbering::optimize(Function* function)
+{
+    const std::vector<BasicBlock*>& blocks = function->getBlocks();
+    for (size_t i = 0; i < blocks.size(); i++) {
+        std::vector<Instruction*>& instructions =
+                blocks[i]->getInstructions();
+        values.clear();
+
+        size_t kept = 0;
+        for (size_t j = 0; j < instructions.size(); j++) {
+            Instruction* instruction = instructions[j];
+
+            Key key;
+            if (getKey(instruction, key)) {
+                std::map<Key, Instruction*>::iterator found =
+                        values.find(key);
+                if (found != values.end()) {
+                    instruction->replaceAllUsesWith(found->second);
+                    delete instruction;
+                    continue;
+                }
+                values[key] = instruction;
+            }
+            instructions[kept++] = instruction;
+        }
+        instructions.resize(kept);
+    }
+}
+
+
+bool ValueNumbering::getKey(const Instruction* instruction, Key& key)
+{
+    const ArgumentInstruction* argument = 0;
+    const ConstantInstruction* constant = 0;
+    const IntrinsicInstruction* intrinsic = 0;
+
+    key.attribute = 0;
+    key.left = 0;
+    key.right = 0;
+
+    if ((argument = dynamic_cast<const ArgumentInstruction*>(instruction))) {
+        key.operation = argumentOperation;
+        key.attribute = argument->getIndex();
+    }
+    else if ((constant =
+              dynamic_cast<const ConstantInstruction*>(instruction))) {
+        key.operation = constantOperation;
+        key.attribute = constant->getValue();
+    }
+    else if ((intrinsic =
+              dynamic_cast<const IntrinsicInstruction*>(instruction))) {
+        key.operation = intrinsic->getIntrinsic();
+        key.left = intrinsic->getOperand(0);
+        key.right = intrinsic->getOperand(1);
+        if (intrinsic->isCommutative() &&
+            std::less<Instruction*>()(key.right, key.left))
+            std::swap(key.left, key.right);
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
@@ -0,0 +1,86 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_IR_VALUENUMBERING_H_
+#define UETLI_IR_VALUENUMBERING_H_
+
+#include <map>
+
+#include "Function.h"
+
+namespace uetli
+{
+    namespace ir
+    {
+        class ValueNumbering;
+    }
+}
+
+
+///
+/// \brief replaces instructions computing a value which is already known
+///
+/// Every argument, constant and intrinsic is identified by its operation
+/// and its operands (in a fixed order if the operation is commutative). An
+/// instruction equal to an earlier one is replaced by it and deleted, so
+/// equal constants are only materialized once and common subexpressions
+/// are computed once.
+///
+/// The values are numbered per block, which covers the whole function as
+/// long as it consists of a single block. A division is replaced as well:
+/// the earlier one has already trapped if the divisor was zero.
+///
+class uetli::ir::ValueNumbering
+{
+    struct Key
+    {
+        /// distinguishes arguments, constants and the intrinsics
+        int operation;
+
+        /// the index of an argument or the value of a constant
+        code::Word attribute;
+
+        Instruction* left;
+        Instruction* right;
+
+        bool operator < (const Key& other) const;
+    };
+
+    std::map<Key, Instruction*> values;
+
+public:
+    ///
+    /// \brief number the values and delete the redundant instructions
+    ///
+    void optimize(Function* function);
+
+private:
+    ///
+    /// \return <code>false</code>, if the value of the instruction can not
+    ///         be numbered (calls and returns)
+    ///
+    static bool getKey(const Instruction* instruction, Key& key);
+};
+
+
+#endif // UETLI_IR_VALUENUMBERING_H_
+
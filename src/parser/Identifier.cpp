@@ -43,6 +43,24 @@ Identifier& Identifier::append(const std::string& segment)
 }
 
 
+const std::string& Identifier::getLastSegment(void) const
+{
+    return segments.back();
+}
+
+
+size_t Identifier::getSegmentCount(void) const
+{
+    return segments.size();
+}
+
+
+const std::string& Identifier::getSegment(size_t index) const
+{
+    return segments[index];
+}
+
+
 std::string Identifier::getAsString(void) const
 {
     std::string identifier;
@@ -69,6 +87,9 @@ std::string Identifier::getAssemblySymbol(void) const
         else if (seg == "+") {
             identifier += "PLUS";
         }
+        else if (seg == "/") {
+            identifier += "SLASH";
+        }
         else {
             identifier += segments[i];
         }
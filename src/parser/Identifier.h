@@ -54,6 +54,16 @@ public:
     Identifier(const std::string& first);
 
     Identifier& append(const std::string& segment);
+
+    ///
+    /// \return the last segment of the identifier (e.g. the method name in
+    ///         <code>Class::method</code>)
+    ///
+    const std::string& getLastSegment(void) const;
+
+    size_t getSegmentCount(void) const;
+    const std::string& getSegment(size_t index) const;
+
     std::string getAsString(void) const;
     std::string getAssemblySymbol(void) const;
 };
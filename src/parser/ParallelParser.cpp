@@ -0,0 +1,199 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "ParallelParser.h"
+#include "Scanner.h"
+#include "SourceFile.h"
+#include "../util/Trace.h"
+
+using uetli::parser::ClassDeclaration;
+using uetli::parser::ParallelParser;
+using uetli::parser::ParserException;
+
+
+ParallelParser::FileTask::FileTask(const std::string& filename, FILE* stream,
+                                   bool handScanner) :
+    filename(filename), stream(stream), handScanner(handScanner),
+    context(arena),
+    failed(false)
+{
+}
+
+
+void ParallelParser::FileTask::run(void) throw()
+{
+    util::TraceSpan span("parse file");
+    if (span.isRecording())
+        span.setName(filename.empty() ? "<stdin>" : filename);
+
+    try {
+        parseFile();
+    }
+    catch (ParserException& pe) {
+        failed = true;
+        errorMessage = pe.getErrorMessage();
+    }
+    catch (...) {
+        failed = true;
+        errorMessage = "compilation terminated due to fatal error";
+    }
+
+    // only keep the classes of files which were parsed completely
+    if (failed)
+        context.classes.clear();
+
+    if (failed && !filename.empty())
+        errorMessage = filename + ": " + errorMessage;
+}
+
+
+bool ParallelParser::FileTask::hasFailed(void) const
+{
+    return failed;
+}
+
+
+const std::string& ParallelParser::FileTask::getErrorMessage(void) const
+{
+    return errorMessage;
+}
+
+
+const std::vector<ClassDeclaration*>&
+ParallelParser::FileTask::getClasses(void) const
+{
+    return context.classes;
+}
+
+
+void ParallelParser::FileTask::parseFile(void)
+{
+    if (handScanner && stream != 0) {
+        SourceFile source(stream);
+        parseSource(source);
+        return;
+    }
+    else if (handScanner) {
+        SourceFile source(filename);
+        parseSource(source);
+        return;
+    }
+
+    if (stream != 0) {
+        parser::parse(context, stream);
+        return;
+    }
+
+    FILE* input = ::fopen(filename.c_str(), "r");
+    if (input == 0)
+        throw ParserException("could not open file");
+
+    try {
+        parser::parse(context, input);
+    }
+    catch (...) {
+        ::fclose(input);
+        throw;
+    }
+    ::fclose(input);
+}
+
+
+void ParallelParser::FileTask::parseSource(const SourceFile& source)
+{
+    Scanner scanner(source.getData(), source.getSize());
+    parser::parse(context, scanner);
+}
+
+
+ParallelParser::ParallelParser(bool handScanner) :
+    handScanner(handScanner)
+{
+}
+
+
+ParallelParser::~ParallelParser(void)
+{
+    release();
+}
+
+
+void ParallelParser::release(void)
+{
+    for (size_t i = 0; i < tasks.size(); i++) {
+        delete tasks[i];
+    }
+    tasks.clear();
+}
+
+
+void ParallelParser::addFile(const std::string& filename)
+{
+    tasks.push_back(new FileTask(filename, 0, handScanner));
+}
+
+
+void ParallelParser::addStream(FILE* stream)
+{
+    tasks.push_back(new FileTask("", stream, handScanner));
+}
+
+
+void ParallelParser::parse(size_t threadCount)
+{
+    util::TraceSpan span("parsing");
+
+    if (threadCount > tasks.size())
+        threadCount = tasks.size();
+
+    if (threadCount <= 1) {
+        // no need to start any threads
+        for (size_t i = 0; i < tasks.size(); i++) {
+            tasks[i]->run();
+        }
+    }
+    else {
+        util::ThreadPool pool(threadCount);
+        for (size_t i = 0; i < tasks.size(); i++) {
+            pool.submit(tasks[i]);
+        }
+        pool.wait();
+    }
+
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (tasks[i]->hasFailed())
+            throw ParserException(tasks[i]->getErrorMessage());
+    }
+}
+
+
+std::vector<ClassDeclaration*> ParallelParser::getClasses(void) const
+{
+    std::vector<ClassDeclaration*> classes;
+    for (size_t i = 0; i < tasks.size(); i++) {
+        const std::vector<ClassDeclaration*>& fileClasses =
+                tasks[i]->getClasses();
+        classes.insert(classes.end(), fileClasses.begin(), fileClasses.end());
+    }
+    return classes;
+}
+
@@ -0,0 +1,129 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_PARSER_PARALLELPARSER_H_
+#define UETLI_PARSER_PARALLELPARSER_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "uetli_parser.h"
+#include "../util/Arena.h"
+#include "../util/ThreadPool.h"
+
+namespace uetli
+{
+    namespace parser
+    {
+        class ParallelParser;
+        class SourceFile;
+    }
+}
+
+
+///
+/// \brief parses several source files concurrently
+///
+/// Each file is parsed on a thread pool with its own ParseContext and its
+/// own arena. The parsed classes of all files are then merged in the order
+/// in which the files were added, so the result does not depend on the
+/// scheduling of the threads.
+///
+class uetli::parser::ParallelParser
+{
+    ///
+    /// \brief parses one file
+    ///
+    class FileTask : public util::ThreadPool::Task
+    {
+        /// the file name, or an empty string if the stream is given
+        std::string filename;
+        FILE* stream;
+        bool handScanner;
+
+        util::Arena arena;
+        ParseContext context;
+
+        bool failed;
+        std::string errorMessage;
+    public:
+        FileTask(const std::string& filename, FILE* stream,
+                 bool handScanner);
+
+        virtual void run(void) throw();
+
+        bool hasFailed(void) const;
+        const std::string& getErrorMessage(void) const;
+        const std::vector<ClassDeclaration*>& getClasses(void) const;
+
+    private:
+        void parseFile(void);
+        void parseSource(const SourceFile& source);
+    };
+
+    bool handScanner;
+    std::vector<FileTask*> tasks;
+
+    ParallelParser(const ParallelParser&);
+    ParallelParser& operator = (const ParallelParser&);
+public:
+    ///
+    /// \param handScanner true if the hand-written scanner should be used
+    ///                    instead of the flex lexer
+    ///
+    ParallelParser(bool handScanner);
+
+    ~ParallelParser(void);
+
+    void addFile(const std::string& filename);
+
+    ///
+    /// \brief add a stream which is read until its end (e.g. stdin)
+    ///
+    void addStream(FILE* stream);
+
+    ///
+    /// \brief parse all added files
+    ///
+    /// \param threadCount number of threads used for parsing
+    ///
+    /// \throws ParserException for the first file (in the order they were
+    ///         added) which could not be parsed
+    ///
+    void parse(size_t threadCount);
+
+    ///
+    /// \return the classes of all files in the order the files were added.
+    ///         They stay valid as long as this object exists.
+    ///
+    std::vector<ClassDeclaration*> getClasses(void) const;
+
+    ///
+    /// \brief frees the parse trees of all files
+    ///
+    void release(void);
+};
+
+
+#endif // UETLI_PARSER_PARALLELPARSER_H_
+
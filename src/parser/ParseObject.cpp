@@ -26,33 +26,21 @@ using namespace uetli::parser;
 using namespace uetli;
 
 
-ClassDeclaration::ClassDeclaration(
-        const std::string& name,
-        const std::vector<FeatureDeclaration*>& features) :
+ClassDeclaration::ClassDeclaration(util::Symbol name,
+                                   const FeatureList& features) :
     name(name), features(features)
 {
 }
 
 
-ClassDeclaration::~ClassDeclaration(void)
-{
-    typedef std::vector<FeatureDeclaration*>::iterator FeatIterator;
-
-    for (FeatIterator i = features.begin(); i != features.end(); i++) {
-        delete *i;
-    }
-    features.clear();
-}
-
-
 bool ClassDeclaration::dependsOn(const ClassDeclaration&) const
 {
     return false;
 }
 
 
-FeatureDeclaration::FeatureDeclaration(const std::string& type,
-                                       const std::string& name) :
+FeatureDeclaration::FeatureDeclaration(util::Symbol type,
+                                       util::Symbol name) :
     type(type), name(name)
 {
 }
@@ -63,60 +51,41 @@ FeatureDeclaration::~FeatureDeclaration(void)
 }
 
 
-FieldDeclaration::FieldDeclaration(const std::string& type,
-                                   const std::string& name) :
+FieldDeclaration::FieldDeclaration(util::Symbol type,
+                                   util::Symbol name) :
     FeatureDeclaration(type, name)
 {
 }
 
 
-MethodDeclaration::MethodDeclaration(const std::string& type,
-                                     const std::string& name,
+MethodDeclaration::MethodDeclaration(util::Symbol type,
+                                     util::Symbol name,
                                      DoEndBlock* body) :
     FeatureDeclaration(type, name), body(body)
 {
 }
 
 
-MethodDeclaration::~MethodDeclaration(void)
-{
-    typedef std::vector<ArgumentDeclaration*>::iterator ArgIterator;
-    for (ArgIterator i = arguments.begin(); i != arguments.end(); i++) {
-        delete *i;
-    }
-    arguments.clear();
-}
-
-
 Statement::~Statement(void)
 {
 }
 
 
-NewVariableStatement::NewVariableStatement(const std::string& type,
-                                           const std::string& name) :
-    type(type), name(name)
+NewVariableStatement::NewVariableStatement(util::Symbol type,
+                                           util::Symbol name) :
+    type(type), name(name), initialValue(0)
 {
 }
 
 
-NewVariableStatement::NewVariableStatement(const std::string& type,
-                                           const std::string& name,
+NewVariableStatement::NewVariableStatement(util::Symbol type,
+                                           util::Symbol name,
                                            Expression* initialValue) :
     type(type), name(name), initialValue(initialValue)
 {
 }
 
 
-NewVariableStatement::~NewVariableStatement(void)
-{
-    if (initialValue != 0) {
-        delete initialValue;
-        initialValue = 0;
-    }
-}
-
-
 uetli::semantic::Statement* NewVariableStatement::getAttributedStatement(
         semantic::Scope* scope) const
 {
@@ -150,7 +119,7 @@ semantic::Statement* AssignmentStatement::getAttributedStatement(
 }
 
 
-DoEndBlock::DoEndBlock(const std::vector<Statement *>& instructions):
+DoEndBlock::DoEndBlock(const StatementList& instructions):
     statements(instructions)
 {
 }
@@ -161,7 +130,7 @@ semantic::Statement* DoEndBlock::getAttributedStatement(
 {
     semantic::StatementBlock* block = new semantic::StatementBlock(scope);
 
-    typedef std::vector<Statement*>::const_iterator StatIterator;
+    typedef StatementList::const_iterator StatIterator;
     for (StatIterator i = statements.begin(); i != statements.end(); i++) {
         block->addStatement(
                 (*i)->getAttributedStatement(block->getLocalScope())
@@ -178,7 +147,7 @@ Expression::~Expression(void)
 
 
 CallOrVariableStatement::CallOrVariableStatement
-    (Expression* target, const std::string& methodName) :
+    (Expression* target, util::Symbol methodName) :
     methodName(methodName), target(target)
 {
 }
@@ -186,8 +155,8 @@ CallOrVariableStatement::CallOrVariableStatement
 
 CallOrVariableStatement::CallOrVariableStatement(
         Expression* target,
-        const std::string& methodName,
-        const std::vector<Expression*>& arguments) :
+        util::Symbol methodName,
+        const ExpressionList& arguments) :
     methodName(methodName), target(target), arguments(arguments)
 {
 }
@@ -235,7 +204,7 @@ uetli::semantic::Statement* CallOrVariableStatement::getAttributedStatement(
 }
 
 
-OperationExpression::OperationExpression(const std::string& operatorToken) :
+OperationExpression::OperationExpression(util::Symbol operatorToken) :
     operatorToken(operatorToken)
 {
 }
@@ -243,7 +212,7 @@ OperationExpression::OperationExpression(const std::string& operatorToken) :
 
 BinaryOperationExpression::BinaryOperationExpression(
         Expression* left, Expression* right,
-        const std::string& operatorToken) :
+        util::Symbol operatorToken) :
     OperationExpression(operatorToken), left(left), right(right)
 {
 }
@@ -262,7 +231,8 @@ uetli::semantic::Expression* BinaryOperationExpression::getAttributedExpression(
         ->findMethod(this->operatorToken);
 
     if (operationMethod == 0) {
-        std::cerr << "operation " << this->operatorToken <<
+        std::cerr << "operation " <<
+            util::SymbolTable::getString(this->operatorToken) <<
             " not defined" << std::endl;
         throw "undefined operator!";
 //        operationMethod = new semantic::Method(0, 0,
@@ -280,7 +250,7 @@ uetli::semantic::Expression* BinaryOperationExpression::getAttributedExpression(
 UnaryOperationExpression::UnaryOperationExpression(
         Expression* value,
         Fix fix,
-        const std::string& operatorToken) :
+        util::Symbol operatorToken) :
     OperationExpression(operatorToken), value(value), fix(fix)
 {
 }
@@ -303,8 +273,8 @@ uetli::semantic::Expression* UnaryOperationExpression::getAttributedExpression(
 }
 
 
-ArgumentDeclaration::ArgumentDeclaration(const std::string& type,
-                                         const std::string& name) :
+ArgumentDeclaration::ArgumentDeclaration(util::Symbol type,
+                                         util::Symbol name) :
     type(type), name(name)
 {
 }
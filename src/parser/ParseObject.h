@@ -25,6 +25,8 @@
 #include <string>
 #include <vector>
 #include "../semantic/AttributedSyntaxTree.h"
+#include "../util/SymbolTable.h"
+#include "../util/Arena.h"
 
 
 namespace uetli
@@ -50,6 +52,16 @@ namespace uetli
                 struct UnaryOperationExpression;
 
             struct ArgumentDeclaration;
+
+        /// lists of child nodes, allocated in the arena of the parse tree
+        typedef std::vector<FeatureDeclaration*,
+                util::ArenaAllocator<FeatureDeclaration*> > FeatureList;
+        typedef std::vector<Statement*,
+                util::ArenaAllocator<Statement*> > StatementList;
+        typedef std::vector<Expression*,
+                util::ArenaAllocator<Expression*> > ExpressionList;
+        typedef std::vector<ArgumentDeclaration*,
+                util::ArenaAllocator<ArgumentDeclaration*> > ArgumentList;
     }
 }
 
@@ -61,6 +73,10 @@ namespace uetli
 /// This structure is the base class for every type of object
 /// occurring in the syntax tree of the parsed file.
 ///
+/// All parse objects of a compilation unit are allocated in one
+/// util::Arena and are never destroyed individually. The whole tree is
+/// freed by releasing the arena.
+///
 struct uetli::parser::ParseObject
 {
 };
@@ -71,13 +87,10 @@ struct uetli::parser::ParseObject
 ///
 struct uetli::parser::ClassDeclaration : virtual public ParseObject
 {
-    std::string name;
-    std::vector<FeatureDeclaration*> features;
+    util::Symbol name;
+    FeatureList features;
 
-    ClassDeclaration(const std::string& name,
-                     const std::vector<FeatureDeclaration*>& features);
-
-    ~ClassDeclaration(void);
+    ClassDeclaration(util::Symbol name, const FeatureList& features);
 
     ///
     /// \brief compares
@@ -96,10 +109,10 @@ struct uetli::parser::FeatureDeclaration : virtual public ParseObject
 {
     /// \brief the return type of this feature (either its return type, if it's
     ///        a method or the variable type, if it's a field)
-    std::string type;
-    std::string name;
+    util::Symbol type;
+    util::Symbol name;
 protected:
-    FeatureDeclaration(const std::string& type, const std::string& name);
+    FeatureDeclaration(util::Symbol type, util::Symbol name);
 public:
     virtual ~FeatureDeclaration(void);
 };
@@ -110,7 +123,7 @@ public:
 ///
 struct uetli::parser::FieldDeclaration : virtual public FeatureDeclaration
 {
-    FieldDeclaration(const std::string& type, const std::string& name);
+    FieldDeclaration(util::Symbol type, util::Symbol name);
 };
 
 
@@ -119,11 +132,9 @@ struct uetli::parser::FieldDeclaration : virtual public FeatureDeclaration
 ///
 struct uetli::parser::MethodDeclaration : virtual public FeatureDeclaration
 {
-    std::vector<ArgumentDeclaration*> arguments;
+    ArgumentList arguments;
     DoEndBlock* body;
-    MethodDeclaration(const std::string& type, const std::string& name,
-                      DoEndBlock* body);
-    ~MethodDeclaration(void);
+    MethodDeclaration(util::Symbol type, util::Symbol name, DoEndBlock* body);
 };
 
 
@@ -141,16 +152,14 @@ struct uetli::parser::Statement : virtual public ParseObject
 ///
 struct uetli::parser::NewVariableStatement : virtual public Statement
 {
-    std::string type;
-    std::string name;
+    util::Symbol type;
+    util::Symbol name;
     Expression* initialValue;
 
-    NewVariableStatement(const std::string& type, const std::string& name);
-    NewVariableStatement(const std::string& type, const std::string& name,
+    NewVariableStatement(util::Symbol type, util::Symbol name);
+    NewVariableStatement(util::Symbol type, util::Symbol name,
                          Expression* initialValue);
     
-    ~NewVariableStatement(void);
-    
     virtual semantic::Statement* getAttributedStatement(
             semantic::Scope* scope) const;
 };
@@ -178,9 +187,9 @@ struct uetli::parser::AssignmentStatement : virtual public Statement
 ///
 struct uetli::parser::DoEndBlock : virtual public Statement
 {
-    std::vector<Statement*> statements;
+    StatementList statements;
 
-    DoEndBlock(const std::vector<Statement*>& statements);
+    DoEndBlock(const StatementList& statements);
 
     virtual semantic::Statement* getAttributedStatement(
             semantic::Scope* scope) const;
@@ -214,7 +223,7 @@ struct uetli::parser::CallOrVariableStatement :
         virtual public Expression
 {
     /// the name of the called method or the accessed variable
-    std::string methodName;
+    util::Symbol methodName;
 
     /// the target expression (e.g. in the case of
     /// <code>var.methodName(5)</code>, <code>var</code> is the target)
@@ -222,11 +231,11 @@ struct uetli::parser::CallOrVariableStatement :
 
     /// the arguments which are specified to the call (is always empty for a
     /// variable access)
-    std::vector<Expression*> arguments;
+    ExpressionList arguments;
 
-    CallOrVariableStatement(Expression* target, const std::string& methodName);
-    CallOrVariableStatement(Expression* target, const std::string& methodName,
-                  const std::vector<Expression*>& arguments);
+    CallOrVariableStatement(Expression* target, util::Symbol methodName);
+    CallOrVariableStatement(Expression* target, util::Symbol methodName,
+                  const ExpressionList& arguments);
 
     virtual uetli::semantic::Expression* getAttributedExpression(
             semantic::Scope* scope) const;
@@ -238,9 +247,9 @@ struct uetli::parser::CallOrVariableStatement :
 
 struct uetli::parser::OperationExpression : virtual public Expression
 {
-    std::string operatorToken;
+    util::Symbol operatorToken;
 
-    OperationExpression(const std::string& operatorToken);
+    OperationExpression(util::Symbol operatorToken);
 
     virtual uetli::semantic::Expression* getAttributedExpression(
             semantic::Scope* scope) const = 0;
@@ -253,7 +262,7 @@ struct uetli::parser::BinaryOperationExpression : public OperationExpression
     Expression* right;
 
     BinaryOperationExpression(Expression* left, Expression* right,
-                              const std::string& operatorToken);
+                              util::Symbol operatorToken);
 
     virtual uetli::semantic::Expression* getAttributedExpression(
             semantic::Scope* scope) const;
@@ -271,19 +280,19 @@ struct uetli::parser::UnaryOperationExpression : public OperationExpression
     Fix fix;
 
     UnaryOperationExpression(Expression* value, Fix fix,
-                             const std::string& operatorToken);
+                             util::Symbol operatorToken);
 
     virtual uetli::semantic::Expression* getAttributedExpression(
             semantic::Scope* scope) const;
 };
 
 
-struct uetli::parser::ArgumentDeclaration
+struct uetli::parser::ArgumentDeclaration : virtual public ParseObject
 {
-    std::string type;
-    std::string name;
+    util::Symbol type;
+    util::Symbol name;
 
-    ArgumentDeclaration(const std::string& type, const std::string& name);
+    ArgumentDeclaration(util::Symbol type, util::Symbol name);
 };
 
 
@@ -27,22 +27,38 @@
 #include <iostream>
 #include <cstdio>
 #include "ParseObject.h"
+#include "Scanner.h"
 #include "uetli_parser.h"
 using namespace uetli::parser;
+using uetli::util::SymbolTable;
 
-extern int uetli_parser_lex();
+%}
 
-int uetli_parser_error(const char*)
-{
-    throw ParserException("syntax error");
+%code requires {
+#include "ParseObject.h"
+#include "uetli_parser.h"
 }
 
-std::vector<uetli::parser::ClassDeclaration*>* parsedClasses = 0;
+%code provides {
+int uetli_parser_lex(UETLI_PARSER_STYPE* value,
+                     uetli::parser::ParseContext* context);
+}
 
+%code {
+extern int uetli_flex_lex(UETLI_PARSER_STYPE* value, void* scanner);
 
-%}
+void uetli_parser_error(ParseContext*, const char*)
+{
+    throw ParserException("syntax error");
+}
+}
 
 %define api.prefix {uetli_parser_}
+%define api.pure full
+
+/* all state of a parse is kept in the context, so several sources can be
+   parsed at the same time */
+%param {uetli::parser::ParseContext* context}
 
 /*
 //%skeleton "lalr1.cc" // generate C++ parser
@@ -53,11 +69,10 @@ std::vector<uetli::parser::ClassDeclaration*>* parsedClasses = 0;
 //%name-prefix "uetli_parser_"
 */
 %union {
-    std::vector<uetli::parser::ClassDeclaration*>* classes;
-    std::vector<uetli::parser::Statement*>* statements;
-    std::vector<uetli::parser::FeatureDeclaration*>* featureList;
-    std::vector<uetli::parser::ArgumentDeclaration*>* argumentList;
-    std::vector<uetli::parser::Expression*>* expressionList;
+    uetli::parser::StatementList* statements;
+    uetli::parser::FeatureList* featureList;
+    uetli::parser::ArgumentList* argumentList;
+    uetli::parser::ExpressionList* expressionList;
 
 
     uetli::parser::ClassDeclaration* classDeclaration;
@@ -79,14 +94,13 @@ std::vector<uetli::parser::ClassDeclaration*>* parsedClasses = 0;
     uetli::parser::UnaryOperationExpression* unaryOperationExpression;
 
     uetli::parser::ArgumentDeclaration* argumentDeclaration;
-    std::string* string;
-    const char* cString;
+    uetli::util::Symbol symbol;
 
     int token;
 };
 
 
-%token <string> IDENTIFIER
+%token <symbol> IDENTIFIER
 %token <token> CLASS DO END
 %token <token> NEW_LINE
 %token <token> COLON COMMA DOT ASSIGN OPERATOR
@@ -94,7 +108,6 @@ std::vector<uetli::parser::ClassDeclaration*>* parsedClasses = 0;
 
 %type <token> pnl;
 
-%type <classes> classes
 %type <statements> statements
 %type <featureList> featureList
 %type <argumentList> argumentList
@@ -116,7 +129,7 @@ std::vector<uetli::parser::ClassDeclaration*>* parsedClasses = 0;
 %type <binaryOperationExpression> binaryOperationExpression
 %type <unaryOperationExpression> unaryOperationExpression
 
-%type <cString> operator
+%type <symbol> operator
 
 %type <argumentDeclaration> argumentDeclaration
 
@@ -130,11 +143,9 @@ std::vector<uetli::parser::ClassDeclaration*>* parsedClasses = 0;
 
 compilationUnit:
     pnl {
-        parsedClasses = new std::vector<ClassDeclaration*>();
     }
     |
     pnl classes pnl {
-        parsedClasses = $2;
     };
 
 
@@ -150,25 +161,23 @@ pnl:
 /* list of class declarations */
 classes:
     classDeclaration {
-        $$ = new std::vector<ClassDeclaration*>();
-        $$->push_back($1);
+        context->classes.push_back($1);
     }
     |
     classes pnl classDeclaration {
-        $$->push_back($3);
+        context->classes.push_back($3);
     };
 
 
 classDeclaration:
     CLASS IDENTIFIER featureList END {
-        $$ = new ClassDeclaration(*$2, *$3);
-        delete $2; delete $3; $2 = 0; $3 = 0;
+        $$ = new (*context->arena) ClassDeclaration($2, *$3);
     };
 
 
 featureList:
     pnl {
-        $$ = new std::vector<FeatureDeclaration*>();
+        $$ = new (*context->arena) FeatureList(*context->arena);
     }
     |
     featureList featureDeclaration pnl {
@@ -189,37 +198,34 @@ featureDeclaration:
 
 fieldDeclaration:
     IDENTIFIER COLON IDENTIFIER {
-        $$ = new FieldDeclaration(*$3, *$1);
-        delete $3; delete $1; $1 = $3 = 0;
+        $$ = new (*context->arena) FieldDeclaration($3, $1);
     };
 
 
 methodDeclaration:
     IDENTIFIER COLON IDENTIFIER doEndBlock {
-        $$ = new MethodDeclaration(*$3, *$1, $4);
-        delete $3; delete $1; $1 = $3 = 0;
+        $$ = new (*context->arena) MethodDeclaration($3, $1, $4);
     }
     |
     IDENTIFIER doEndBlock {
-        $$ = new MethodDeclaration("", *$1, $2);
-        delete $1; $1 = 0;
+        $$ = new (*context->arena) MethodDeclaration(
+                SymbolTable::emptySymbol, $1, $2);
     }
     |
     IDENTIFIER
         ROUND_LEFT argumentList ROUND_RIGHT COLON IDENTIFIER doEndBlock {
-        $$ = new MethodDeclaration(*$6, *$1, $7);
-        delete $6; delete $1; $1 = $6 = 0;
+        $$ = new (*context->arena) MethodDeclaration($6, $1, $7);
     }
     |
     IDENTIFIER ROUND_LEFT argumentList ROUND_RIGHT doEndBlock {
-        $$ = new MethodDeclaration("", *$1, $5);
-        delete $1; $1 = 0;
+        $$ = new (*context->arena) MethodDeclaration(
+                SymbolTable::emptySymbol, $1, $5);
     };
 
 
 argumentList:
     argumentDeclaration {
-        $$ = new std::vector<ArgumentDeclaration*>();
+        $$ = new (*context->arena) ArgumentList(*context->arena);
         $$->push_back($1);
     }
     |
@@ -231,21 +237,19 @@ argumentList:
 
 argumentDeclaration:
     IDENTIFIER COLON IDENTIFIER {
-        $$ = new ArgumentDeclaration(*$3, *$1);
-        delete $3; delete $1; $1 = $3 = 0;
+        $$ = new (*context->arena) ArgumentDeclaration($3, $1);
     };
 
 
 doEndBlock:
     DO statements END {
-        $$ = new DoEndBlock(*$2);
-        delete $2; $2 = 0;
+        $$ = new (*context->arena) DoEndBlock(*$2);
     };
 
 
 statements:
     pnl {
-        $$ = new std::vector<Statement*>();
+        $$ = new (*context->arena) StatementList(*context->arena);
     }
     |
     statements statement pnl {
@@ -270,30 +274,26 @@ statement:
 
 callOrVariableStatement:
     IDENTIFIER {
-        $$ = new CallOrVariableStatement(0, *$1);
-        delete $1; $1 = 0;
+        $$ = new (*context->arena) CallOrVariableStatement(0, $1);
     }
     |
     IDENTIFIER ROUND_LEFT expressionList ROUND_RIGHT {
-        $$ = new CallOrVariableStatement(0, *$1, *$3);
-        delete $1; delete $3; $1 = 0; $3 = 0;
+        $$ = new (*context->arena) CallOrVariableStatement(0, $1, *$3);
     }
     |
     expression DOT IDENTIFIER {
-        $$ = new CallOrVariableStatement($1, *$3);
-        delete $3; $3 = 0;
+        $$ = new (*context->arena) CallOrVariableStatement($1, $3);
     }
     |
     expression DOT IDENTIFIER ROUND_LEFT expressionList ROUND_RIGHT {
-        $$ = new CallOrVariableStatement($1, *$3, *$5);
-        delete $3; $3 = 0; delete $5; $5 = 0;
+        $$ = new (*context->arena) CallOrVariableStatement($1, $3, *$5);
     };
 
 
 /* list of effective arguments */
 expressionList:
     expression {
-        $$ = new std::vector<Expression*>();
+        $$ = new (*context->arena) ExpressionList(*context->arena);
         $$->push_back($1);
     }
     |
@@ -329,30 +329,30 @@ operationExpression:
 
 binaryOperationExpression:
     expression operator expression {
-        $$ = new BinaryOperationExpression($1, $3, $2);
+        $$ = new (*context->arena) BinaryOperationExpression($1, $3, $2);
     };
 
 
 unaryOperationExpression:
     expression operator {
-        $$ = new UnaryOperationExpression($1,
+        $$ = new (*context->arena) UnaryOperationExpression($1,
             UnaryOperationExpression::SUFFIX, $2);
     }
     |
     operator expression {
-        $$ = new UnaryOperationExpression($2,
+        $$ = new (*context->arena) UnaryOperationExpression($2,
             UnaryOperationExpression::PREFIX, $1);
     };
 
 
 operator:
-    PLUS { $$ = "+"; }
+    PLUS { $$ = SymbolTable::intern("+"); }
     |
-    MINUS { $$ = "-"; }
+    MINUS { $$ = SymbolTable::intern("-"); }
     |
-    ASTERISK { $$ = "*"; }
+    ASTERISK { $$ = SymbolTable::intern("*"); }
     |
-    SLASH { $$ = "/"; };
+    SLASH { $$ = SymbolTable::intern("/"); };
 
 
 paranthesesExpression:
@@ -363,14 +363,13 @@ paranthesesExpression:
 
 assignmentStatement:
     callOrVariableStatement ASSIGN expression {
-        $$ = new AssignmentStatement($1, $3);
+        $$ = new (*context->arena) AssignmentStatement($1, $3);
     };
 
 
 newVariableStatement:
     IDENTIFIER COLON IDENTIFIER {
-        $$ = new NewVariableStatement(*$3, *$1);
-        delete $3; delete $1; $3 = 0; $1 = 0;
+        $$ = new (*context->arena) NewVariableStatement($3, $1);
     };
 
 
@@ -378,3 +377,29 @@ newVariableStatement:
 %%
 
 
+int uetli_parser_lex(UETLI_PARSER_STYPE* value, ParseContext* context)
+{
+    Scanner* scanner = context->scanner;
+    if (scanner == 0)
+        return uetli_flex_lex(value, context->flexScanner);
+
+    // indexed by Scanner::TokenType
+    static const int tokens[] = {
+        0, NEW_LINE, COLON, COMMA, ASSIGN, DOT, PLUS, MINUS, ASTERISK, SLASH,
+        ROUND_LEFT, ROUND_RIGHT, CLASS, DO, END, IDENTIFIER
+    };
+
+    Scanner::Token token = scanner->nextToken();
+    switch (token.type) {
+        case Scanner::TOKEN_IDENTIFIER:
+            value->symbol = SymbolTable::intern(
+                        scanner->getText(token), token.length);
+            return IDENTIFIER;
+        case Scanner::TOKEN_UNKNOWN:
+            printf("Unknown token!\n");
+            return 0;
+        default:
+            return value->token = tokens[token.type];
+    }
+}
+
@@ -0,0 +1,308 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "Scanner.h"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#elif defined(__SSE2__)
+#   include <emmintrin.h>
+#endif
+
+using uetli::parser::Scanner;
+
+
+static inline bool isIdentifierStart(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+
+static inline bool isIdentifierCharacter(char c)
+{
+    return isIdentifierStart(c) || (c >= '0' && c <= '9');
+}
+
+
+static inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+
+#if defined(__AVX2__)
+
+/// number of characters classified at once
+static const size_t vectorSize = 32;
+
+
+///
+/// \return a bitmask with bit i set if character i is an identifier
+///         character
+///
+static inline unsigned int matchIdentifierCharacters(const char* text)
+{
+    __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text));
+
+    // setting bit 5 maps upper case letters onto lower case ones; the signed
+    // comparisons reject all characters >= 0x80
+    __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+    __m256i letter = _mm256_and_si256(
+                _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+    __m256i digit = _mm256_and_si256(
+                _mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+    __m256i underscore = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_'));
+
+    return (unsigned int) _mm256_movemask_epi8(
+                _mm256_or_si256(_mm256_or_si256(letter, digit), underscore));
+}
+
+
+///
+/// \return a bitmask with bit i set if character i is a blank
+///
+static inline unsigned int matchBlanks(const char* text)
+{
+    __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text));
+    return (unsigned int) _mm256_movemask_epi8(_mm256_or_si256(
+                _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')),
+                _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\t'))));
+}
+
+#elif defined(__SSE2__)
+
+/// number of characters classified at once
+static const size_t vectorSize = 16;
+
+
+///
+/// \return a bitmask with bit i set if character i is an identifier
+///         character
+///
+static inline unsigned int matchIdentifierCharacters(const char* text)
+{
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+
+    // setting bit 5 maps upper case letters onto lower case ones; the signed
+    // comparisons reject all characters >= 0x80
+    __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_and_si128(
+                _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    __m128i digit = _mm_and_si128(
+                _mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    __m128i underscore = _mm_cmpeq_epi8(c, _mm_set1_epi8('_'));
+
+    return (unsigned int) _mm_movemask_epi8(
+                _mm_or_si128(_mm_or_si128(letter, digit), underscore));
+}
+
+
+///
+/// \return a bitmask with bit i set if character i is a blank
+///
+static inline unsigned int matchBlanks(const char* text)
+{
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+    return (unsigned int) _mm_movemask_epi8(_mm_or_si128(
+                _mm_cmpeq_epi8(c, _mm_set1_epi8(' ')),
+                _mm_cmpeq_epi8(c, _mm_set1_epi8('\t'))));
+}
+
+#endif
+
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+///
+/// \return the number of trailing one bits of a mask with at least one
+///         zero bit
+///
+static inline unsigned int countTrailingOnes(unsigned int mask)
+{
+    return (unsigned int) __builtin_ctz(~mask);
+}
+
+#endif
+
+
+///
+/// \return the first character which is not an identifier character
+///
+static const char* skipIdentifierCharacters(const char* p, const char* end)
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+    // only whole vectors inside the source are loaded
+    while (size_t(end - p) >= vectorSize) {
+        unsigned int matches = matchIdentifierCharacters(p);
+        if (matches != (vectorSize == 32 ? 0xFFFFFFFFU : 0xFFFFU))
+            return p + countTrailingOnes(matches);
+        p += vectorSize;
+    }
+#endif
+    while (p != end && isIdentifierCharacter(*p))
+        p++;
+    return p;
+}
+
+
+///
+/// \return the first character which is not a blank
+///
+static const char* skipBlanks(const char* p, const char* end)
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+    // most blank runs are short, so a vector is only used if the first
+    // characters are blanks as well
+    while (size_t(end - p) >= vectorSize && isBlank(p[0]) && isBlank(p[1])) {
+        unsigned int matches = matchBlanks(p);
+        if (matches != (vectorSize == 32 ? 0xFFFFFFFFU : 0xFFFFU))
+            return p + countTrailingOnes(matches);
+        p += vectorSize;
+    }
+#endif
+    while (p != end && isBlank(*p))
+        p++;
+    return p;
+}
+
+
+Scanner::Scanner(const char* source, size_t length) :
+    source(source),
+    end(source + length),
+    position(source)
+{
+}
+
+
+Scanner::Token Scanner::nextToken(void)
+{
+    for (;;) {
+        position = skipBlanks(position, end);
+
+        // comments
+        if (end - position >= 2 && position[0] == '/' && position[1] == '*') {
+            const char* commentEnd = position + 2;
+            while (end - commentEnd >= 2 &&
+                   !(commentEnd[0] == '*' && commentEnd[1] == '/'))
+                commentEnd++;
+            if (end - commentEnd >= 2) {
+                position = commentEnd + 2;
+                continue;
+            }
+            // an unterminated comment is scanned as a slash
+        }
+        break;
+    }
+
+    Token token;
+    token.offset = position - source;
+    token.length = 1;
+
+    if (position == end) {
+        token.type = TOKEN_END_OF_INPUT;
+        token.length = 0;
+        return token;
+    }
+
+    const char* start = position;
+    switch (*position++) {
+        case '\n':
+            token.type = TOKEN_NEW_LINE;
+            break;
+        case ':':
+            if (position != end && *position == '=') {
+                position++;
+                token.type = TOKEN_ASSIGN;
+                token.length = 2;
+            }
+            else
+                token.type = TOKEN_COLON;
+            break;
+        case ',':
+            token.type = TOKEN_COMMA;
+            break;
+        case '.':
+            token.type = TOKEN_DOT;
+            break;
+        case '+':
+            token.type = TOKEN_PLUS;
+            break;
+        case '-':
+            token.type = TOKEN_MINUS;
+            break;
+        case '*':
+            token.type = TOKEN_ASTERISK;
+            break;
+        case '/':
+            token.type = TOKEN_SLASH;
+            break;
+        case '(':
+            token.type = TOKEN_ROUND_LEFT;
+            break;
+        case ')':
+            token.type = TOKEN_ROUND_RIGHT;
+            break;
+        default:
+            if (isIdentifierStart(*start)) {
+                position = skipIdentifierCharacters(position, end);
+                token.length = position - start;
+                token.type = getIdentifierType(start, token.length);
+            }
+            else
+                token.type = TOKEN_UNKNOWN;
+            break;
+    }
+    return token;
+}
+
+
+const char* Scanner::getText(const Token& token) const
+{
+    return source + token.offset;
+}
+
+
+Scanner::TokenType Scanner::getIdentifierType(const char* text, size_t length)
+{
+    switch (length) {
+        case 2:
+            if (memcmp(text, "do", 2) == 0)
+                return TOKEN_DO;
+            break;
+        case 3:
+            if (memcmp(text, "end", 3) == 0)
+                return TOKEN_END;
+            break;
+        case 5:
+            if (memcmp(text, "class", 5) == 0)
+                return TOKEN_CLASS;
+            break;
+    }
+    return TOKEN_IDENTIFIER;
+}
+
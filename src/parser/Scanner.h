@@ -0,0 +1,117 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_PARSER_SCANNER_H_
+#define UETLI_PARSER_SCANNER_H_
+
+#include <cstddef>
+
+namespace uetli
+{
+    namespace parser
+    {
+        class Scanner;
+    }
+}
+
+
+///
+/// \brief hand-written scanner working directly on a source in memory
+///
+/// It recognizes the same tokens as the flex lexer in Lexer.l. Tokens are
+/// not copied; they refer to their characters by offset and length.
+/// Runs of identifier characters and blanks are scanned 16 (SSE2) or 32
+/// (AVX2) characters at a time.
+///
+class uetli::parser::Scanner
+{
+public:
+    enum TokenType
+    {
+        TOKEN_END_OF_INPUT = 0,
+        TOKEN_NEW_LINE,
+        TOKEN_COLON,
+        TOKEN_COMMA,
+        TOKEN_ASSIGN,
+        TOKEN_DOT,
+        TOKEN_PLUS,
+        TOKEN_MINUS,
+        TOKEN_ASTERISK,
+        TOKEN_SLASH,
+        TOKEN_ROUND_LEFT,
+        TOKEN_ROUND_RIGHT,
+        TOKEN_CLASS,
+        TOKEN_DO,
+        TOKEN_END,
+        TOKEN_IDENTIFIER,
+
+        /// a character which does not start any token
+        TOKEN_UNKNOWN
+    };
+
+    struct Token
+    {
+        TokenType type;
+
+        /// position of the first character in the source
+        size_t offset;
+        size_t length;
+    };
+
+private:
+    const char* source;
+    const char* end;
+
+    /// the next character to scan
+    const char* position;
+
+public:
+    ///
+    /// \param source the characters to scan; they must stay valid as long
+    ///               as the scanner and its tokens are used
+    /// \param length the number of characters
+    ///
+    Scanner(const char* source, size_t length);
+
+    ///
+    /// \brief scan the next token
+    ///
+    /// Blanks and comments are skipped. At the end of the source, a token
+    /// of type TOKEN_END_OF_INPUT is returned.
+    ///
+    Token nextToken(void);
+
+    ///
+    /// \return a pointer to the first character of the token
+    ///
+    const char* getText(const Token& token) const;
+
+private:
+    ///
+    /// \return the type of an identifier, which may be a keyword
+    ///
+    static TokenType getIdentifierType(const char* text, size_t length);
+};
+
+
+#endif // UETLI_PARSER_SCANNER_H_
+
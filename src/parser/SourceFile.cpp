@@ -0,0 +1,107 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "SourceFile.h"
+#include "uetli_parser.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using uetli::parser::SourceFile;
+using uetli::parser::ParserException;
+
+
+SourceFile::SourceFile(const std::string& filename) :
+    data(0),
+    size(0),
+    mapped(false)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw ParserException("could not open file");
+
+    struct stat status;
+    if (::fstat(fd, &status) == 0 && S_ISREG(status.st_mode) &&
+        status.st_size > 0) {
+        void* mapping = ::mmap(0, (size_t) status.st_size, PROT_READ,
+                               MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data = static_cast<const char*>(mapping);
+            size = (size_t) status.st_size;
+            mapped = true;
+        }
+    }
+    ::close(fd);
+
+    // empty files cannot be mapped, and neither can pipes or devices
+    if (!mapped) {
+        FILE* stream = ::fopen(filename.c_str(), "rb");
+        if (stream == 0)
+            throw ParserException("could not open file");
+        read(stream);
+        ::fclose(stream);
+    }
+}
+
+
+SourceFile::SourceFile(FILE* stream) :
+    data(0),
+    size(0),
+    mapped(false)
+{
+    read(stream);
+}
+
+
+SourceFile::~SourceFile(void)
+{
+    if (mapped)
+        ::munmap(const_cast<char*>(data), size);
+}
+
+
+const char* SourceFile::getData(void) const
+{
+    return data;
+}
+
+
+size_t SourceFile::getSize(void) const
+{
+    return size;
+}
+
+
+void SourceFile::read(FILE* stream)
+{
+    char block[4096];
+    size_t read;
+    while ((read = ::fread(block, 1, sizeof block, stream)) > 0) {
+        buffer.insert(buffer.end(), block, block + read);
+    }
+
+    size = buffer.size();
+    data = size > 0 ? &buffer[0] : "";
+}
+
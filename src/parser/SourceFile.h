@@ -0,0 +1,82 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_PARSER_SOURCEFILE_H_
+#define UETLI_PARSER_SOURCEFILE_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace uetli
+{
+    namespace parser
+    {
+        class SourceFile;
+    }
+}
+
+
+///
+/// \brief the complete contents of a source file in memory
+///
+/// Regular files are mapped into memory, so they are not copied at all.
+/// Streams which cannot be mapped (like stdin) are read into a buffer.
+///
+class uetli::parser::SourceFile
+{
+    const char* data;
+    size_t size;
+
+    /// true if <code>data</code> points to a mapping which must be unmapped
+    bool mapped;
+
+    /// holds the contents if the file could not be mapped
+    std::vector<char> buffer;
+
+    SourceFile(const SourceFile&);
+    SourceFile& operator = (const SourceFile&);
+public:
+    ///
+    /// \brief map a file into memory
+    ///
+    /// \throws ParserException if the file cannot be read
+    ///
+    SourceFile(const std::string& filename);
+
+    ///
+    /// \brief read a stream until its end
+    ///
+    SourceFile(FILE* stream);
+
+    ~SourceFile(void);
+
+    const char* getData(void) const;
+    size_t getSize(void) const;
+
+private:
+    void read(FILE* stream);
+};
+
+
+#endif // UETLI_PARSER_SOURCEFILE_H_
+
@@ -21,8 +21,57 @@
 
 #include "uetli_parser.h"
 
+using uetli::parser::ParseContext;
 using uetli::parser::ParserException;
 
+
+// functions of the reentrant flex lexer
+extern int uetli_parser_lex_init(void** scanner);
+extern void uetli_parser_set_in(FILE* input, void* scanner);
+extern int uetli_parser_lex_destroy(void* scanner);
+
+
+ParseContext::ParseContext(util::Arena& arena) :
+    arena(&arena),
+    scanner(0),
+    flexScanner(0)
+{
+}
+
+
+void uetli::parser::parse(ParseContext& context, FILE* input)
+{
+    if (uetli_parser_lex_init(&context.flexScanner) != 0)
+        throw ParserException("could not initialize the lexer");
+    uetli_parser_set_in(input, context.flexScanner);
+
+    try {
+        uetli_parser_parse(&context);
+    }
+    catch (...) {
+        uetli_parser_lex_destroy(context.flexScanner);
+        context.flexScanner = 0;
+        throw;
+    }
+    uetli_parser_lex_destroy(context.flexScanner);
+    context.flexScanner = 0;
+}
+
+
+void uetli::parser::parse(ParseContext& context, Scanner& scanner)
+{
+    context.scanner = &scanner;
+    try {
+        uetli_parser_parse(&context);
+    }
+    catch (...) {
+        context.scanner = 0;
+        throw;
+    }
+    context.scanner = 0;
+}
+
+
 ParserException::ParserException(const std::string& errorMessage) :
     errorMessage(errorMessage)
 {
@@ -31,35 +31,72 @@ namespace uetli
     namespace parser
     {
         struct ClassDeclaration;
+        struct ParseContext;
 
         class ParserException;
+        class Scanner;
+
+        ///
+        /// \brief parses a source read by the flex lexer
+        ///
+        /// The parsed classes are appended to context.classes.
+        ///
+        /// \throws \link ParserException if there is a syntax error in the
+        ///         file.
+        ///
+        void parse(ParseContext& context, FILE* input);
+
+        ///
+        /// \brief parses a source read by the hand-written scanner
+        ///
+        /// \throws \link ParserException if there is a syntax error in the
+        ///         file.
+        ///
+        void parse(ParseContext& context, Scanner& scanner);
+    }
+
+    namespace util
+    {
+        class Arena;
     }
 }
 
 
 ///
-/// \brief contains the parsed classes
+/// \brief the state of one run of the parser
 ///
-/// After the parser has parsed the input, its output can be found in this list.
+/// There are no global variables used by the parser, so several sources
+/// can be parsed at the same time, each with its own context.
 ///
-extern std::vector<uetli::parser::ClassDeclaration*>* parsedClasses;
+struct uetli::parser::ParseContext
+{
+    /// arena in which the parse tree is allocated. The parsed classes stay
+    /// valid until it is released.
+    util::Arena* arena;
+
+    /// scanner providing the tokens to the parser. If it is 0, the flex
+    /// lexer is used.
+    Scanner* scanner;
+
+    /// state of the reentrant flex lexer
+    void* flexScanner;
+
+    /// after parsing, this list contains the parsed classes
+    std::vector<ClassDeclaration*> classes;
+
+    ParseContext(util::Arena& arena);
+};
 
-///
-/// \brief input stream for the parser
-///
-/// This stream is used as the code input by the parser.
-///
-extern FILE* uetli_parser_in;
 
 ///
 /// \brief the parse function
 ///
 /// This function invokes the actual parser. The result will be stored in
-/// parsedClasses.
+/// context->classes. The scanner of the context has to be set up before.
 ///
 /// \throws \link ParserException if there is a syntax error in the file.
 ///
-extern int uetli_parser_parse(void);
+extern int uetli_parser_parse(uetli::parser::ParseContext* context);
 
 
 class uetli::parser::ParserException
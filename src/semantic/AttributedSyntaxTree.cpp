@@ -30,13 +30,19 @@
 using namespace uetli::semantic;
 
 
-Class::Class(const std::string& name) :
+Class::Class(util::Symbol name) :
     name(name)
 {
 }
 
 
 const std::string& Class::getName(void) const
+{
+    return util::SymbolTable::getString(name);
+}
+
+
+uetli::util::Symbol Class::getSymbol(void) const
 {
     return name;
 }
@@ -44,17 +50,17 @@ const std::string& Class::getName(void) const
 
 uetli::parser::Identifier Class::getIdentifier(void) const
 {
-    return parser::Identifier(name);
+    return parser::Identifier(getName());
 }
 
 
-ClassReference::ClassReference(const std::string& name) :
+ClassReference::ClassReference(util::Symbol name) :
     Class(name)
 {
 }
 
 
-EffectiveClass::EffectiveClass(const std::string& name) :
+EffectiveClass::EffectiveClass(util::Symbol name) :
     Class(name)
 {
 }
@@ -69,12 +75,14 @@ Scope* EffectiveClass::getClassScope(void)
 void EffectiveClass::addField(Field* field)
 {
     fields.push_back(field);
+    fieldLinks.put(field->getSymbol(), field);
 }
 
 
 void EffectiveClass::addMethod(Method* method)
 {
     methods.push_back(method);
+    methodLinks.put(method->getSymbol(), method);
     classScope.addMethod(method);
 }
 
@@ -103,14 +111,14 @@ Method* EffectiveClass::getMethod(size_t index)
 }
 
 
-Field* EffectiveClass::getField(const std::string& name)
+Field* EffectiveClass::getField(util::Symbol name)
 {
     Field** f = fieldLinks.getReference(name);
     return f != 0 ? *f : 0;
 }
 
 
-Method* EffectiveClass::getMethod(const std::string& name)
+Method* EffectiveClass::getMethod(util::Symbol name)
 {
     Method** m = methodLinks.getReference(name);
     return m != 0 ? *m : 0;
@@ -142,7 +150,8 @@ Statement::~Statement(void)
 
 StatementBlock::StatementBlock(Scope* scope) :
     LanguageObject(scope),
-    Statement(scope)
+    Statement(scope),
+    localVariableCount(0)
 {
     localScope.setParentScope(scope);
 }
@@ -238,7 +247,7 @@ void BinaryOperationExpression::generateExpressionCode(
     right->generateExpressionCode(code);
 
     code::Subroutine* s = new code::SubroutineLink(operationMethod->
-            getFullIdentifier(), operationMethod->getArgumentCount());
+            getFullIdentifier(), operationMethod->getActualArgumentCount());
     
     code::CallInstruction* callInstruction = new code::CallInstruction(s);
     code.push_back(callInstruction);
@@ -266,7 +275,7 @@ void UnaryOperationExpression::generateExpressionCode(
     operand->generateExpressionCode(code);
 
     code::Subroutine* s = new code::SubroutineLink(operationMethod->
-            getFullIdentifier(), operationMethod->getArgumentCount());
+            getFullIdentifier(), operationMethod->getActualArgumentCount());
     code::CallInstruction* callInstruction = new code::CallInstruction(s);
     code.push_back(callInstruction);
 }
@@ -280,7 +289,7 @@ Class* UnaryOperationExpression::getStaticType(void)
 
 NewVariableStatement::NewVariableStatement(Scope* scope,
                                            Class* type,
-                                           const std::string& name) :
+                                           util::Symbol name) :
     LanguageObject(scope),
     Statement(scope),
     newVariable(new Variable(scope, type, name))
@@ -363,7 +372,7 @@ void CallStatement::generateExpressionCode(
     }
 
     code::Subroutine* sub = new code::SubroutineLink(method->
-            getFullIdentifier(), method->getArgumentCount());
+            getFullIdentifier(), method->getActualArgumentCount());
     code::CallInstruction* ci = new code::CallInstruction(sub);
     code.push_back(ci);
 }
@@ -375,7 +384,7 @@ Class* CallStatement::getStaticType(void)
 }
 
 
-Variable::Variable(Scope* scope, Class* type, const std::string& name) :
+Variable::Variable(Scope* scope, Class* type, util::Symbol name) :
     LanguageObject(scope),
     Expression(scope),
     type(type), name(name)
@@ -384,6 +393,12 @@ Variable::Variable(Scope* scope, Class* type, const std::string& name) :
 
 
 const std::string& Variable::getName(void) const
+{
+    return util::SymbolTable::getString(name);
+}
+
+
+uetli::util::Symbol Variable::getSymbol(void) const
 {
     return name;
 }
@@ -402,7 +417,7 @@ Class* Variable::getStaticType(void)
 }
 
 
-Feature::Feature(Class* wrapper, Class* returnType, const std::string& name) :
+Feature::Feature(Class* wrapper, Class* returnType, util::Symbol name) :
     wrapper(wrapper), returnType(returnType), name(name)
 {
 }
@@ -421,6 +436,12 @@ Class* Feature::getReturnType(void)
 
 
 const std::string& Feature::getName(void) const
+{
+    return util::SymbolTable::getString(name);
+}
+
+
+uetli::util::Symbol Feature::getSymbol(void) const
 {
     return name;
 }
@@ -430,17 +451,17 @@ uetli::parser::Identifier Feature::getFullIdentifier(void) const
 {
     if (wrapper == 0)
         throw "invalid method call (no member class found)";
-    return wrapper->getIdentifier().append(name);
+    return wrapper->getIdentifier().append(getName());
 }
 
 
-Field::Field(Class* wrapper, Class* returnType, const std::string& name) :
+Field::Field(Class* wrapper, Class* returnType, util::Symbol name) :
     Feature(wrapper, returnType, name)
 {
 }
 
 
-Method::Method(Class* wrapper, Class* returnType, const std::string& name,
+Method::Method(Class* wrapper, Class* returnType, util::Symbol name,
                unsigned int argumentCount) :
     Feature(wrapper, returnType, name),
     argumentCount(argumentCount), content(&methodScope)
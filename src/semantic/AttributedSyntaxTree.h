@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "../util/HashMap.h"
+#include "../util/SymbolTable.h"
 #include "../code/StackMachine.h"
 
 #include "Scope.h"
@@ -70,16 +71,17 @@ namespace uetli
 class uetli::semantic::Class
 {
     /// \brief defined name of the class
-    std::string name;
+    util::Symbol name;
 
 public:
-    Class(const std::string& name);
+    Class(util::Symbol name);
 
     ///
     /// \brief the defined name of the class
     /// \return the name of the class
     ///
     virtual const std::string& getName(void) const;
+    util::Symbol getSymbol(void) const;
 
     virtual parser::Identifier getIdentifier(void) const;
 };
@@ -88,7 +90,7 @@ public:
 class uetli::semantic::ClassReference : public Class
 {
 public:
-    ClassReference(const std::string& name);
+    ClassReference(util::Symbol name);
 };
 
 
@@ -96,13 +98,13 @@ class uetli::semantic::EffectiveClass : public Class
 {
     std::vector<Field*> fields;
     std::vector<Method*> methods;
-    uetli::util::HashMap<std::string, Field*> fieldLinks;
-    uetli::util::HashMap<std::string, Method*> methodLinks;
+    uetli::util::HashMap<util::Symbol, Field*> fieldLinks;
+    uetli::util::HashMap<util::Symbol, Method*> methodLinks;
 
     Scope classScope;
 
 public:
-    EffectiveClass(const std::string& name);
+    EffectiveClass(util::Symbol name);
 
     Scope* getClassScope(void);
 
@@ -115,8 +117,8 @@ public:
     Field* getField(size_t index);
     Method* getMethod(size_t index);
 
-    Field* getField(const std::string& name);
-    Method* getMethod(const std::string& name);
+    Field* getField(util::Symbol name);
+    Method* getMethod(util::Symbol name);
 };
 
 
@@ -234,8 +236,7 @@ class uetli::semantic::NewVariableStatement : public Statement
 {
     Variable* newVariable;
 public:
-    NewVariableStatement(Scope* scope,
-                         Class* type, const std::string& name);
+    NewVariableStatement(Scope* scope, Class* type, util::Symbol name);
     ~NewVariableStatement(void);
     Variable* getVariable(void);
 
@@ -284,11 +285,12 @@ public:
 class uetli::semantic::Variable : public Expression
 {
     Class* type;
-    std::string name;
+    util::Symbol name;
 public:
-    Variable(Scope* scope, Class* type, const std::string& name);
+    Variable(Scope* scope, Class* type, util::Symbol name);
 
     const std::string& getName(void) const;
+    util::Symbol getSymbol(void) const;
 
     virtual void generateExpressionCode(
             std::vector<code::StackInstruction*>& code) const;
@@ -302,13 +304,14 @@ class uetli::semantic::Feature
 protected:
     Class* wrapper;
     Class* returnType;
-    std::string name;
+    util::Symbol name;
 public:
-    Feature(Class* wrapper, Class* returnType, const std::string& name);
+    Feature(Class* wrapper, Class* returnType, util::Symbol name);
 
     Class* getWrapper(void);
     Class* getReturnType(void);
     const std::string& getName(void) const;
+    util::Symbol getSymbol(void) const;
     parser::Identifier getFullIdentifier(void) const;
 };
 
@@ -316,7 +319,7 @@ public:
 class uetli::semantic::Field : public Feature
 {
 public:
-    Field(Class* wrapper, Class* type, const std::string& name);
+    Field(Class* wrapper, Class* type, util::Symbol name);
 };
 
 
@@ -326,7 +329,7 @@ class uetli::semantic::Method : public Feature
     Scope methodScope;
     StatementBlock content;
 public:
-    Method(Class* wrapper, Class* returnType, const std::string& name,
+    Method(Class* wrapper, Class* returnType, util::Symbol name,
            unsigned int argumentCount);
 
     Scope* getMethodScope(void);
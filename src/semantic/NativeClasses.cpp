@@ -23,15 +23,16 @@
 
 
 using namespace uetli::semantic::native;
+using uetli::util::SymbolTable;
 
 
 Integer::Integer(void) :
-    EffectiveClass("Integer")
+    EffectiveClass(SymbolTable::intern("Integer"))
 {
-    plus = new Method(this, this, "+", 1);
-    minus = new Method(this, this, "-", 1);
-    mult = new Method(this, this, "*", 1);
-    div = new Method(this, this, "/", 1);
+    plus = new Method(this, this, SymbolTable::intern("+"), 1);
+    minus = new Method(this, this, SymbolTable::intern("-"), 1);
+    mult = new Method(this, this, SymbolTable::intern("*"), 1);
+    div = new Method(this, this, SymbolTable::intern("/"), 1);
 
     this->addMethod(plus);
     this->addMethod(minus);
@@ -40,3 +41,12 @@ Integer::Integer(void) :
 }
 
 
+void Integer::registerIntrinsics(uetli::code::IntrinsicTable& table) const
+{
+    table.add(plus->getFullIdentifier(), uetli::code::INTEGER_ADD);
+    table.add(minus->getFullIdentifier(), uetli::code::INTEGER_SUBTRACT);
+    table.add(mult->getFullIdentifier(), uetli::code::INTEGER_MULTIPLY);
+    table.add(div->getFullIdentifier(), uetli::code::INTEGER_DIVIDE);
+}
+
+
@@ -20,6 +20,7 @@
 // =============================================================================
 
 #include "AttributedSyntaxTree.h"
+#include "../code/IntrinsicTable.h"
 
 namespace uetli
 {
@@ -43,6 +44,11 @@ class uetli::semantic::native::Integer : public EffectiveClass
     Method* div;
 public:
     Integer(void);
+
+    ///
+    /// \brief add the operators of this class to an intrinsic table
+    ///
+    void registerIntrinsics(code::IntrinsicTable& table) const;
 };
 
 
@@ -29,7 +29,8 @@ using namespace uetli::semantic;
 
 Scope::Scope(void) :
         parentScope(0),
-        containsThis(false)
+        containsThis(false),
+        frozen(false)
 {
 }
 
@@ -63,13 +64,27 @@ bool Scope::getContainsThis(void) const
 }
 
 
+void Scope::setFrozen(bool frozen)
+{
+    this->frozen = frozen;
+}
+
+
+bool Scope::isFrozen(void) const
+{
+    return frozen;
+}
+
+
 void Scope::addChildScope(Scope* childScope)
 {
+    if (frozen)
+        throw "internal error: frozen scope modified";
     this->childrenScopes.push_back(childScope);
 }
 
 
-Method* Scope::findMethod(const std::string& name)
+Method* Scope::findMethod(uetli::util::Symbol name)
 {
     Method** m = methodLinks.getReference(name);
     if (m != 0)
@@ -83,7 +98,7 @@ Method* Scope::findMethod(const std::string& name)
 }
 
 
-Class* Scope::findClass(const std::string& name)
+Class* Scope::findClass(uetli::util::Symbol name)
 {
     Class** c = classLinks.getReference(name);
     if (c != 0)
@@ -97,7 +112,7 @@ Class* Scope::findClass(const std::string& name)
 }
 
 
-Variable* Scope::findVariable(const std::string& name)
+Variable* Scope::findVariable(uetli::util::Symbol name)
 {
     Variable** v = variableLinks.getReference(name);
     if (v != 0)
@@ -119,7 +134,7 @@ size_t Scope::getVariableCount(void) const
 
 size_t Scope::getStackIndex(const Variable* variable) const
 {
-    return getVariableCount() - 1 - variableIndices.get(variable);
+    return variables.size() - 1 - variableIndices.get(variable);
 }
 
 
@@ -128,27 +143,35 @@ size_t Scope::getStackIndexOfThis(void) const
     if (!containsThis)
         throw "\"this\" used in static function";
 
-    return getVariableCount();
+    // "this" is the first argument of a method, which lies directly below
+    // the local variables
+    return variables.size();
 }
  
 
 void Scope::addMethod(Method* method)
 {
-    methodLinks.put(method->getName(), method);
+    if (frozen)
+        throw "internal error: frozen scope modified";
+    methodLinks.put(method->getSymbol(), method);
 }
 
 
 void Scope::addClass(Class* newClass)
 {
-    classLinks.put(newClass->getName(),newClass);
+    if (frozen)
+        throw "internal error: frozen scope modified";
+    classLinks.put(newClass->getSymbol(), newClass);
 }
 
 
 void Scope::addVariable(Variable* variable)
 {
+    if (frozen)
+        throw "internal error: frozen scope modified";
     variables.push_back(variable);
     variableIndices.put(variable, variables.size() - 1);
-    variableLinks.put(variable->getName(), variable);
+    variableLinks.put(variable->getSymbol(), variable);
 }
 
 
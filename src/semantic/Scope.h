@@ -24,6 +24,7 @@
 #define UETLI_SEMANTIC_SCOPE_H_
 
 #include "../util/HashMap.h"
+#include "../util/SymbolTable.h"
 
 #include <string>
 
@@ -54,6 +55,9 @@ class uetli::semantic::Scope
     /// defines if the scope contains a "this" variable
     bool containsThis;
 
+    /// a frozen scope is only read, so it can be shared by several threads
+    bool frozen;
+
     /// holds variables in the order they were defined
     std::vector<Variable*> variables;
 
@@ -62,9 +66,9 @@ class uetli::semantic::Scope
     uetli::util::HashMap<const Variable*, size_t> variableIndices;
 
     /// holds variables accessible by name
-    uetli::util::HashMap<std::string, Variable*> variableLinks;
-    uetli::util::HashMap<std::string, Method*> methodLinks;
-    uetli::util::HashMap<std::string, Class*> classLinks;
+    uetli::util::HashMap<util::Symbol, Variable*> variableLinks;
+    uetli::util::HashMap<util::Symbol, Method*> methodLinks;
+    uetli::util::HashMap<util::Symbol, Class*> classLinks;
 public:
     Scope(void);
     ~Scope(void);
@@ -74,13 +78,21 @@ public:
     void setContainsThis(bool containsThis);
     bool getContainsThis(void) const;
 
+    ///
+    /// \brief freeze or unfreeze the scope
+    ///
+    /// Adding anything to a frozen scope is an internal error.
+    ///
+    void setFrozen(bool frozen);
+    bool isFrozen(void) const;
+
 protected:
     void addChildScope(Scope* childScope);
 public:
 
-    Method* findMethod(const std::string& name);
-    Class* findClass(const std::string& name);
-    Variable* findVariable(const std::string& name);
+    Method* findMethod(util::Symbol name);
+    Class* findClass(util::Symbol name);
+    Variable* findVariable(util::Symbol name);
 
 
     size_t getVariableCount(void) const;
@@ -88,6 +100,9 @@ public:
     ///
     /// \brief get the index of a variable from top of the stack
     ///
+    /// The frame of a method holds its arguments (starting with "this")
+    /// followed by its local variables.
+    ///
     /// \param variable the variable to search for
     /// \return the index of this variable if counted from top of the stack
     ///
@@ -21,6 +21,7 @@
 
 #include "TreeBuilder.h"
 #include "NativeClasses.h"
+#include "../util/Trace.h"
 #include <iostream>
 #include <vector>
 
@@ -43,9 +44,37 @@ TreeBuilder::~TreeBuilder(void)
 }
 
 
-void TreeBuilder::build(void)
+TreeBuilder::MethodLoop::MethodLoop(TreeBuilder* builder) :
+    builder(builder)
 {
-    globalScope->addClass(new native::Integer());
+}
+
+
+void TreeBuilder::MethodLoop::addMethod(const MethodLink& method)
+{
+    methods.push_back(method);
+}
+
+
+size_t TreeBuilder::MethodLoop::getMethodCount(void) const
+{
+    return methods.size();
+}
+
+
+void TreeBuilder::MethodLoop::run(size_t index)
+{
+    builder->processMethod(methods[index].second, methods[index].first);
+}
+
+
+void TreeBuilder::build(size_t threadCount)
+{
+    util::TraceSpan span("attribution");
+
+    native::Integer* integer = new native::Integer();
+    integer->registerIntrinsics(intrinsics);
+    globalScope->addClass(integer);
 
     //std::cout << "Initialized native classes!\n";
 
@@ -71,11 +100,44 @@ void TreeBuilder::build(void)
     }
 
 
+    MethodLoop methods(this);
     while(!methodsToProcess.empty()) {
-        MethodLink ml = methodsToProcess.front();
+        methods.addMethod(methodsToProcess.front());
         methodsToProcess.pop();
-        processMethod(ml.second, ml.first);
     }
+
+    // from now on, the global and class scopes are only read
+    globalScope->setFrozen(true);
+    integer->getClassScope()->setFrozen(true);
+    setClassScopesFrozen(true);
+
+    try {
+        util::ThreadPool::forEach(methods, methods.getMethodCount(),
+                                  threadCount);
+    }
+    catch (...) {
+        globalScope->setFrozen(false);
+        integer->getClassScope()->setFrozen(false);
+        setClassScopesFrozen(false);
+        throw;
+    }
+
+    globalScope->setFrozen(false);
+    integer->getClassScope()->setFrozen(false);
+    setClassScopesFrozen(false);
+}
+
+
+void TreeBuilder::skipBody(const MethodDeclaration* declaration)
+{
+    skippedBodies.put(declaration, true);
+}
+
+
+const MethodDeclaration* TreeBuilder::getDeclaration(
+        const Method* method) const
+{
+    return methodDeclarations.get(method);
 }
 
 
@@ -87,15 +149,24 @@ TreeBuilder::getAttributedClasses(void) const
 
 
 
+const code::IntrinsicTable& TreeBuilder::getIntrinsics(void) const
+{
+    return intrinsics;
+}
+
+
 void TreeBuilder::addFeatures(EffectiveClass* effClass,
                               const ClassDeclaration* declaration)
 {
+    util::TraceSpan span("add features");
+    if (span.isRecording())
+        span.setName(effClass->getName());
 
-    typedef std::vector<FeatureDeclaration*>::const_iterator FdIter;
+    typedef FeatureList::const_iterator FdIter;
     typedef std::vector<EffectiveClass*>::iterator PcIter;
 
 
-    const std::vector<FeatureDeclaration*>& features = declaration->features;
+    const FeatureList& features = declaration->features;
 
     FeatureDeclaration* fd;
     try {
@@ -103,7 +174,8 @@ void TreeBuilder::addFeatures(EffectiveClass* effClass,
             fd = *i;
 
             EffectiveClass* type = 0;
-            if (!fd->type.empty()) // if return type not "void"
+            // if return type not "void"
+            if (fd->type != util::SymbolTable::emptySymbol)
                 type = classesByName.get(fd->type);
 
             FieldDeclaration* field = dynamic_cast<FieldDeclaration*> (*i);
@@ -122,7 +194,9 @@ void TreeBuilder::addFeatures(EffectiveClass* effClass,
                 m->getMethodScope()->setParentScope(effClass->getClassScope());
                 //effClass->getClassScope()->addChildScope(m->getMethodScope());
                 effClass->addMethod(m);
-                methodsToProcess.push(MethodLink(method, m));
+                methodDeclarations.put(m, method);
+                if (!skippedBodies.contains(method))
+                    methodsToProcess.push(MethodLink(method, m));
 
                 //std::cout << "created attributed entry for method!" <<
                 //    std::endl;;
@@ -133,7 +207,8 @@ void TreeBuilder::addFeatures(EffectiveClass* effClass,
         }
     }
     catch (const uetli::util::NoEntryException&) {
-        std::cerr << "Fatal internal error: " << "Invalid Key: " << fd->type <<
+        std::cerr << "Fatal internal error: " << "Invalid Key: " <<
+                     util::SymbolTable::getString(fd->type) <<
                      ". Please report this to the developer.\n";
     }
 }
@@ -141,6 +216,10 @@ void TreeBuilder::addFeatures(EffectiveClass* effClass,
 
 void TreeBuilder::processMethod(Method* method, MethodDeclaration* declaration)
 {
+    util::TraceSpan span("attribute method");
+    if (span.isRecording())
+        span.setName(method->getFullIdentifier().getAsString());
+
     StatementBlock& methodContent = method->getContent();
 
     for (size_t i = 0; i < declaration->body->statements.size(); i++) {
@@ -151,6 +230,14 @@ void TreeBuilder::processMethod(Method* method, MethodDeclaration* declaration)
 }
 
 
+void TreeBuilder::setClassScopesFrozen(bool frozen)
+{
+    for (size_t i = 0; i < attributedClasses.size(); i++) {
+        attributedClasses[i]->getClassScope()->setFrozen(frozen);
+    }
+}
+
+
 /// \deprecated
 void TreeBuilder::processStatement(EffectiveClass* ec, Scope* scope,
                                    parser::Statement* statement)
@@ -26,6 +26,8 @@
 #include "../parser/ParseObject.h"
 #include "AttributedSyntaxTree.h"
 #include "../util/HashMap.h"
+#include "../code/IntrinsicTable.h"
+#include "../util/ThreadPool.h"
 
 #include <vector>
 #include <queue>
@@ -56,11 +58,14 @@ class uetli::semantic::TreeBuilder
 
     /// this map links the name of a class to the corresponding
     /// attributed class
-    uetli::util::HashMap<std::string, EffectiveClass*> classesByName;
+    uetli::util::HashMap<util::Symbol, EffectiveClass*> classesByName;
 
     /// the main scope
     Scope* globalScope;
 
+    /// intrinsics implementing the methods of the native classes
+    code::IntrinsicTable intrinsics;
+
     /// pair linking the freshly parsed MethodDeclaration and an attributed
     /// Method
     typedef std::pair<uetli::parser::MethodDeclaration*, Method*> MethodLink;
@@ -68,6 +73,29 @@ class uetli::semantic::TreeBuilder
     /// queue to store methods which will be processed later
     std::queue<MethodLink> methodsToProcess;
 
+    /// declarations of the methods whose bodies are not attributed
+    util::HashMap<const parser::MethodDeclaration*, bool> skippedBodies;
+
+    /// links every attributed method to its declaration
+    util::HashMap<const Method*, const parser::MethodDeclaration*>
+            methodDeclarations;
+
+    ///
+    /// \brief attributes the bodies of a list of methods
+    ///
+    class MethodLoop : public util::ThreadPool::Loop
+    {
+        TreeBuilder* builder;
+        std::vector<MethodLink> methods;
+    public:
+        MethodLoop(TreeBuilder* builder);
+
+        void addMethod(const MethodLink& method);
+        size_t getMethodCount(void) const;
+
+        virtual void run(size_t index);
+    };
+
 public:
     ///
     /// \brief initialize the builder with a list of parsed classes
@@ -81,7 +109,31 @@ public:
     ///
     /// \brief build the attributed tree
     ///
-    void build(void);
+    /// The classes and their features are registered first. After that,
+    /// the scopes of the classes are frozen and the method bodies, which
+    /// only modify their own scopes, are attributed in parallel.
+    ///
+    /// \param threadCount number of threads attributing the method bodies
+    ///
+    void build(size_t threadCount = 1);
+
+    ///
+    /// \brief leave the body of a method empty
+    ///
+    /// The method itself is still added to its class, so it can be called,
+    /// but its statements are not attributed. This is used for methods
+    /// whose code is already known (e.g. from a compilation cache).
+    ///
+    /// \param declaration the declaration of the method
+    ///
+    void skipBody(const uetli::parser::MethodDeclaration* declaration);
+
+    ///
+    /// \param method a method created by build()
+    /// \return the declaration the method was created from
+    ///
+    const uetli::parser::MethodDeclaration* getDeclaration(
+            const Method* method) const;
 
     ///
     /// \brief get the attributed classes
@@ -90,6 +142,12 @@ public:
     const std::vector<uetli::semantic::EffectiveClass*>&
     getAttributedClasses(void) const;
 
+    ///
+    /// \brief get the intrinsics of the native classes
+    /// \return a table which is filled during build()
+    ///
+    const code::IntrinsicTable& getIntrinsics(void) const;
+
 private:
 
     void addFeatures(EffectiveClass* effClass,
@@ -98,6 +156,8 @@ private:
     void processMethod(Method* method,
                        uetli::parser::MethodDeclaration* declaration);
 
+    void setClassScopesFrozen(bool frozen);
+
     void processStatement(EffectiveClass* ec, Scope* scope,
                           uetli::parser::Statement*statement);
 };
@@ -0,0 +1,86 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "Arena.h"
+
+using uetli::util::Arena;
+
+
+Arena::Arena(void) :
+    current(0),
+    remaining(0)
+{
+}
+
+
+Arena::~Arena(void)
+{
+    release();
+}
+
+
+void* Arena::allocate(size_t size)
+{
+    size = (size + alignment - 1) & ~(alignment - 1);
+
+    // large objects get a block of their own, so the rest of the current
+    // block is not wasted
+    if (size > blockSize / 4) {
+        char* block = new char[size];
+        blocks.push_back(block);
+        return block;
+    }
+
+    if (size > remaining) {
+        current = new char[blockSize];
+        remaining = blockSize;
+        blocks.push_back(current);
+    }
+
+    void* result = current;
+    current += size;
+    remaining -= size;
+    return result;
+}
+
+
+void Arena::release(void)
+{
+    for (size_t i = 0; i < blocks.size(); i++) {
+        delete[] blocks[i];
+    }
+    blocks.clear();
+    current = 0;
+    remaining = 0;
+}
+
+
+void* operator new(size_t size, Arena& arena)
+{
+    return arena.allocate(size);
+}
+
+
+void operator delete(void*, Arena&) throw()
+{
+}
+
@@ -0,0 +1,173 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_UTIL_ARENA_H_
+#define UETLI_UTIL_ARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace uetli
+{
+    namespace util
+    {
+        class Arena;
+
+        template <typename T>
+        class ArenaAllocator;
+    }
+}
+
+
+///
+/// \brief region of memory from which objects are allocated by bumping a
+///        pointer and which is freed all at once
+///
+/// Objects allocated in an arena (using <code>new (arena) T(...)</code>) are
+/// never destroyed. They must therefore not own any memory outside of the
+/// arena; containers can use an ArenaAllocator for this.
+///
+class uetli::util::Arena
+{
+    /// size of the memory blocks allocated for small objects
+    static const size_t blockSize = 64 * 1024;
+
+    /// alignment of all allocations
+    static const size_t alignment = 16;
+
+    /// all allocated blocks
+    std::vector<char*> blocks;
+
+    /// free space in the current block
+    char* current;
+    size_t remaining;
+
+    Arena(const Arena&);
+    Arena& operator = (const Arena&);
+public:
+    Arena(void);
+    ~Arena(void);
+
+    ///
+    /// \brief allocate uninitialized memory, aligned for any type
+    ///
+    void* allocate(size_t size);
+
+    ///
+    /// \brief free all memory allocated from the arena
+    ///
+    void release(void);
+};
+
+
+///
+/// \brief allocator for standard containers taking their memory from an arena
+///
+/// A default constructed allocator is not bound to an arena and uses the
+/// global operator new instead.
+///
+template <typename T>
+class uetli::util::ArenaAllocator
+{
+    template <typename U>
+    friend class ArenaAllocator;
+
+    Arena* arena;
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef ArenaAllocator<U> other;
+    };
+
+    ArenaAllocator(void) throw() : arena(0) {}
+    ArenaAllocator(Arena& arena) throw() : arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) throw() :
+        arena(other.arena)
+    {
+    }
+
+    pointer address(reference value) const { return &value; }
+    const_pointer address(const_reference value) const { return &value; }
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+        if (arena != 0)
+            return static_cast<pointer>(arena->allocate(n * sizeof(T)));
+        else
+            return static_cast<pointer>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(pointer p, size_type)
+    {
+        // memory taken from an arena is only freed with the whole arena
+        if (arena == 0)
+            ::operator delete(p);
+    }
+
+    size_type max_size(void) const throw()
+    {
+        return size_type(-1) / sizeof(T);
+    }
+
+    void construct(pointer p, const T& value) { new (p) T(value); }
+    void destroy(pointer p) { p->~T(); }
+
+    template <typename U>
+    bool operator == (const ArenaAllocator<U>& other) const
+    {
+        return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator != (const ArenaAllocator<U>& other) const
+    {
+        return arena != other.arena;
+    }
+};
+
+
+///
+/// \brief allocate an object in an arena
+///
+void* operator new(size_t size, uetli::util::Arena& arena);
+
+///
+/// \brief only called if the constructor of an object allocated in an arena
+///        throws; the memory stays in the arena
+///
+void operator delete(void* pointer, uetli::util::Arena& arena) throw();
+
+
+#endif // UETLI_UTIL_ARENA_H_
+
@@ -0,0 +1,205 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "Fingerprint.h"
+
+#include <cstring>
+
+using uetli::util::Fingerprint;
+
+
+static const unsigned long long c1 = 0x87c37b91114253d5ULL;
+static const unsigned long long c2 = 0x4cf5ad432745937fULL;
+
+
+static unsigned long long rotateLeft(unsigned long long x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+
+static unsigned long long load64(const unsigned char* bytes)
+{
+    unsigned long long value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+
+static unsigned long long finalMix(unsigned long long k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+
+bool Fingerprint::Value::operator == (const Value& other) const
+{
+    return low == other.low && high == other.high;
+}
+
+
+bool Fingerprint::Value::operator != (const Value& other) const
+{
+    return !(*this == other);
+}
+
+
+std::string Fingerprint::Value::toString(void) const
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string result(32, '0');
+    for (int i = 0; i < 16; i++) {
+        result[15 - i] = digits[(high >> (4 * i)) & 0xF];
+        result[31 - i] = digits[(low >> (4 * i)) & 0xF];
+    }
+    return result;
+}
+
+
+Fingerprint::Fingerprint(void) :
+    h1(0),
+    h2(0),
+    buffered(0),
+    length(0)
+{
+}
+
+
+void Fingerprint::add(const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    length += size;
+
+    // complete a partially filled block first
+    if (buffered > 0) {
+        size_t missing = sizeof buffer - buffered;
+        if (size < missing) {
+            ::memcpy(buffer + buffered, bytes, size);
+            buffered += size;
+            return;
+        }
+        ::memcpy(buffer + buffered, bytes, missing);
+        processBlock(buffer);
+        buffered = 0;
+        bytes += missing;
+        size -= missing;
+    }
+
+    while (size >= sizeof buffer) {
+        processBlock(bytes);
+        bytes += sizeof buffer;
+        size -= sizeof buffer;
+    }
+
+    ::memcpy(buffer, bytes, size);
+    buffered = size;
+}
+
+
+void Fingerprint::add(unsigned long long value)
+{
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (unsigned char) (value >> (8 * i));
+    }
+    add(bytes, sizeof bytes);
+}
+
+
+void Fingerprint::add(const std::string& string)
+{
+    add((unsigned long long) string.size());
+    add(string.data(), string.size());
+}
+
+
+Fingerprint::Value Fingerprint::getValue(void) const
+{
+    unsigned long long a = h1;
+    unsigned long long b = h2;
+
+    // the remaining bytes are processed like a block padded with zeros
+    unsigned char tail[16] = { 0 };
+    ::memcpy(tail, buffer, buffered);
+    unsigned long long k1 = load64(tail);
+    unsigned long long k2 = load64(tail + 8);
+
+    if (buffered > 8) {
+        k2 *= c2;
+        k2 = rotateLeft(k2, 33);
+        k2 *= c1;
+        b ^= k2;
+    }
+    if (buffered > 0) {
+        k1 *= c1;
+        k1 = rotateLeft(k1, 31);
+        k1 *= c2;
+        a ^= k1;
+    }
+
+    a ^= length;
+    b ^= length;
+    a += b;
+    b += a;
+    a = finalMix(a);
+    b = finalMix(b);
+    a += b;
+    b += a;
+
+    Value value;
+    value.low = a;
+    value.high = b;
+    return value;
+}
+
+
+void Fingerprint::processBlock(const unsigned char* block)
+{
+    unsigned long long k1 = load64(block);
+    unsigned long long k2 = load64(block + 8);
+
+    k1 *= c1;
+    k1 = rotateLeft(k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+
+    h1 = rotateLeft(h1, 27);
+    h1 += h2;
+    h1 = h1 * 5 + 0x52dce729;
+
+    k2 *= c2;
+    k2 = rotateLeft(k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+
+    h2 = rotateLeft(h2, 31);
+    h2 += h1;
+    h2 = h2 * 5 + 0x38495ab5;
+}
+
@@ -0,0 +1,96 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_UTIL_FINGERPRINT_H_
+#define UETLI_UTIL_FINGERPRINT_H_
+
+#include <cstddef>
+#include <string>
+
+namespace uetli
+{
+    namespace util
+    {
+        class Fingerprint;
+    }
+}
+
+
+///
+/// \brief computes a 128-bit hash of a stream of data
+///
+/// The hash function is MurmurHash3 (x64, 128 bit). It is not
+/// cryptographic, but collisions between different inputs are extremely
+/// unlikely, so the fingerprint can be used to identify contents.
+///
+class uetli::util::Fingerprint
+{
+public:
+    struct Value
+    {
+        unsigned long long low;
+        unsigned long long high;
+
+        bool operator == (const Value& other) const;
+        bool operator != (const Value& other) const;
+
+        ///
+        /// \return the value as 32 hexadecimal digits
+        ///
+        std::string toString(void) const;
+    };
+
+private:
+    unsigned long long h1;
+    unsigned long long h2;
+
+    /// bytes not yet processed (less than one block)
+    unsigned char buffer[16];
+    size_t buffered;
+
+    /// number of bytes added so far
+    unsigned long long length;
+
+public:
+    Fingerprint(void);
+
+    void add(const void* data, size_t size);
+    void add(unsigned long long value);
+
+    ///
+    /// \brief add a string preceded by its length, so that the boundaries
+    ///        of consecutive strings are part of the fingerprint
+    ///
+    void add(const std::string& string);
+
+    ///
+    /// \return the fingerprint of the data added so far
+    ///
+    Value getValue(void) const;
+
+private:
+    void processBlock(const unsigned char* block);
+};
+
+
+#endif // UETLI_UTIL_FINGERPRINT_H_
+
@@ -44,7 +44,14 @@ namespace uetli
 /// \brief simple hash map
 ///
 /// This class represents a dictionary data structure implemented as a hash
-/// table.
+/// table with open addressing.
+///
+/// Besides the slots holding the entries, the table keeps one control byte
+/// per slot. It is negative for empty slots and holds the lowest 7 bits of
+/// the hash value for occupied ones. The slots are probed in groups of 16,
+/// comparing all control bytes of a group at once (using SSE2 if it is
+/// available), so keys are only compared if their hash values are likely
+/// to be equal.
 ///
 ///
 /// \tparam K the key type
@@ -64,27 +71,35 @@ private:
     /// initial length of the hash table
     static const size_t standardSize = 16;
 
+    /// number of slots probed at once
+    static const size_t groupSize = 16;
+
+    /// control byte of an empty slot
+    static const signed char emptyControl = -128;
+
     ///
     /// \brief structure to store entries
     ///
-	struct Entry
-	{
-		K key;
-		V value;
-		Entry* next;
+    struct Slot
+    {
+        K key;
+        V value;
+
+        Slot(const K& key, const V& value);
+    };
 
-		Entry(void);
-	};
+    /// one control byte per slot
+    signed char* controlTable;
 
-    /// list of pointers to Entry*, each representing a linked list
-    /// containing every entry at the specific position.
-    Entry** entryTable;
+    /// uninitialized memory for the entries, only the slots with a
+    /// non-negative control byte hold constructed ones
+    Slot* slotTable;
 
-    /// size of the allocated table (in number of buckets in the table)
+    /// size of the allocated table (in number of slots)
     size_t size;
 
-    /// bitmask applied to the hash-value mapping it to the table space
-    size_t hashMask;
+    /// bitmask applied to group indices mapping them to the table space
+    size_t groupMask;
 
     /// absolute number of entries
     size_t nEntries;
@@ -106,6 +121,8 @@ public:
 
     ~HashMap(void);
 
+    HashMap<K, V, H>& operator = (const HashMap<K, V, H>& map);
+
     ///
     /// Returns the number of elements that are currently held in this
     /// HashMap. This has nothing to do with the allocated table where
@@ -128,7 +145,9 @@ public:
     void resize(size_t newSize);
 
     ///
-    /// Add a new entry to the dictionary
+    /// Add a new entry to the dictionary. If the dictionary already
+    /// contains the key, its value is replaced.
+    ///
     /// \param key
     /// \param value
     ///
@@ -218,12 +237,37 @@ public:
     void clear(void);
 
 private:
+    void allocateTable(size_t newSize);
+    void copyContent(const HashMap<K, V, H>& hashMap);
     void deleteContent(void);
-    void updateHashMask(void);
 
-private:
-    size_t getEntryIndex(const K& key) const;
-    void putEntry(void*);
+    ///
+    /// \brief spreads the bits of the hash value of a key
+    ///
+    /// The bits are mixed because the default hash of a pointer has its
+    /// lowest bits always cleared.
+    ///
+    static size_t getHash(const K& key);
+
+    ///
+    /// \return the index of the slot containing the key or
+    ///         <code>size</code>, if the key is not in the table
+    ///
+    size_t findSlot(const K& key, size_t hash) const;
+
+    ///
+    /// \return the index of the first empty slot in the probe sequence
+    ///
+    size_t findEmptySlot(size_t hash) const;
+
+    ///
+    /// \return a bitmask with bit i set if the control byte i of the group
+    ///         equals <code>control</code>
+    ///
+    static unsigned int matchGroup(const signed char* group,
+                                   signed char control);
+
+    static unsigned int getLowestBit(unsigned int mask);
 };
 
 
@@ -20,39 +20,32 @@
 // =============================================================================
 
 #include <cstring>
+#include <new>
+
+#if defined(__SSE2__)
+#   include <emmintrin.h>
+#endif
+
 
 template <typename K, typename V, typename H>
-uetli::util::HashMap<K, V, H>::Entry::Entry(void)
+uetli::util::HashMap<K, V, H>::Slot::Slot(const K& key, const V& value) :
+    key(key), value(value)
 {
-    next = 0;
 }
 
 
 template <typename K, typename V, typename H>
 uetli::util::HashMap<K, V, H>::HashMap(void)
 {
-    size = standardSize;
     nEntries = 0;
-    entryTable = new Entry*[size];
-    memset(entryTable, 0, standardSize * sizeof(Entry*));
-    updateHashMask();
+    allocateTable(standardSize);
 }
 
 
 template <typename K, typename V, typename H>
 uetli::util::HashMap<K, V, H>::HashMap(const HashMap<K, V, H>& hashMap)
 {
-    this->size = hashMap.size;
-    updateHashMask();
-    entryTable = new Entry*[size];
-    for (size_t i = 0; i < size; i++) {
-        const Entry* mapEntry = hashMap->entryTable[i];
-
-        while (mapEntry != 0) {
-            this->put(mapEntry->key, mapEntry->value);
-            mapEntry = mapEntry->next;
-        }
-    }
+    copyContent(hashMap);
 }
 
 
@@ -63,6 +56,18 @@ uetli::util::HashMap<K, V, H>::~HashMap(void)
 }
 
 
+template <typename K, typename V, typename H>
+uetli::util::HashMap<K, V, H>& uetli::util::HashMap<K, V, H>::operator = (
+        const HashMap<K, V, H>& hashMap)
+{
+    if (this != &hashMap) {
+        deleteContent();
+        copyContent(hashMap);
+    }
+    return *this;
+}
+
+
 template <typename K, typename V, typename H>
 size_t uetli::util::HashMap<K, V, H>::getElementCount(void) const
 {
@@ -73,72 +78,67 @@ size_t uetli::util::HashMap<K, V, H>::getElementCount(void) const
 template <typename K, typename V, typename H>
 void uetli::util::HashMap<K, V, H>::resize(size_t newSize)
 {
+    // the table is kept at most 7/8 full, so probing always finds an empty
+    // slot
+    size_t tableSize = standardSize;
+    while (tableSize < newSize || tableSize / 8 * 7 < nEntries + 1)
+        tableSize *= 2;
+
+    signed char* oldControlTable = controlTable;
+    Slot* oldSlotTable = slotTable;
     size_t oldSize = size;
-    {
-        size_t i = 0;
-        for (i = 0; (1U << i) < newSize && i <= sizeof(size_t) * 8;) i++;
-            size = 1 << i;
-    }
-    Entry** oldEntryTable = entryTable;
-    entryTable = new Entry*[size];
-    memset(entryTable, 0, size * sizeof(Entry*));
-    updateHashMask();
 
-    nEntries = 0;
+    allocateTable(tableSize);
 
-    for (unsigned int i = 0; i < oldSize; i++) {
-        Entry* entry = oldEntryTable[i];
-        while (entry != 0) {
-            Entry* next = entry->next;
-            putEntry(entry);
-            entry = next;
+    for (size_t i = 0; i < oldSize; i++) {
+        if (oldControlTable[i] >= 0) {
+            size_t hash = getHash(oldSlotTable[i].key);
+            size_t index = findEmptySlot(hash);
+            controlTable[index] = oldControlTable[i];
+            new (&slotTable[index]) Slot(oldSlotTable[i]);
+            oldSlotTable[i].~Slot();
         }
     }
+
+    delete[] oldControlTable;
+    operator delete(oldSlotTable);
 }
 
 
 template <typename K, typename V, typename H>
 void uetli::util::HashMap<K, V, H>::put(const K& key, const V& value)
 {
-    if (nEntries > size + (size / 4)) {
+    size_t hash = getHash(key);
+    size_t index = findSlot(key, hash);
+    if (index != size) {
+        slotTable[index].value = value;
+        return;
+    }
+
+    if (size / 8 * 7 < nEntries + 1) {
         resize(size * 2);
     }
 
-    Entry* entry = new Entry();
-    entry->key = key;
-    entry->value = value;
-    putEntry(entry);
+    index = findEmptySlot(hash);
+    controlTable[index] = (signed char) (hash & 0x7F);
+    new (&slotTable[index]) Slot(key, value);
+    nEntries++;
 }
 
 
 template <typename K, typename V, typename H>
 bool uetli::util::HashMap<K, V, H>::contains(const K& key) const
 {
-    size_t index = getEntryIndex(key);
-    const Entry* entry = entryTable[index];
-    while (entry != 0) {
-
-        if (entry->key == key)
-            return true;
-
-        entry = entry->next;
-    }
-    return false;
+    return findSlot(key, getHash(key)) != size;
 }
 
 
 template <typename K, typename V, typename H>
 const V* uetli::util::HashMap<K, V, H>::getReference(const K& key) const throw()
 {
-    size_t index = getEntryIndex(key);
-    const Entry* entry = entryTable[index];
-    while (entry != 0) {
-
-        if (entry->key == key)
-            return &entry->value;
-
-        entry = entry->next;
-    }
+    size_t index = findSlot(key, getHash(key));
+    if (index != size)
+        return &slotTable[index].value;
     return 0;
 }
 
@@ -178,11 +178,32 @@ template <typename K, typename V, typename H>
 void uetli::util::HashMap<K, V, H>::clear(void)
 {
     deleteContent();
+    nEntries = 0;
+    allocateTable(standardSize);
+}
+
 
-    size = standardSize;
-    entryTable = new Entry*[size];
-    memset(entryTable, 0, standardSize * sizeof(Entry*));
-    updateHashMask();
+template <typename K, typename V, typename H>
+void uetli::util::HashMap<K, V, H>::allocateTable(size_t newSize)
+{
+    size = newSize;
+    groupMask = size / groupSize - 1;
+    controlTable = new signed char[size];
+    memset(controlTable, emptyControl, size);
+    slotTable = static_cast<Slot*> (operator new(size * sizeof(Slot)));
+}
+
+
+template <typename K, typename V, typename H>
+void uetli::util::HashMap<K, V, H>::copyContent(const HashMap<K, V, H>& hashMap)
+{
+    nEntries = hashMap.nEntries;
+    allocateTable(hashMap.size);
+    memcpy(controlTable, hashMap.controlTable, size);
+    for (size_t i = 0; i < size; i++) {
+        if (controlTable[i] >= 0)
+            new (&slotTable[i]) Slot(hashMap.slotTable[i]);
+    }
 }
 
 
@@ -190,54 +211,105 @@ template <typename K, typename V, typename H>
 void uetli::util::HashMap<K, V, H>::deleteContent(void)
 {
     for (size_t i = 0; i < size; i++) {
-        while (entryTable[i] != 0) {
-            Entry* e = entryTable[i];
-            entryTable[i] = e->next;
-            delete e;
-            e = 0;
-        }
+        if (controlTable[i] >= 0)
+            slotTable[i].~Slot();
     }
-    delete[] entryTable;
-    entryTable = 0;
+    delete[] controlTable;
+    controlTable = 0;
+    operator delete(slotTable);
+    slotTable = 0;
 }
 
 
 template <typename K, typename V, typename H>
-inline void uetli::util::HashMap<K, V, H>::updateHashMask(void)
+inline size_t uetli::util::HashMap<K, V, H>::getHash(const K& key)
 {
-    hashMask = size - 1;
+    // finalizer of MurmurHash3
+    unsigned long long hash = H::hash(key);
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    return (size_t) hash;
 }
 
 
 template <typename K, typename V, typename H>
-inline size_t uetli::util::HashMap<K, V, H>::getEntryIndex(const K& key) const
+inline size_t uetli::util::HashMap<K, V, H>::findSlot(const K& key, size_t hash) const
 {
-    return hashMask & H::hash(key);
+    signed char control = (signed char) (hash & 0x7F);
+    size_t group = (hash >> 7) & groupMask;
+
+    // triangular probing visits every group, as their number is a power of 2
+    for (size_t step = 1; ; step++) {
+        const signed char* groupControl = controlTable + group * groupSize;
+
+        unsigned int matches = matchGroup(groupControl, control);
+        while (matches != 0) {
+            size_t index = group * groupSize + getLowestBit(matches);
+            if (slotTable[index].key == key)
+                return index;
+            matches &= matches - 1;
+        }
+
+        // entries are never removed, so the key would have been put in this
+        // empty slot
+        if (matchGroup(groupControl, emptyControl) != 0)
+            return size;
+
+        group = (group + step) & groupMask;
+    }
 }
 
 
 template <typename K, typename V, typename H>
-void uetli::util::HashMap<K, V, H>::putEntry(void* e)
+size_t uetli::util::HashMap<K, V, H>::findEmptySlot(size_t hash) const
 {
-    Entry* toAdd = (Entry*) e;
-    size_t index = getEntryIndex(toAdd->key);
-    Entry* entry = entryTable[index];
-    Entry* lastEntry = 0;
-
-    while (entry != 0) {
-        lastEntry = entry;
-        entry = entry->next;
+    size_t group = (hash >> 7) & groupMask;
+
+    for (size_t step = 1; ; step++) {
+        unsigned int empty = matchGroup(controlTable + group * groupSize,
+                                        emptyControl);
+        if (empty != 0)
+            return group * groupSize + getLowestBit(empty);
+
+        group = (group + step) & groupMask;
     }
-    
-    entry = toAdd;
-    if (lastEntry != 0)
-        lastEntry->next = entry;
-    else
-        entryTable[index] = entry;
+}
 
-    entry->next = 0;
 
-    nEntries++;
+template <typename K, typename V, typename H>
+inline unsigned int uetli::util::HashMap<K, V, H>::matchGroup(
+        const signed char* group, signed char control)
+{
+#if defined(__SSE2__)
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*> (group));
+    return (unsigned int) _mm_movemask_epi8(
+                _mm_cmpeq_epi8(bytes, _mm_set1_epi8(control)));
+#else
+    unsigned int mask = 0;
+    for (size_t i = 0; i < groupSize; i++) {
+        if (group[i] == control)
+            mask |= 1U << i;
+    }
+    return mask;
+#endif
+}
+
+
+template <typename K, typename V, typename H>
+inline unsigned int uetli::util::HashMap<K, V, H>::getLowestBit(
+        unsigned int mask)
+{
+#if defined(__GNUC__)
+    return (unsigned int) __builtin_ctz(mask);
+#else
+    unsigned int bit = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
 }
 
 
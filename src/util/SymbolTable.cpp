@@ -0,0 +1,107 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "SymbolTable.h"
+
+using uetli::util::DefaultHash;
+using uetli::util::Symbol;
+using uetli::util::SymbolTable;
+
+
+const Symbol SymbolTable::emptySymbol;
+
+
+SymbolTable::Shard::Shard(void) :
+    size(0)
+{
+    for (unsigned int i = 0; i < maxChunks; i++)
+        chunks[i] = 0;
+}
+
+
+SymbolTable::Shard::~Shard(void)
+{
+    for (unsigned int i = 0; i < maxChunks; i++)
+        delete[] chunks[i];
+}
+
+
+SymbolTable::SymbolTable(void)
+{
+    // the empty string is the first string of shard 0, so its symbol is 0
+    Shard& first = shards[0];
+    first.chunks[0] = new std::string[chunkSize];
+    first.size = 1;
+}
+
+
+SymbolTable& SymbolTable::getInstance(void)
+{
+    static SymbolTable instance;
+    return instance;
+}
+
+
+Symbol SymbolTable::intern(const std::string& string)
+{
+    if (string.empty())
+        return emptySymbol;
+
+    size_t hash = DefaultHash<std::string>::hash(string);
+    unsigned int shardIndex = (hash ^ (hash >> 29)) & (shardCount - 1);
+    Shard& shard = getInstance().shards[shardIndex];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    const Symbol* existing = shard.symbols.getReference(string);
+    if (existing != 0)
+        return *existing;
+
+    unsigned int index = shard.size;
+    if (index / chunkSize >= maxChunks)
+        throw "too many symbols";
+    if (index % chunkSize == 0)
+        shard.chunks[index / chunkSize] = new std::string[chunkSize];
+
+    shard.chunks[index / chunkSize][index % chunkSize] = string;
+    shard.size++;
+
+    Symbol symbol = index * shardCount + shardIndex;
+    shard.symbols.put(string, symbol);
+    return symbol;
+}
+
+
+Symbol SymbolTable::intern(const char* string, size_t length)
+{
+    return intern(std::string(string, length));
+}
+
+
+const std::string& SymbolTable::getString(Symbol symbol)
+{
+    // a symbol is only handed out after its string has been stored, and
+    // the chunks never move, so no lock is needed
+    const Shard& shard = getInstance().shards[symbol % shardCount];
+    unsigned int index = symbol / shardCount;
+    return shard.chunks[index / chunkSize][index % chunkSize];
+}
@@ -0,0 +1,118 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_UTIL_SYMBOLTABLE_H_
+#define UETLI_UTIL_SYMBOLTABLE_H_
+
+#include "HashMap.h"
+
+#include <mutex>
+#include <string>
+
+namespace uetli
+{
+    namespace util
+    {
+        ///
+        /// \brief an interned string
+        ///
+        /// Two symbols are equal if and only if their strings are equal, so
+        /// identifiers can be compared and hashed as integers.
+        ///
+        typedef unsigned int Symbol;
+
+        class SymbolTable;
+    }
+}
+
+
+///
+/// \brief interns the identifiers of all compiled sources
+///
+/// There is one global table. Symbols are never removed from it, so a
+/// symbol stays valid for the whole compilation.
+///
+/// The table may be used by several threads at once. It is split into
+/// shards, each guarded by its own mutex, so threads interning different
+/// strings rarely wait for each other. The strings are stored in chunks
+/// which are never moved, so getString does not need to lock.
+///
+class uetli::util::SymbolTable
+{
+    /// number of shards (a power of two)
+    static const unsigned int shardCount = 16;
+
+    /// number of strings stored in one chunk
+    static const unsigned int chunkSize = 4096;
+
+    /// maximum number of chunks of a shard
+    static const unsigned int maxChunks = 1024;
+
+    struct Shard
+    {
+        std::mutex mutex;
+
+        /// links each interned string of this shard to its symbol
+        HashMap<std::string, Symbol> symbols;
+
+        /// the strings of this shard, indexed by symbol / shardCount
+        std::string* chunks[maxChunks];
+
+        /// number of strings in this shard
+        unsigned int size;
+
+        Shard(void);
+        ~Shard(void);
+    };
+
+    Shard shards[shardCount];
+
+    SymbolTable(void);
+    SymbolTable(const SymbolTable&);
+    SymbolTable& operator = (const SymbolTable&);
+
+    static SymbolTable& getInstance(void);
+public:
+
+    /// the symbol of the empty string
+    static const Symbol emptySymbol = 0;
+
+    ///
+    /// \brief get the symbol of a string, adding it if it is not yet known
+    ///
+    static Symbol intern(const std::string& string);
+
+    ///
+    /// \param string the characters of the string (not terminated)
+    /// \param length the number of characters
+    ///
+    static Symbol intern(const char* string, size_t length);
+
+    ///
+    /// \return the string the symbol has been interned from
+    ///
+    static const std::string& getString(Symbol symbol);
+};
+
+
+#endif // UETLI_UTIL_SYMBOLTABLE_H_
+
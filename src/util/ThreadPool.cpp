@@ -0,0 +1,235 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "ThreadPool.h"
+
+using uetli::util::ThreadPool;
+
+
+///
+/// \brief runs one iteration of a loop, keeping its exception
+///
+class ThreadPool::LoopTask : public Task
+{
+    Loop* loop;
+    size_t index;
+    std::exception_ptr error;
+public:
+    LoopTask(Loop* loop, size_t index);
+
+    virtual void run(void) throw();
+
+    const std::exception_ptr& getError(void) const;
+};
+
+
+ThreadPool::LoopTask::LoopTask(Loop* loop, size_t index) :
+    loop(loop), index(index)
+{
+}
+
+
+void ThreadPool::LoopTask::run(void) throw()
+{
+    try {
+        loop->run(index);
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+}
+
+
+const std::exception_ptr& ThreadPool::LoopTask::getError(void) const
+{
+    return error;
+}
+
+
+ThreadPool::Task::~Task(void)
+{
+}
+
+
+ThreadPool::Loop::~Loop(void)
+{
+}
+
+
+ThreadPool::ThreadPool(size_t threadCount) :
+    nextQueue(0),
+    queued(0),
+    pending(0),
+    stopping(false)
+{
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (size_t i = 0; i < threadCount; i++) {
+        queues.push_back(new Queue());
+    }
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.push_back(std::thread(&ThreadPool::work, this, i));
+    }
+}
+
+
+ThreadPool::~ThreadPool(void)
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    for (size_t i = 0; i < queues.size(); i++) {
+        delete queues[i];
+    }
+}
+
+
+void ThreadPool::submit(Task* task)
+{
+    pending++;
+
+    Queue* queue = queues[nextQueue];
+    nextQueue = (nextQueue + 1) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->tasks.push_back(task);
+    }
+    queued++;
+
+    // a worker checks queued while holding the mutex before going to sleep,
+    // so taking it here ensures the notification is not lost
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+    taskAvailable.notify_one();
+}
+
+
+void ThreadPool::wait(void)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (pending != 0)
+        allFinished.wait(lock);
+}
+
+
+size_t ThreadPool::getThreadCount(void) const
+{
+    return workers.size();
+}
+
+
+size_t ThreadPool::getDefaultThreadCount(void)
+{
+    size_t count = std::thread::hardware_concurrency();
+    return count != 0 ? count : 1;
+}
+
+
+void ThreadPool::forEach(Loop& loop, size_t count, size_t threadCount)
+{
+    if (threadCount > count)
+        threadCount = count;
+
+    if (threadCount <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            loop.run(i);
+        }
+        return;
+    }
+
+    std::vector<LoopTask> tasks;
+    tasks.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        tasks.push_back(LoopTask(&loop, i));
+    }
+
+    {
+        ThreadPool pool(threadCount);
+        for (size_t i = 0; i < count; i++) {
+            pool.submit(&tasks[i]);
+        }
+        pool.wait();
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (tasks[i].getError())
+            std::rethrow_exception(tasks[i].getError());
+    }
+}
+
+
+void ThreadPool::work(size_t index)
+{
+    for (;;) {
+        Task* task = takeTask(index);
+        if (task != 0) {
+            task->run();
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                allFinished.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (queued == 0 && !stopping)
+            taskAvailable.wait(lock);
+
+        if (queued == 0)
+            return;
+    }
+}
+
+
+ThreadPool::Task* ThreadPool::takeTask(size_t index)
+{
+    for (size_t i = 0; i < queues.size(); i++) {
+        Queue* queue = queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->tasks.empty())
+            continue;
+
+        Task* task;
+        if (i == 0) {
+            // the own queue is processed in order
+            task = queue->tasks.front();
+            queue->tasks.pop_front();
+        }
+        else {
+            // steal the task the owner would execute last
+            task = queue->tasks.back();
+            queue->tasks.pop_back();
+        }
+        queued--;
+        return task;
+    }
+    return 0;
+}
@@ -0,0 +1,186 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_UTIL_THREADPOOL_H_
+#define UETLI_UTIL_THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace uetli
+{
+    namespace util
+    {
+        class ThreadPool;
+    }
+}
+
+
+///
+/// \brief a fixed number of worker threads executing submitted tasks
+///
+/// Every worker has its own task queue. Submitted tasks are distributed
+/// over the queues in turn; a worker whose queue has run empty steals tasks
+/// from the back of the other queues, so tasks of very different sizes are
+/// still balanced over all threads.
+///
+/// The pool does not take ownership of the tasks.
+///
+class uetli::util::ThreadPool
+{
+public:
+    ///
+    /// \brief a unit of work executed by the pool
+    ///
+    class Task
+    {
+    public:
+        virtual ~Task(void);
+
+        ///
+        /// \brief executes the task on one of the worker threads
+        ///
+        /// Exceptions must be handled by the task itself.
+        ///
+        virtual void run(void) throw() = 0;
+    };
+
+    ///
+    /// \brief the body of a loop whose iterations may run concurrently
+    ///
+    class Loop
+    {
+    public:
+        virtual ~Loop(void);
+
+        ///
+        /// \brief executes one iteration
+        ///
+        /// Iterations may throw exceptions, which are passed on by
+        /// forEach().
+        ///
+        virtual void run(size_t index) = 0;
+    };
+
+private:
+    class LoopTask;
+
+    ///
+    /// \brief the task queue of one worker
+    ///
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task*> tasks;
+    };
+
+    std::vector<Queue*> queues;
+    std::vector<std::thread> workers;
+
+    /// queue receiving the next submitted task
+    size_t nextQueue;
+
+    /// number of tasks in all queues
+    std::atomic<size_t> queued;
+
+    /// number of tasks which are queued or running
+    std::atomic<size_t> pending;
+
+    /// guards sleeping and waking up of the workers and of wait()
+    std::mutex mutex;
+
+    /// signaled when a task is submitted or the pool is destroyed
+    std::condition_variable taskAvailable;
+
+    /// signaled when the last pending task has finished
+    std::condition_variable allFinished;
+
+    /// set when the pool is destroyed
+    bool stopping;
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator = (const ThreadPool&);
+public:
+
+    ///
+    /// \param threadCount the number of worker threads (at least one is
+    ///                    started)
+    ///
+    ThreadPool(size_t threadCount);
+
+    ///
+    /// \brief waits for all tasks and stops the worker threads
+    ///
+    ~ThreadPool(void);
+
+    ///
+    /// \brief queues a task for execution
+    ///
+    /// This function must only be called by one thread at a time.
+    ///
+    void submit(Task* task);
+
+    ///
+    /// \brief blocks until all submitted tasks have finished
+    ///
+    void wait(void);
+
+    size_t getThreadCount(void) const;
+
+    ///
+    /// \return the number of hardware threads, or 1 if it is not known
+    ///
+    static size_t getDefaultThreadCount(void);
+
+    ///
+    /// \brief run all iterations of a loop and wait for them
+    ///
+    /// If no more than one thread is requested, the iterations run on the
+    /// calling thread in order. Otherwise, a pool is started for the loop.
+    ///
+    /// \param count the number of iterations
+    /// \param threadCount the maximum number of threads used
+    ///
+    /// \throws the exception of the first iteration (by index) which threw
+    ///         one, so the result does not depend on the scheduling
+    ///
+    static void forEach(Loop& loop, size_t count, size_t threadCount);
+
+private:
+    void work(size_t index);
+
+    ///
+    /// \brief take a task from the own queue, or steal one from another
+    ///        queue
+    /// \return the task, or 0 if all queues are empty
+    ///
+    Task* takeTask(size_t index);
+};
+
+
+#endif // UETLI_UTIL_THREADPOOL_H_
+
@@ -0,0 +1,238 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "TimeReport.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+#include <time.h>
+
+using uetli::util::TimeReport;
+
+
+static std::atomic<bool> countAllocations(false);
+static std::atomic<unsigned long long> allocationCount(0);
+
+
+void* operator new(std::size_t size)
+{
+    if (countAllocations.load(std::memory_order_relaxed))
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (size == 0)
+        size = 1;
+
+    void* memory;
+    while ((memory = std::malloc(size)) == 0) {
+        std::new_handler handler = std::get_new_handler();
+        if (handler == 0)
+            throw std::bad_alloc();
+        handler();
+    }
+    return memory;
+}
+
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+
+void* operator new(std::size_t size, const std::nothrow_t&) throw()
+{
+    try {
+        return operator new(size);
+    }
+    catch (...) {
+        return 0;
+    }
+}
+
+
+void* operator new[](std::size_t size, const std::nothrow_t&) throw()
+{
+    return operator new(size, std::nothrow);
+}
+
+
+void operator delete(void* memory) throw()
+{
+    std::free(memory);
+}
+
+
+void operator delete[](void* memory) throw()
+{
+    std::free(memory);
+}
+
+
+void operator delete(void* memory, std::size_t) throw()
+{
+    std::free(memory);
+}
+
+
+void operator delete[](void* memory, std::size_t) throw()
+{
+    std::free(memory);
+}
+
+
+void operator delete(void* memory, const std::nothrow_t&) throw()
+{
+    std::free(memory);
+}
+
+
+void operator delete[](void* memory, const std::nothrow_t&) throw()
+{
+    std::free(memory);
+}
+
+
+void uetli::util::setAllocationCounting(bool enabled)
+{
+    countAllocations.store(enabled);
+}
+
+
+unsigned long long uetli::util::getAllocationCount(void)
+{
+    return allocationCount.load();
+}
+
+
+TimeReport::TimeReport(void) :
+    enabled(false)
+{
+}
+
+
+void TimeReport::setEnabled(bool enabled)
+{
+    this->enabled = enabled;
+    setAllocationCounting(enabled);
+}
+
+
+bool TimeReport::isEnabled(void) const
+{
+    return enabled;
+}
+
+
+void TimeReport::startPhase(const std::string& name)
+{
+    if (!enabled)
+        return;
+
+    endPhase();
+    current = name;
+    start = takeSample();
+}
+
+
+void TimeReport::endPhase(void)
+{
+    if (!enabled || current.empty())
+        return;
+
+    Sample end = takeSample();
+
+    Phase phase;
+    phase.name = current;
+    phase.wallTime = end.wallTime - start.wallTime;
+    phase.cpuTime = end.cpuTime - start.cpuTime;
+    phase.allocations = end.allocations - start.allocations;
+    phase.peakResidentGrowth =
+            end.peakResidentSize - start.peakResidentSize;
+    phases.push_back(phase);
+
+    current.clear();
+}
+
+
+void TimeReport::print(FILE* file) const
+{
+    if (!enabled)
+        return;
+
+    fprintf(file, "\nExecution times:\n");
+    fprintf(file, " %-24s %10s %10s %13s %15s\n", "phase", "wall (s)",
+            "cpu (s)", "allocations", "RSS growth (kB)");
+
+    Phase total;
+    total.wallTime = 0;
+    total.cpuTime = 0;
+    total.allocations = 0;
+    total.peakResidentGrowth = 0;
+
+    for (size_t i = 0; i < phases.size(); i++) {
+        const Phase& phase = phases[i];
+        fprintf(file, " %-24s %10.3f %10.3f %13llu %15ld\n",
+                phase.name.c_str(), phase.wallTime, phase.cpuTime,
+                phase.allocations, phase.peakResidentGrowth);
+
+        total.wallTime += phase.wallTime;
+        total.cpuTime += phase.cpuTime;
+        total.allocations += phase.allocations;
+        total.peakResidentGrowth += phase.peakResidentGrowth;
+    }
+
+    fprintf(file, " %-24s %10.3f %10.3f %13llu %15ld\n", "total",
+            total.wallTime, total.cpuTime, total.allocations,
+            total.peakResidentGrowth);
+}
+
+
+void TimeReport::clear(void)
+{
+    phases.clear();
+    current.clear();
+}
+
+
+TimeReport::Sample TimeReport::takeSample(void)
+{
+    Sample sample;
+
+    struct timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    sample.wallTime = now.tv_sec + now.tv_nsec * 1e-9;
+
+    // the CPU time of all threads of the process
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    sample.cpuTime = now.tv_sec + now.tv_nsec * 1e-9;
+
+    sample.allocations = getAllocationCount();
+
+    // the high-water mark of the process, which never decreases
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    sample.peakResidentSize = usage.ru_maxrss;
+    return sample;
+}
+
@@ -0,0 +1,124 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_UTIL_TIMEREPORT_H_
+#define UETLI_UTIL_TIMEREPORT_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace uetli
+{
+    namespace util
+    {
+        class TimeReport;
+
+        ///
+        /// \brief enable or disable counting the calls to operator new
+        ///
+        /// Counting is disabled by default, so allocations cost nothing
+        /// extra unless a report is requested.
+        ///
+        void setAllocationCounting(bool enabled);
+
+        ///
+        /// \return the number of allocations counted so far
+        ///
+        unsigned long long getAllocationCount(void);
+    }
+}
+
+
+///
+/// \brief measures the resources used by the phases of a compilation
+///
+/// For every phase, the wall time, the CPU time of all threads, the number
+/// of allocations and the growth of the peak resident set size of the
+/// process during the phase are recorded. Since the peak never decreases,
+/// a phase that stays below the memory used by an earlier one shows no
+/// growth. A disabled report does not measure anything.
+///
+class uetli::util::TimeReport
+{
+    struct Sample
+    {
+        double wallTime;
+        double cpuTime;
+        unsigned long long allocations;
+
+        /// in kilobytes
+        long peakResidentSize;
+    };
+
+    struct Phase
+    {
+        std::string name;
+        double wallTime;
+        double cpuTime;
+        unsigned long long allocations;
+
+        /// in kilobytes
+        long peakResidentGrowth;
+    };
+
+    bool enabled;
+
+    std::vector<Phase> phases;
+
+    /// the name of the running phase or an empty string
+    std::string current;
+    Sample start;
+
+public:
+    TimeReport(void);
+
+    void setEnabled(bool enabled);
+    bool isEnabled(void) const;
+
+    ///
+    /// \brief start measuring a phase, ending the running one
+    ///
+    void startPhase(const std::string& name);
+
+    ///
+    /// \brief end the running phase
+    ///
+    void endPhase(void);
+
+    ///
+    /// \brief print a table of all measured phases and their total
+    ///
+    void print(FILE* file) const;
+
+    ///
+    /// \brief forget all measured phases
+    ///
+    void clear(void);
+
+private:
+    static Sample takeSample(void);
+};
+
+
+#endif // UETLI_UTIL_TIMEREPORT_H_
+
@@ -0,0 +1,201 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#include "Trace.h"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+#include <time.h>
+
+using uetli::util::TraceSpan;
+
+
+namespace
+{
+    struct Event
+    {
+        const char* category;
+        std::string name;
+
+        /// in microseconds since tracing started
+        double start;
+        double duration;
+
+        unsigned int thread;
+    };
+}
+
+
+static std::atomic<bool> tracing(false);
+
+/// guards the events and the origin
+static std::mutex traceMutex;
+static std::vector<Event> events;
+static double origin;
+
+/// the number given to the next thread recording an event
+static std::atomic<unsigned int> nextThread(1);
+static thread_local unsigned int currentThread = 0;
+
+
+///
+/// \return the current time in microseconds
+///
+static double getTime(void)
+{
+    struct timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec * 1e-3;
+}
+
+
+///
+/// \return the number of the calling thread in the trace
+///
+static unsigned int getThread(void)
+{
+    if (currentThread == 0)
+        currentThread = nextThread.fetch_add(1);
+    return currentThread;
+}
+
+
+static void writeString(FILE* file, const std::string& string)
+{
+    fputc('"', file);
+    for (size_t i = 0; i < string.size(); i++) {
+        unsigned char c = string[i];
+        if (c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(file, "\\u%04x", c);
+        else
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+
+void uetli::util::startTracing(void)
+{
+    std::lock_guard<std::mutex> lock(traceMutex);
+    events.clear();
+    origin = getTime();
+
+    // the threads are numbered anew for every trace
+    nextThread.store(2);
+    currentThread = 1;
+    tracing.store(true);
+}
+
+
+bool uetli::util::isTracing(void)
+{
+    return tracing.load(std::memory_order_relaxed);
+}
+
+
+bool uetli::util::writeTrace(const std::string& filename)
+{
+    std::lock_guard<std::mutex> lock(traceMutex);
+    tracing.store(false);
+
+    FILE* file = ::fopen(filename.c_str(), "w");
+    if (file == 0)
+        return false;
+
+    fprintf(file, "{\"traceEvents\":[");
+    const char* separator = "\n";
+    unsigned int threadCount = nextThread.load() - 1;
+    for (unsigned int i = 1; i <= threadCount; i++) {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"tid\":%u,\"args\":{\"name\":", separator, i);
+        if (i == 1) {
+            writeString(file, "main");
+        }
+        else {
+            char name[32];
+            snprintf(name, sizeof name, "worker %u", i - 1);
+            writeString(file, name);
+        }
+        fprintf(file, "}}");
+        separator = ",\n";
+    }
+
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event& event = events[i];
+        fprintf(file, "%s{\"name\":", separator);
+        writeString(file, event.name);
+        fprintf(file, ",\"cat\":");
+        writeString(file, event.category);
+        fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,"
+                "\"tid\":%u}", event.start, event.duration, event.thread);
+        separator = ",\n";
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    events.clear();
+    bool written = !ferror(file);
+    return ::fclose(file) == 0 && written;
+}
+
+
+TraceSpan::TraceSpan(const char* category) :
+    category(category), recording(isTracing()), start(0)
+{
+    if (recording)
+        start = getTime();
+}
+
+
+TraceSpan::~TraceSpan(void)
+{
+    if (!recording)
+        return;
+
+    Event event;
+    event.category = category;
+    event.name = name.empty() ? category : name;
+    event.duration = getTime() - start;
+    event.thread = getThread();
+
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (!isTracing())
+        return;
+    event.start = start - origin;
+    events.push_back(event);
+}
+
+
+bool TraceSpan::isRecording(void) const
+{
+    return recording;
+}
+
+
+void TraceSpan::setName(const std::string& name)
+{
+    this->name = name;
+}
+
@@ -0,0 +1,96 @@
+// =============================================================================
+//
+// This file is part of the uetli compiler.
+//
+// Copyright (C) 2014-2015 Nicolas Winkler
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// =============================================================================
+
+
+#ifndef UETLI_UTIL_TRACE_H_
+#define UETLI_UTIL_TRACE_H_
+
+#include <string>
+
+namespace uetli
+{
+    namespace util
+    {
+        class TraceSpan;
+
+        ///
+        /// \brief start recording trace events, discarding earlier ones
+        ///
+        /// The calling thread is shown as the main thread of the trace.
+        ///
+        void startTracing(void);
+
+        ///
+        /// \return <code>true</code>, if trace events are being recorded
+        ///
+        bool isTracing(void);
+
+        ///
+        /// \brief write all recorded events in the Chrome trace event format
+        ///
+        /// The file can be opened in <code>chrome://tracing</code> or in
+        /// Perfetto. Recording stops.
+        ///
+        /// \return <code>false</code>, if the file could not be written
+        ///
+        bool writeTrace(const std::string& filename);
+    }
+}
+
+
+///
+/// \brief records the time from its construction to its destruction as an
+///        event on the trace of the current thread
+///
+/// If no trace is recorded, a span does nothing. Spans may be nested.
+///
+class uetli::util::TraceSpan
+{
+    const char* category;
+    std::string name;
+    bool recording;
+    double start;
+
+    TraceSpan(const TraceSpan&);
+    TraceSpan& operator = (const TraceSpan&);
+public:
+    ///
+    /// \param category the kind of work, which is also the name of the
+    ///                 event until setName() is called
+    ///
+    TraceSpan(const char* category);
+    ~TraceSpan(void);
+
+    ///
+    /// \return <code>true</code>, if the span is recorded, so that it is
+    ///         worth building a name for it
+    ///
+    bool isRecording(void) const;
+
+    ///
+    /// \brief name the event after the item being processed
+    ///
+    void setName(const std::string& name);
+};
+
+
+#endif // UETLI_UTIL_TRACE_H_
+